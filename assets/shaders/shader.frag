@@ -4,11 +4,19 @@ in vec4 objectColor;
 in vec2 TexCoord;  
 
 uniform sampler2D texture0;
+uniform sampler2DArray textureLayers;
 uniform bool useTexture;
+uniform int textureLayer; // layer of textureLayers to sample, or -1 for texture0
 
 
 out vec4 FragColor;
 
 void main() {
-    FragColor = useTexture ? texture(texture0, TexCoord) : objectColor;
-}
\ No newline at end of file
+    if (!useTexture) {
+        FragColor = objectColor;
+    } else if (textureLayer >= 0) {
+        FragColor = texture(textureLayers, vec3(TexCoord, textureLayer));
+    } else {
+        FragColor = texture(texture0, TexCoord);
+    }
+}
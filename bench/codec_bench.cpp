@@ -0,0 +1,89 @@
+// Decode benchmark for the image codec backends.
+//
+//     codec_bench <image> [repeats]
+//
+// Decodes one file (e.g. a JPEG saved from the image provider) with every backend this build has,
+// at full size and at the "Decode Size" targets the loader offers, and reports ms/image for each.
+// Backends that cannot scale while decoding (stb) decode at full size whatever the target.
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+
+#include "texgan/loading/ImageCodec.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using texgan::loading::DecodedImage;
+    using texgan::loading::DecodeOptions;
+    using texgan::loading::ImageCodec;
+
+    // Best of `repeats`, in milliseconds; negative if the codec failed
+    double timeDecode(const ImageCodec& codec, const std::vector<unsigned char>& file, const DecodeOptions& options,
+                      int repeats, DecodedImage& out) {
+        double best = 1e30;
+        for (int i = 0; i < repeats; ++i) {
+            auto start = Clock::now();
+            if (!codec.decode(file.data(), file.size(), options, out)) return -1.0;
+            best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+        return best;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: codec_bench <image> [repeats]\n";
+        return 1;
+    }
+    int repeats = argc > 2 ? std::stoi(argv[2]) : 20;
+
+    std::ifstream in(argv[1], std::ios::binary);
+    std::vector<unsigned char> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (file.empty()) {
+        std::cerr << "could not read " << argv[1] << "\n";
+        return 1;
+    }
+    std::cout << argv[1] << ", " << file.size() / 1024 << " KB, best of " << repeats << "\n\n";
+
+    std::vector<std::unique_ptr<ImageCodec>> codecs;
+    codecs.push_back(texgan::loading::makeJpegCodec());
+    codecs.push_back(texgan::loading::makeStbCodec());
+
+    for (const auto& codec : codecs) {
+        if (!codec) {
+            std::cout << "(built without libjpeg)\n";
+            continue;
+        }
+        if (!codec->accepts(file.data(), file.size())) {
+            std::cout << std::left << std::setw(16) << codec->name() << "does not handle this format\n";
+            continue;
+        }
+
+        int fullSize = 0;
+        for (int target : {0, 1024, 512, 256, 128}) {
+            if (target && target >= fullSize) continue; // nothing to scale away
+
+            DecodeOptions options;
+            options.targetWidth = options.targetHeight = target;
+            DecodedImage out;
+            double ms = timeDecode(*codec, file, options, repeats, out);
+
+            std::string label = target ? "target " + std::to_string(target) : "full size";
+            std::cout << std::left << std::setw(16) << codec->name() << std::setw(12) << label << std::right;
+            if (ms < 0) {
+                std::cout << "   FAILED\n";
+                break;
+            }
+            std::cout << std::fixed << std::setprecision(2) << std::setw(9) << ms << " ms   "
+                      << out.width << "x" << out.height << "\n";
+            if (target == 0) fullSize = std::max(out.width, out.height);
+        }
+    }
+}
@@ -0,0 +1,107 @@
+// Throughput benchmark for aif::ImageFetcher engines.
+//
+// Start the stand-in server first:
+//     python3 scripts/standin_server.py --latency-ms 50
+// then:
+//     fetch_bench [url] [count] [workers] [maxInFlight]
+//
+// Use an https:// url with the TLS stand-in to see the cost of handshakes; certificate
+// verification is turned off so the stand-in's self-signed certificate is accepted.
+//
+// Against a throttling stand-in (--max-rps / --max-concurrent) compare the fixed
+// engines with the adaptive runs: failed images are the ones that ran out of retries.
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <future>
+
+#include "aif/ImageFetcher.h"
+
+namespace {
+    struct RunResult {
+        double seconds;
+        size_t images;
+        size_t bytes;
+    };
+
+    RunResult runBatch(aif::ImageFetcher& fetcher, const std::string& url, int count) {
+        std::promise<RunResult> done;
+        auto start = std::chrono::steady_clock::now();
+
+        fetcher.fetchMany(count, url, [&](bool, std::vector<aif::ImageFetcher::RawImage> images) {
+            size_t bytes = 0;
+            for (const auto& image : images) bytes += image.size();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            done.set_value({seconds, images.size(), bytes});
+        });
+
+        return done.get_future().get();
+    }
+
+    void report(const std::string& label, const RunResult& r, int requested) {
+        std::cout << std::left << std::setw(28) << label << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(9) << r.seconds << " s"
+                  << std::setw(10) << r.images / r.seconds << " img/s"
+                  << std::setw(10) << r.bytes / r.seconds / (1024.0 * 1024.0) << " MB/s"
+                  << "   (" << r.images << "/" << requested << " ok)\n";
+    }
+
+    void reportFlow(const aif::ImageFetcher& fetcher) {
+        auto flow = fetcher.flowStats();
+        std::cout << "    settled at " << flow.concurrencyLimit << " concurrent, " << flow.throttled << " throttled, "
+                  << flow.retries << " retries, " << std::setprecision(0) << flow.latencyMs << " ms latency\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string url   = argc > 1 ? argv[1] : "http://127.0.0.1:8080/";
+    int count         = argc > 2 ? std::stoi(argv[2]) : 500;
+    size_t workers    = argc > 3 ? std::stoul(argv[3]) : aif::ImageFetcher::kDefaultWorkerCount;
+    size_t maxInFlight = argc > 4 ? std::stoul(argv[4]) : aif::ImageFetcher::kDefaultMaxInFlight;
+
+    bool tls = url.rfind("https://", 0) == 0;
+
+    std::cout << "Fetching " << count << " images from " << url << "\n\n";
+
+    {
+        aif::ImageFetcher fetcher(1);
+        fetcher.setVerifyTls(!tls);
+        report("thread pool (1 worker)", runBatch(fetcher, url, count), count);
+    }
+    {
+        aif::ImageFetcher fetcher(workers);
+        fetcher.setVerifyTls(!tls);
+        fetcher.setSessionReuse(false);
+        report("thread pool, no reuse", runBatch(fetcher, url, count), count);
+    }
+    {
+        aif::ImageFetcher fetcher(workers);
+        fetcher.setVerifyTls(!tls);
+        report("thread pool (" + std::to_string(workers) + " workers)", runBatch(fetcher, url, count), count);
+        report("  second batch (warm)", runBatch(fetcher, url, count), count);
+    }
+    {
+        aif::ImageFetcher fetcher(1, aif::ImageFetcher::Engine::Multiplexed);
+        fetcher.setVerifyTls(!tls);
+        fetcher.setMaxInFlight(maxInFlight);
+        report("multiplexed (" + std::to_string(maxInFlight) + " in flight)", runBatch(fetcher, url, count), count);
+    }
+    {
+        aif::ImageFetcher fetcher(workers);
+        fetcher.setVerifyTls(!tls);
+        fetcher.setAdaptive(true);
+        report("adaptive thread pool", runBatch(fetcher, url, count), count);
+        reportFlow(fetcher);
+    }
+    {
+        aif::ImageFetcher fetcher(1, aif::ImageFetcher::Engine::Multiplexed);
+        fetcher.setVerifyTls(!tls);
+        fetcher.setMaxInFlight(maxInFlight);
+        fetcher.setAdaptive(true);
+        report("adaptive multiplexed", runBatch(fetcher, url, count), count);
+        reportFlow(fetcher);
+    }
+    return 0;
+}
@@ -0,0 +1,191 @@
+// Contention benchmark for the fetcher's task queue.
+//
+//     queue_bench [producers] [consumers] [items] [bulk]
+//
+// Producers hand `items` small tasks to consumers that sleep when the queue runs dry, the way
+// fetchOne/fetchEach feed the worker pool. Compares std::queue behind a mutex and condition variable
+// (one lock and notify per task) with aif::MpmcQueue and aif::Parker, pushing one task at a time
+// and in bulk. "enqueue" is the producers' time per task, "end to end" includes the consumers.
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <span>
+
+#include "aif/MpmcQueue.h"
+#include "aif/Parker.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Roughly what a queued fetch carries: a url and a callback
+    struct Item {
+        std::size_t value = 0;
+        std::string url;
+        std::function<void()> callback;
+    };
+
+    struct RunResult {
+        double seconds;
+        double enqueueNs;
+        bool valid;
+    };
+
+    class MutexQueue {
+        public:
+            void push(Item&& item) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    queue.push(std::move(item));
+                }
+                cond.notify_one();
+            }
+
+            // Blocks until an item arrives or `done` is set
+            bool pop(Item& item, const std::atomic<bool>& done) {
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait(lock, [&]() { return !queue.empty() || done; });
+                if (queue.empty()) return false;
+                item = std::move(queue.front());
+                queue.pop();
+                return true;
+            }
+
+            void finish() {
+                std::lock_guard<std::mutex> lock(mutex);
+                cond.notify_all();
+            }
+        private:
+            std::mutex mutex;
+            std::condition_variable cond;
+            std::queue<Item> queue;
+    };
+
+    class LockFreeQueue {
+        public:
+            explicit LockFreeQueue(std::size_t bulk) : bulk(bulk), queue(4096) {}
+
+            void push(std::vector<Item>& items) {
+                std::span<Item> rest(items);
+                while (!rest.empty()) {
+                    std::size_t pushed = bulk > 1 ? queue.tryPushBulk(rest) : (queue.tryPush(std::move(rest.front())) ? 1 : 0);
+                    if (pushed == 0) {
+                        std::this_thread::yield(); // full: let the consumers catch up
+                        continue;
+                    }
+                    rest = rest.subspan(pushed);
+                    if (bulk > 1) parker.notifyAll(); else parker.notifyOne();
+                }
+            }
+
+            bool pop(Item& item, const std::atomic<bool>& done) {
+                while (true) {
+                    if (queue.tryPop(item)) return true;
+
+                    auto key = parker.prepare();
+                    if (done || !queue.emptyApprox()) {
+                        parker.cancel();
+                        if (done && queue.emptyApprox()) return false;
+                        continue;
+                    }
+                    parker.park(key);
+                }
+            }
+
+            void finish() { parker.notifyAll(); }
+
+            const std::size_t bulk;
+        private:
+            aif::MpmcQueue<Item> queue;
+            aif::Parker parker;
+    };
+
+    template<typename Queue, typename Push>
+    RunResult run(Queue& queue, Push push, int producers, int consumers, std::size_t items, std::size_t bulk) {
+        std::atomic<bool> done{false};
+        std::atomic<std::size_t> consumed{0};
+        std::atomic<std::size_t> checksum{0};
+        std::atomic<long long> enqueueNs{0};
+
+        auto start = Clock::now();
+
+        std::vector<std::jthread> threads;
+        for (int c = 0; c < consumers; ++c) {
+            threads.emplace_back([&]() {
+                Item item;
+                std::size_t sum = 0;
+                while (queue.pop(item, done)) {
+                    sum += item.value;
+                    if (consumed.fetch_add(1) + 1 == items) {
+                        done = true;
+                        queue.finish();
+                    }
+                }
+                checksum += sum;
+            });
+        }
+
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p]() {
+                std::size_t first = items * p / producers;
+                std::size_t last = items * (p + 1) / producers;
+                std::vector<Item> batch;
+                auto began = Clock::now();
+                for (std::size_t i = first; i < last; i += bulk) {
+                    batch.clear();
+                    for (std::size_t j = i; j < std::min(last, i + bulk); ++j) {
+                        batch.push_back(Item{j + 1, "http://127.0.0.1:8080/", {}});
+                    }
+                    push(queue, batch);
+                }
+                enqueueNs += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - began).count();
+            });
+        }
+
+        threads.clear();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        return {seconds, static_cast<double>(enqueueNs) / items, checksum == items * (items + 1) / 2};
+    }
+
+    void report(const std::string& label, const RunResult& r, std::size_t items) {
+        std::cout << std::left << std::setw(30) << label << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(9) << r.enqueueNs << " ns enqueue"
+                  << std::setw(9) << r.seconds * 1e9 / items << " ns end to end"
+                  << std::setw(9) << items / r.seconds / 1e6 << " M/s"
+                  << (r.valid ? "" : "   CHECKSUM MISMATCH") << "\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    int producers     = argc > 1 ? std::stoi(argv[1]) : 4;
+    int consumers     = argc > 2 ? std::stoi(argv[2]) : 8;
+    std::size_t items = argc > 3 ? std::stoul(argv[3]) : 1000000;
+    std::size_t bulk  = argc > 4 ? std::stoul(argv[4]) : 64;
+
+    std::cout << producers << " producers, " << consumers << " consumers, " << items << " tasks\n\n";
+
+    {
+        MutexQueue queue;
+        auto push = [](MutexQueue& q, std::vector<Item>& batch) { for (auto& item : batch) q.push(std::move(item)); };
+        report("mutex + condvar", run(queue, push, producers, consumers, items, 1), items);
+    }
+    {
+        LockFreeQueue queue(1);
+        auto push = [](LockFreeQueue& q, std::vector<Item>& batch) { q.push(batch); };
+        report("lock-free, one at a time", run(queue, push, producers, consumers, items, 1), items);
+    }
+    {
+        LockFreeQueue queue(bulk);
+        auto push = [](LockFreeQueue& q, std::vector<Item>& batch) { q.push(batch); };
+        report("lock-free, bulk " + std::to_string(bulk), run(queue, push, producers, consumers, items, bulk), items);
+    }
+}
@@ -0,0 +1,142 @@
+// Upload benchmark for the shared-context loader.
+//
+//     upload_bench [size] [count] [max workers] [repeats]
+//
+// Uploads `count` RGBA textures of size x size from 1 to `max workers` threads, each with its own hidden
+// GL context shared with a main one, the way the shared-context approach does. Every upload is followed by
+// a fence and a flush, and a run ends when the main context has seen every fence signal. Reports MB/s per
+// worker count; drivers that serialize uploads across contexts show no gain past one worker.
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Upload {
+        GLuint texture;
+        GLsync fence;
+    };
+
+    // Seconds from the first upload until every fence has signalled
+    double timeUploads(const std::vector<GLFWwindow*>& contexts, size_t workers, int size, int count,
+                       const std::vector<std::uint8_t>& pixels) {
+        std::atomic<int> next{0};
+        std::mutex mutex;
+        std::vector<Upload> uploads;
+        uploads.reserve(count);
+
+        auto start = Clock::now();
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < workers; ++i) {
+            threads.emplace_back([&, window = contexts[i]]() {
+                glfwMakeContextCurrent(window);
+                while (next.fetch_add(1) < count) {
+                    GLuint texture = 0;
+                    glGenTextures(1, &texture);
+                    glBindTexture(GL_TEXTURE_2D, texture);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+                    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                    glFlush();
+                    std::lock_guard<std::mutex> lock(mutex);
+                    uploads.push_back({texture, fence});
+                }
+                glBindTexture(GL_TEXTURE_2D, 0);
+                glfwMakeContextCurrent(nullptr);
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        for (auto& upload : uploads) {
+            while (glClientWaitSync(upload.fence, 0, 1000000) == GL_TIMEOUT_EXPIRED) {}
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        for (auto& upload : uploads) {
+            glDeleteSync(upload.fence);
+            glDeleteTextures(1, &upload.texture);
+        }
+        glFinish();
+        return seconds;
+    }
+}
+
+int main(int argc, char** argv) {
+    int size = argc > 1 ? std::stoi(argv[1]) : 1024;
+    int count = argc > 2 ? std::stoi(argv[2]) : 200;
+    size_t maxWorkers = argc > 3 ? std::stoul(argv[3]) : std::max(1u, std::min(8u, std::thread::hardware_concurrency()));
+    int repeats = argc > 4 ? std::stoi(argv[4]) : 3;
+
+    if (!glfwInit()) {
+        std::cerr << "could not initialize GLFW\n";
+        return 1;
+    }
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* mainWindow = glfwCreateWindow(1, 1, "upload_bench", nullptr, nullptr);
+    if (!mainWindow) {
+        std::cerr << "could not create a GL context\n";
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(mainWindow);
+    glewExperimental = GL_TRUE;
+    if (glewInit() != GLEW_OK) {
+        std::cerr << "could not initialize GLEW\n";
+        glfwTerminate();
+        return 1;
+    }
+
+    std::vector<GLFWwindow*> contexts;
+    for (size_t i = 0; i < maxWorkers; ++i) {
+        GLFWwindow* window = glfwCreateWindow(1, 1, "Shared Context", nullptr, mainWindow);
+        if (!window) break;
+        contexts.push_back(window);
+    }
+    if (contexts.empty()) {
+        std::cerr << "could not create a shared GL context\n";
+        glfwTerminate();
+        return 1;
+    }
+
+    std::vector<std::uint8_t> pixels(static_cast<size_t>(size) * size * 4);
+    for (size_t i = 0; i < pixels.size(); ++i) pixels[i] = static_cast<std::uint8_t>(i * 31 + (i >> 12));
+    double megabytes = static_cast<double>(pixels.size()) * count / (1024.0 * 1024.0);
+
+    std::cout << glGetString(GL_RENDERER) << "\n"
+              << count << " textures of " << size << "x" << size << " RGBA (" << std::fixed << std::setprecision(1)
+              << megabytes << " MB), best of " << repeats << "\n\n";
+    std::cout << std::left << std::setw(10) << "workers" << std::right << std::setw(12) << "MB/s"
+              << std::setw(12) << "tex/s" << std::setw(10) << "speedup" << "\n";
+
+    // Warm-up, so driver allocation on first use is not charged to one worker
+    timeUploads(contexts, 1, size, std::min(count, 8), pixels);
+
+    double baseline = 0.0;
+    for (size_t workers = 1; workers <= contexts.size(); ++workers) {
+        double best = 1e30;
+        for (int i = 0; i < repeats; ++i) {
+            best = std::min(best, timeUploads(contexts, workers, size, count, pixels));
+        }
+        double rate = megabytes / best;
+        if (workers == 1) baseline = rate;
+        std::cout << std::left << std::setw(10) << workers << std::right << std::setw(12) << std::setprecision(1) << rate
+                  << std::setw(12) << count / best << std::setw(9) << std::setprecision(2) << rate / baseline << "x\n";
+    }
+
+    for (GLFWwindow* window : contexts) glfwDestroyWindow(window);
+    glfwDestroyWindow(mainWindow);
+    glfwTerminate();
+    return 0;
+}
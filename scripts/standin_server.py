@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+"""
+standin_server.py
+-----------------
+Local stand-in for the image provider used by the fetcher benchmarks.
+
+Every GET returns one "image" after an artificial delay, so round-trip
+latency can be simulated without touching the real provider.
+
+Examples
+    python3 standin_server.py                          # 500 KB random payload, 50 ms latency
+    python3 standin_server.py --image face.jpg         # serve a real JPEG
+    python3 standin_server.py --latency-ms 150 -p 9000
+
+Throttling (to exercise adaptive concurrency, rate limiting and retries)
+    python3 standin_server.py --max-rps 20 --max-concurrent 8 --retry-after 1
+
+TLS (to measure handshake cost and connection reuse)
+    openssl req -x509 -newkey rsa:2048 -nodes -days 7 -subj /CN=127.0.0.1 \
+            -keyout key.pem -out cert.pem
+    python3 standin_server.py --tls-cert cert.pem --tls-key key.pem -p 8443
+"""
+
+import os
+import ssl
+import time
+import argparse
+import threading
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+
+# ---------- Handler ----------------------------------------------------------
+
+
+class ImageHandler(BaseHTTPRequestHandler):
+    # Keep-alive so clients can reuse connections
+    protocol_version = "HTTP/1.1"
+
+    payload = b""
+    latency = 0.0
+    served = 0
+    connections = 0
+    lock = threading.Lock()
+
+    # Throttling: requests over either limit get 429 Too Many Requests
+    max_rps = 0.0
+    max_concurrent = 0
+    retry_after = 0
+    tokens = 0.0
+    refilled = 0.0
+    active = 0
+    throttled = 0
+
+    def setup(self):
+        super().setup()
+        with ImageHandler.lock:
+            ImageHandler.connections += 1
+
+    @classmethod
+    def admit(cls):
+        """Token bucket over all clients plus a cap on concurrent requests."""
+        with cls.lock:
+            if cls.max_concurrent and cls.active >= cls.max_concurrent:
+                cls.throttled += 1
+                return False
+            if cls.max_rps:
+                now = time.monotonic()
+                cls.tokens = min(cls.max_rps, cls.tokens + (now - cls.refilled) * cls.max_rps)
+                cls.refilled = now
+                if cls.tokens < 1.0:
+                    cls.throttled += 1
+                    return False
+                cls.tokens -= 1.0
+            cls.active += 1
+            return True
+
+    def do_GET(self):
+        if not self.admit():
+            self.send_response(429)
+            if self.retry_after:
+                self.send_header("Retry-After", str(self.retry_after))
+            self.send_header("Content-Length", "0")
+            self.end_headers()
+            return
+
+        try:
+            if self.latency > 0:
+                time.sleep(self.latency)
+        finally:
+            with ImageHandler.lock:
+                ImageHandler.active -= 1
+
+        self.send_response(200)
+        self.send_header("Content-Type", "image/jpeg")
+        self.send_header("Content-Length", str(len(self.payload)))
+        self.end_headers()
+        self.wfile.write(self.payload)
+
+        with ImageHandler.lock:
+            ImageHandler.served += 1
+
+    def do_HEAD(self):
+        self.send_response(200)
+        self.send_header("Content-Type", "image/jpeg")
+        self.send_header("Content-Length", str(len(self.payload)))
+        self.end_headers()
+
+    def log_message(self, fmt, *args):
+        pass  # per-request logging would dominate the benchmark
+
+
+# ---------- Main -------------------------------------------------------------
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Local stand-in image server for fetcher benchmarks")
+    ap.add_argument("--host", default="127.0.0.1", help="Bind address (default: 127.0.0.1)")
+    ap.add_argument("-p", "--port", type=int, default=8080, help="Port (default: 8080)")
+    ap.add_argument("--image", help="Serve this file instead of a random payload")
+    ap.add_argument("--size", type=int, default=500_000,
+                    help="Random payload size in bytes when --image is not given (default: 500000)")
+    ap.add_argument("--latency-ms", type=float, default=50.0,
+                    help="Artificial delay before each response (default: 50)")
+    ap.add_argument("--max-rps", type=float, default=0.0,
+                    help="Answer 429 above this many requests per second, all clients together (default: off)")
+    ap.add_argument("--max-concurrent", type=int, default=0,
+                    help="Answer 429 while this many requests are already being served (default: off)")
+    ap.add_argument("--retry-after", type=int, default=0,
+                    help="Retry-After seconds sent with 429 responses (default: none)")
+    ap.add_argument("--tls-cert", help="Serve HTTPS with this certificate (PEM)")
+    ap.add_argument("--tls-key", help="Private key for --tls-cert (PEM)")
+    args = ap.parse_args()
+
+    if args.image:
+        with open(args.image, "rb") as f:
+            ImageHandler.payload = f.read()
+    else:
+        ImageHandler.payload = os.urandom(args.size)
+    ImageHandler.latency = args.latency_ms / 1000.0
+    ImageHandler.max_rps = args.max_rps
+    ImageHandler.max_concurrent = args.max_concurrent
+    ImageHandler.retry_after = args.retry_after
+    ImageHandler.tokens = args.max_rps
+    ImageHandler.refilled = time.monotonic()
+
+    # Benchmarks open hundreds of connections at once; the default backlog of 5 drops them
+    ThreadingHTTPServer.request_queue_size = 1024
+    server = ThreadingHTTPServer((args.host, args.port), ImageHandler)
+    server.daemon_threads = True
+    scheme = "http"
+
+    if args.tls_cert:
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        context.load_cert_chain(args.tls_cert, args.tls_key)
+        server.socket = context.wrap_socket(server.socket, server_side=True)
+        scheme = "https"
+
+    print(f"✓ Serving {len(ImageHandler.payload)} bytes per request at "
+          f"{scheme}://{args.host}:{args.port}/ (latency {args.latency_ms:.0f} ms)")
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        print(f"✓ Served {ImageHandler.served} images over {ImageHandler.connections} connections")
+        if ImageHandler.throttled:
+            print(f"✓ Throttled {ImageHandler.throttled} requests with 429")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,180 @@
+#ifndef AMF_ASYNC_H
+#define AMF_ASYNC_H
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <atomic>
+#include <type_traits>
+
+namespace aif{
+
+template<typename T = void>
+class Async;
+
+namespace detail {
+    // Resumes whoever awaited the finished coroutine (symmetric transfer, no stack growth).
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            auto continuation = handle.promise().continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    struct PromiseBase {
+        std::coroutine_handle<> continuation;
+        std::exception_ptr error;
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        FinalAwaiter final_suspend() const noexcept { return {}; }
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+    };
+
+    template<typename T>
+    struct Promise : PromiseBase {
+        std::optional<T> value;
+
+        Async<T> get_return_object();
+        void return_value(T result) { value.emplace(std::move(result)); }
+
+        T take() {
+            if (error) std::rethrow_exception(error);
+            return std::move(*value);
+        }
+    };
+
+    template<>
+    struct Promise<void> : PromiseBase {
+        Async<void> get_return_object();
+        void return_void() const noexcept {}
+
+        void take() {
+            if (error) std::rethrow_exception(error);
+        }
+    };
+
+    // Fire-and-forget frame that owns an Async until it finishes, then frees itself.
+    struct Detached {
+        struct promise_type {
+            Detached get_return_object() const noexcept { return {}; }
+            std::suspend_never initial_suspend() const noexcept { return {}; }
+            std::suspend_never final_suspend() const noexcept { return {}; }
+            void return_void() const noexcept {}
+            void unhandled_exception() const noexcept { std::terminate(); }
+        };
+    };
+}
+
+// Lazily started coroutine producing a T. Nothing runs until it is awaited (or spawned),
+// and the awaiting coroutine resumes on whichever thread completes it.
+template<typename T>
+class Async {
+    public:
+        using promise_type = detail::Promise<T>;
+
+        Async() = default;
+        explicit Async(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+        Async(Async&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+        Async& operator=(Async&& other) noexcept {
+            if (this != &other) {
+                if (handle) handle.destroy();
+                handle = std::exchange(other.handle, {});
+            }
+            return *this;
+        }
+        ~Async() { if (handle) handle.destroy(); }
+
+        Async(const Async&) = delete;
+        Async& operator=(const Async&) = delete;
+
+        auto operator co_await() && noexcept {
+            struct Awaiter {
+                std::coroutine_handle<promise_type> handle;
+
+                bool await_ready() const noexcept { return !handle || handle.done(); }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                    handle.promise().continuation = awaiting;
+                    return handle;
+                }
+
+                T await_resume() { return handle.promise().take(); }
+            };
+            return Awaiter{handle};
+        }
+    private:
+        std::coroutine_handle<promise_type> handle;
+    };
+
+namespace detail {
+    template<typename T>
+    Async<T> Promise<T>::get_return_object() {
+        return Async<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+    }
+
+    inline Async<void> Promise<void>::get_return_object() {
+        return Async<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+    }
+
+    inline Detached runDetached(Async<void> work) {
+        co_await std::move(work);
+    }
+}
+
+// Starts `work` without awaiting it. It runs to completion on whatever threads it hops to.
+inline void spawn(Async<void> work) {
+    detail::runDetached(std::move(work));
+}
+
+// Runs every task concurrently and resumes once all of them have finished, with the results in order.
+template<typename T>
+Async<std::vector<T>> whenAll(std::vector<Async<T>> tasks) {
+    struct Join {
+        std::atomic<std::size_t> remaining;
+        std::coroutine_handle<> parent;
+    };
+
+    struct Awaiter {
+        std::vector<Async<T>>& tasks;
+        std::vector<std::optional<T>>& results;
+        Join join;
+
+        bool await_ready() const noexcept { return tasks.empty(); }
+
+        bool await_suspend(std::coroutine_handle<> parent) {
+            join.parent = parent;
+            // One extra count for ourselves, so children finishing early cannot resume us mid-setup
+            join.remaining = tasks.size() + 1;
+            for (std::size_t i = 0; i < tasks.size(); ++i) {
+                run(std::move(tasks[i]), results[i], join);
+            }
+            return join.remaining.fetch_sub(1) != 1;
+        }
+
+        void await_resume() const noexcept {}
+
+        static detail::Detached run(Async<T> task, std::optional<T>& slot, Join& join) {
+            slot.emplace(co_await std::move(task));
+            if (join.remaining.fetch_sub(1) == 1) join.parent.resume();
+        }
+    };
+
+    std::vector<std::optional<T>> results(tasks.size());
+    Awaiter awaiter{tasks, results, {}};
+    co_await awaiter;
+
+    std::vector<T> values;
+    values.reserve(results.size());
+    for (auto& result : results) values.push_back(std::move(*result));
+    co_return values;
+}
+}
+
+#endif // AMF_ASYNC_H
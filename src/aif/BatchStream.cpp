@@ -0,0 +1,130 @@
+#include "BatchStream.h"
+#include "ImageFetcher.h"
+#include <algorithm>
+
+namespace aif{
+
+    Credit::Credit(std::shared_ptr<BatchStream> stream) : stream(std::move(stream)) {}
+
+    Credit& Credit::operator=(Credit&& other) noexcept {
+        if (this != &other) {
+            release();
+            stream = std::move(other.stream);
+        }
+        return *this;
+    }
+
+    Credit::~Credit() {
+        release();
+    }
+
+    void Credit::release() {
+        if (auto owner = std::move(stream)) {
+            owner->releaseSlot();
+        }
+    }
+
+    BatchStream::BatchStream(ImageFetcher& fetcher, std::vector<std::string> urls, StreamOptions options,
+                             BatchItemsCallback onItems, BatchDoneCallback onDone, CancelToken token)
+        : fetcher(fetcher), urls(std::move(urls)), options(options),
+          onItems(std::move(onItems)), onDone(std::move(onDone)), token(std::move(token)) {
+        report.requested = this->urls.size();
+        report.items.resize(this->urls.size());
+    }
+
+    void BatchStream::start() {
+        if (urls.empty()) {
+            if (onDone) onDone(report);
+            return;
+        }
+        issue(std::max<std::size_t>(options.window, 1));
+    }
+
+    void BatchStream::issue(std::size_t count) {
+        // Reserve the indices under the lock, fetch outside it: a fetch may complete synchronously
+        std::size_t first, last;
+        std::size_t skipped = 0;
+        std::vector<BatchItem> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (token.cancelled()) {
+                // Nothing more goes out; account for the rest of the batch so the done event still fires
+                for (std::size_t i = nextIndex; i < urls.size(); ++i) {
+                    report.items[i].error = kCancelledMessage;
+                }
+                skipped = urls.size() - nextIndex;
+                nextIndex = urls.size();
+                if (fetching == 0) ready.swap(pending);
+            }
+            first = nextIndex;
+            last = std::min(urls.size(), nextIndex + count);
+            nextIndex = last;
+            slotsInUse += last - first;
+            fetching += last - first;
+        }
+        if (skipped > 0) {
+            settle(std::move(ready), skipped);
+            return;
+        }
+
+        // The initial window goes out as one bulk enqueue; refills are usually a single url
+        auto self = shared_from_this();
+        fetcher.fetchEach(std::span<const std::string>(urls).subspan(first, last - first),
+                          [self, first](std::size_t i, bool success, ByteBuffer data) {
+            self->onFetched(first + i, success, std::move(data));
+        }, options.priority, token);
+    }
+
+    void BatchStream::releaseSlot() {
+        bool more = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --slotsInUse;
+            more = nextIndex < urls.size();
+        }
+        if (more) issue(1);
+    }
+
+    void BatchStream::onFetched(std::size_t index, bool success, ByteBuffer data) {
+        std::vector<BatchItem> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --fetching;
+
+            auto& status = report.items[index];
+            status.success = success;
+            if (success) {
+                ++report.succeeded;
+            } else {
+                status.error.assign(data.begin(), data.end());
+            }
+
+            pending.push_back(BatchItem{index, success, std::move(data), Credit(shared_from_this())});
+
+            // Flush a full group, or whatever is buffered once nothing else is on its way,
+            // otherwise a group larger than the free window would never fill up
+            if (pending.size() >= std::max<std::size_t>(options.deliverEvery, 1) || fetching == 0) {
+                ready.swap(pending);
+            }
+        }
+        if (!ready.empty()) settle(std::move(ready), 0);
+    }
+
+    void BatchStream::settle(std::vector<BatchItem> ready, std::size_t skipped) {
+        // Re-entered when the consumer drops credits inside onItems after a cancel; the outer call
+        // raises the done event once onItems has returned
+        std::lock_guard<std::recursive_mutex> lock(deliverMutex);
+        settled += ready.size() + skipped;
+        if (onItems && !ready.empty()) {
+            ++delivering;
+            onItems(std::move(ready));
+            --delivering;
+        }
+        // Whichever delivery completes the batch raises the done event
+        if (delivering == 0 && settled == urls.size() && !doneRaised) {
+            doneRaised = true;
+            if (onDone) onDone(report);
+        }
+    }
+
+}
@@ -0,0 +1,106 @@
+#ifndef AMF_BATCH_STREAM_H
+#define AMF_BATCH_STREAM_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <cstddef>
+
+#include "ByteBuffer.h"
+#include "Request.h"
+
+namespace aif{
+
+class ImageFetcher;
+class BatchStream;
+
+// Holds one slot of a stream's in-flight window. The slot is handed back, and the next
+// request of the batch is issued, when the credit is destroyed or release() is called.
+class Credit {
+    public:
+        Credit() = default;
+        explicit Credit(std::shared_ptr<BatchStream> stream);
+        Credit(Credit&& other) noexcept = default;
+        Credit& operator=(Credit&& other) noexcept;
+        ~Credit();
+
+        Credit(const Credit&) = delete;
+        Credit& operator=(const Credit&) = delete;
+
+        void release();
+    private:
+        std::shared_ptr<BatchStream> stream;
+    };
+
+struct BatchItem {
+        std::size_t index = 0;   // position of the request within the batch
+        bool success = false;
+        ByteBuffer data;         // the payload, or the error message when !success
+        Credit credit;
+    };
+
+struct BatchReport {
+        struct Item {
+            bool success = false;
+            std::string error;
+        };
+
+        std::size_t requested = 0;
+        std::size_t succeeded = 0;
+        std::vector<Item> items; // indexed like the requests
+
+        std::size_t failed() const { return requested - succeeded; }
+    };
+
+struct StreamOptions {
+        // Requests issued but not yet released by the consumer. Bounds the payloads held in memory.
+        std::size_t window = 32;
+        // Items gathered before a delivery; smaller groups are flushed when nothing else is pending.
+        std::size_t deliverEvery = 1;
+        Priority priority = Priority::Normal;
+    };
+
+using BatchItemsCallback = std::function<void(std::vector<BatchItem> items)>;
+using BatchDoneCallback = std::function<void(const BatchReport& report)>;
+
+// State of one streaming batch; see ImageFetcher::fetchStream().
+class BatchStream : public std::enable_shared_from_this<BatchStream> {
+    public:
+        BatchStream(ImageFetcher& fetcher, std::vector<std::string> urls, StreamOptions options,
+                    BatchItemsCallback onItems, BatchDoneCallback onDone, CancelToken token);
+
+        // Issues the first `window` requests.
+        void start();
+    private:
+        friend class Credit;
+
+        void onFetched(std::size_t index, bool success, ByteBuffer data);
+        void releaseSlot();
+        void issue(std::size_t count);
+        void settle(std::vector<BatchItem> ready, std::size_t skipped);
+
+        ImageFetcher& fetcher;
+        const std::vector<std::string> urls;
+        const StreamOptions options;
+        BatchItemsCallback onItems;
+        BatchDoneCallback onDone;
+        const CancelToken token;
+
+        std::mutex mutex;
+        std::size_t nextIndex = 0;    // next request to issue
+        std::size_t slotsInUse = 0;   // issued and not yet released
+        std::size_t fetching = 0;     // issued and not yet arrived
+        std::vector<BatchItem> pending;
+        BatchReport report;
+
+        // Serializes deliveries so the done event always follows the last item
+        std::recursive_mutex deliverMutex;
+        std::size_t settled = 0; // delivered or skipped after cancellation
+        int delivering = 0;
+        bool doneRaised = false;
+    };
+}
+
+#endif // AMF_BATCH_STREAM_H
@@ -0,0 +1,119 @@
+#include "ByteBuffer.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace aif{
+
+    ByteBuffer::ByteBuffer(std::vector<unsigned char>&& bytes) {
+        auto storage = std::make_shared<std::vector<unsigned char>>(std::move(bytes));
+        this->bytes = storage->data();
+        this->length = storage->size();
+        this->owner = std::move(storage);
+    }
+
+    ByteBuffer::ByteBuffer(const unsigned char* bytes, std::size_t length, std::shared_ptr<const void> owner, bool mapped)
+        : bytes(bytes), length(length), owner(std::move(owner)), mapped(mapped) {}
+
+#ifdef _WIN32
+    ByteBuffer ByteBuffer::mapFile(const std::string& path) {
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return {};
+
+        LARGE_INTEGER fileSize{};
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            return {};
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping) return {};
+
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (!view) return {};
+
+        std::shared_ptr<const void> owner(view, [](const void* p) { UnmapViewOfFile(p); });
+        return ByteBuffer(static_cast<const unsigned char*>(view), static_cast<std::size_t>(fileSize.QuadPart), std::move(owner), true);
+    }
+#else
+    ByteBuffer ByteBuffer::mapFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return {};
+
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            return {};
+        }
+
+        std::size_t size = static_cast<std::size_t>(st.st_size);
+        void* view = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // the mapping stays valid after closing
+        if (view == MAP_FAILED) return {};
+
+        std::shared_ptr<const void> owner(view, [size](const void* p) { ::munmap(const_cast<void*>(p), size); });
+        return ByteBuffer(static_cast<const unsigned char*>(view), size, std::move(owner), true);
+    }
+#endif
+
+
+    std::vector<unsigned char> BufferPool::acquire(std::size_t sizeHint) {
+        std::vector<unsigned char> bytes;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (sizeHint == 0) sizeHint = typicalSize;
+            if (!free.empty()) {
+                bytes = std::move(free.back());
+                free.pop_back();
+            }
+        }
+        bytes.clear();
+        bytes.reserve(sizeHint);
+        return bytes;
+    }
+
+    ByteBuffer BufferPool::seal(std::vector<unsigned char>&& bytes) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            // Track the payload size so the next acquire() reserves once instead of growing
+            typicalSize = std::max(bytes.size(), typicalSize - typicalSize / 8);
+        }
+
+        std::weak_ptr<BufferPool> pool = weak_from_this();
+        auto* storage = new std::vector<unsigned char>(std::move(bytes));
+        std::shared_ptr<const void> owner(storage, [pool](const void* p) {
+            auto* storage = static_cast<std::vector<unsigned char>*>(const_cast<void*>(p));
+            if (auto alive = pool.lock()) {
+                alive->recycle(std::move(*storage));
+            }
+            delete storage;
+        });
+        return ByteBuffer(storage->data(), storage->size(), std::move(owner), false);
+    }
+
+    void BufferPool::recycle(std::vector<unsigned char>&& bytes) {
+        if (bytes.capacity() == 0) return;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (free.size() < kMaxPooledBuffers) {
+            free.push_back(std::move(bytes));
+        }
+    }
+
+    std::size_t BufferPool::pooledCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return free.size();
+    }
+
+}
@@ -0,0 +1,76 @@
+#ifndef AMF_BYTE_BUFFER_H
+#define AMF_BYTE_BUFFER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstddef>
+
+namespace aif{
+
+// Immutable, reference-counted view over a block of bytes.
+// Copies share the same storage, which is either a heap vector or a read-only file mapping.
+class ByteBuffer {
+    public:
+        ByteBuffer() = default;
+
+        // Takes ownership of `bytes` without copying them.
+        explicit ByteBuffer(std::vector<unsigned char>&& bytes);
+
+        // Copies the range [first, last).
+        template<typename It>
+        ByteBuffer(It first, It last) : ByteBuffer(std::vector<unsigned char>(first, last)) {}
+
+        // Maps `path` read-only. Returns an empty buffer when the file cannot be mapped.
+        static ByteBuffer mapFile(const std::string& path);
+
+        const unsigned char* data() const { return bytes; }
+        std::size_t size() const { return length; }
+        bool empty() const { return length == 0; }
+
+        const unsigned char* begin() const { return bytes; }
+        const unsigned char* end() const { return bytes + length; }
+        unsigned char operator[](std::size_t i) const { return bytes[i]; }
+
+        // True when the bytes live in a file mapping rather than on the heap.
+        bool isMapped() const { return mapped; }
+    private:
+        friend class BufferPool;
+
+        ByteBuffer(const unsigned char* bytes, std::size_t length, std::shared_ptr<const void> owner, bool mapped);
+
+        const unsigned char* bytes = nullptr;
+        std::size_t length = 0;
+        std::shared_ptr<const void> owner;
+        bool mapped = false;
+    };
+
+// Recycles the heap storage behind response bodies.
+// Writers fill a vector from acquire(); seal() turns it into a ByteBuffer without copying,
+// and the storage comes back to the pool once the last ByteBuffer referencing it is gone.
+class BufferPool : public std::enable_shared_from_this<BufferPool> {
+    public:
+        static constexpr std::size_t kMaxPooledBuffers = 64;
+
+        static std::shared_ptr<BufferPool> create() { return std::shared_ptr<BufferPool>(new BufferPool()); }
+
+        // An empty vector with capacity for at least `sizeHint` bytes (or the typical payload size when 0).
+        std::vector<unsigned char> acquire(std::size_t sizeHint = 0);
+
+        ByteBuffer seal(std::vector<unsigned char>&& bytes);
+
+        // Storage that was not sealed (e.g. an error body) can be handed back directly.
+        void recycle(std::vector<unsigned char>&& bytes);
+
+        std::size_t pooledCount() const;
+    private:
+        BufferPool() = default;
+
+        mutable std::mutex mutex;
+        std::vector<std::vector<unsigned char>> free;
+        std::size_t typicalSize = 0;
+    };
+}
+
+#endif // AMF_BYTE_BUFFER_H
@@ -0,0 +1,147 @@
+#include "CurlMulti.h"
+#include <mutex>
+#include <stdexcept>
+
+namespace aif{
+
+    CurlMulti::CurlMulti(long maxHostConnections, CURLSH* share) : share(share) {
+        static std::once_flag globalInit;
+        std::call_once(globalInit, []() { curl_global_init(CURL_GLOBAL_DEFAULT); });
+
+        multi = curl_multi_init();
+        if (!multi) {
+            throw std::runtime_error("curl_multi_init failed");
+        }
+
+        // Prefer multiplexing many streams over a few HTTP/2 connections instead of opening new ones
+        curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+        if (maxHostConnections > 0) {
+            curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, maxHostConnections);
+        }
+    }
+
+    CurlMulti::~CurlMulti() {
+        abortAll();
+        curl_multi_cleanup(multi);
+    }
+
+    void CurlMulti::abortAll() {
+        // Callbacks may add transfers; those are aborted on the next pass
+        while (!transfers.empty()) {
+            auto pending = std::move(transfers);
+            transfers.clear();
+            for (auto& [easy, transfer] : pending) {
+                curl_multi_remove_handle(multi, easy);
+                curl_easy_cleanup(easy);
+                transfer->done(0, std::move(transfer->body), 0);
+            }
+        }
+    }
+
+    void CurlMulti::add(const std::string& url, DoneCallback done, AbortPredicate shouldAbort) {
+        CURL* easy = curl_easy_init();
+        if (!easy) {
+            done(0, {}, 0);
+            return;
+        }
+
+        auto transfer = std::make_unique<Transfer>();
+        transfer->easy = easy;
+        transfer->done = std::move(done);
+        transfer->shouldAbort = std::move(shouldAbort);
+        if (buffers) {
+            transfer->body = buffers->acquire();
+        }
+
+        curl_easy_setopt(easy, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+        // Wait for a multiplexable connection rather than opening a new one per transfer
+        curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L);
+        curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, &CurlMulti::writeBody);
+        curl_easy_setopt(easy, CURLOPT_WRITEDATA, transfer.get());
+        curl_easy_setopt(easy, CURLOPT_PRIVATE, transfer.get());
+        if (transfer->shouldAbort) {
+            curl_easy_setopt(easy, CURLOPT_XFERINFOFUNCTION, &CurlMulti::checkAbort);
+            curl_easy_setopt(easy, CURLOPT_XFERINFODATA, transfer.get());
+            curl_easy_setopt(easy, CURLOPT_NOPROGRESS, 0L);
+        }
+        if (share) {
+            curl_easy_setopt(easy, CURLOPT_SHARE, share);
+        }
+        if (!verifyTls) {
+            curl_easy_setopt(easy, CURLOPT_SSL_VERIFYPEER, 0L);
+            curl_easy_setopt(easy, CURLOPT_SSL_VERIFYHOST, 0L);
+        }
+
+        if (curl_multi_add_handle(multi, easy) != CURLM_OK) {
+            curl_easy_cleanup(easy);
+            transfer->done(0, {}, 0);
+            return;
+        }
+        transfers.emplace(easy, std::move(transfer));
+    }
+
+    int CurlMulti::poll(int timeoutMs) {
+        int running = 0;
+        curl_multi_perform(multi, &running);
+        curl_multi_poll(multi, nullptr, 0, timeoutMs, nullptr);
+        curl_multi_perform(multi, &running);
+
+        int finished = 0;
+        int pending = 0;
+        while (CURLMsg* msg = curl_multi_info_read(multi, &pending)) {
+            if (msg->msg != CURLMSG_DONE) continue;
+
+            CURL* easy = msg->easy_handle;
+            long status = 0;
+            curl_off_t retryAfter = 0;
+            curl_off_t contentLength = -1;
+            if (msg->data.result == CURLE_OK) {
+                curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &status);
+                curl_easy_getinfo(easy, CURLINFO_RETRY_AFTER, &retryAfter);
+                curl_easy_getinfo(easy, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &contentLength);
+            }
+
+            curl_multi_remove_handle(multi, easy);
+            auto node = transfers.extract(easy);
+            curl_easy_cleanup(easy);
+
+            if (!node.empty()) {
+                Transfer& transfer = *node.mapped();
+                // A body shorter than announced is a failed transfer
+                if (contentLength > 0 && transfer.body.size() < static_cast<size_t>(contentLength)) status = 0;
+                transfer.done(status, std::move(transfer.body), static_cast<long>(retryAfter));
+            }
+            ++finished;
+        }
+        return finished;
+    }
+
+    void CurlMulti::wakeup() {
+        curl_multi_wakeup(multi);
+    }
+
+    size_t CurlMulti::writeBody(char* data, size_t size, size_t nmemb, void* userdata) {
+        auto* transfer = static_cast<Transfer*>(userdata);
+        size_t bytes = size * nmemb;
+
+        // Reserve the whole body once the headers are in, so the buffer never reallocates mid-transfer
+        if (!transfer->sized) {
+            transfer->sized = true;
+            curl_off_t contentLength = -1;
+            if (curl_easy_getinfo(transfer->easy, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &contentLength) == CURLE_OK && contentLength > 0) {
+                transfer->body.reserve(static_cast<size_t>(contentLength));
+            }
+        }
+        transfer->body.insert(transfer->body.end(), data, data + bytes);
+        return bytes;
+    }
+
+    int CurlMulti::checkAbort(void* userdata, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+        auto* transfer = static_cast<Transfer*>(userdata);
+        return transfer->shouldAbort() ? 1 : 0;
+    }
+
+}
@@ -0,0 +1,76 @@
+#ifndef AMF_CURL_MULTI_H
+#define AMF_CURL_MULTI_H
+
+#include <string>
+#include <functional>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <atomic>
+
+#include <curl/curl.h>
+
+#include "ByteBuffer.h"
+
+namespace aif{
+
+// Thin RAII wrapper over a libcurl multi handle.
+// Every method except wakeup() and setVerifyTls() must be called from the thread that drives poll().
+class CurlMulti {
+    public:
+        // `status` is the HTTP status code, or 0 when the transfer failed or its body ended short.
+        // `retryAfter` is the server's Retry-After in seconds, 0 if absent.
+        using DoneCallback = std::function<void(long status, std::vector<unsigned char>&& body, long retryAfter)>;
+        // Polled while the transfer runs; returning true aborts it (it then completes with status 0).
+        using AbortPredicate = std::function<bool()>;
+
+        // `maxHostConnections` caps the connections opened per host (0 = unlimited).
+        // HTTP/2 transfers are multiplexed over existing connections; HTTP/1.1 needs one per transfer.
+        // `share` (optional) is attached to every transfer, e.g. for a shared DNS/TLS session cache.
+        explicit CurlMulti(long maxHostConnections = 0, CURLSH* share = nullptr);
+        ~CurlMulti();
+
+        CurlMulti(const CurlMulti&) = delete;
+        CurlMulti& operator=(const CurlMulti&) = delete;
+
+        void add(const std::string& url, DoneCallback done, AbortPredicate shouldAbort = {});
+
+        // Drives all transfers and waits up to `timeoutMs` for socket activity or wakeup().
+        // Completion callbacks run on the calling thread. Returns the number of finished transfers.
+        int poll(int timeoutMs);
+
+        // Stops every transfer and completes it with status 0, as if it had failed. The destructor does
+        // the same, so no `done` callback is ever lost.
+        void abortAll();
+
+        // Interrupts a blocking poll(). Safe to call from any thread.
+        void wakeup();
+
+        // Turns certificate verification off for local stand-in servers with self-signed certificates.
+        void setVerifyTls(bool enabled) { verifyTls = enabled; }
+
+        // Response bodies are written straight into storage taken from `pool`, sized from Content-Length.
+        void setBufferPool(std::shared_ptr<BufferPool> pool) { buffers = std::move(pool); }
+
+        std::size_t inFlight() const { return transfers.size(); }
+    private:
+        struct Transfer {
+            CURL* easy = nullptr;
+            std::vector<unsigned char> body;
+            bool sized = false;
+            DoneCallback done;
+            AbortPredicate shouldAbort;
+        };
+
+        static size_t writeBody(char* data, size_t size, size_t nmemb, void* userdata);
+        static int checkAbort(void* userdata, curl_off_t, curl_off_t, curl_off_t, curl_off_t);
+
+        CURLM* multi;
+        CURLSH* share;
+        std::atomic<bool> verifyTls{true};
+        std::shared_ptr<BufferPool> buffers;
+        std::unordered_map<CURL*, std::unique_ptr<Transfer>> transfers;
+    };
+}
+
+#endif // AMF_CURL_MULTI_H
@@ -0,0 +1,266 @@
+#include "DiskCache.h"
+#include <fstream>
+#include <algorithm>
+#include <thread>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+namespace aif{
+
+    namespace {
+        constexpr std::uint32_t kRoundConstants[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+        };
+
+        inline std::uint32_t rotr(std::uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+    }
+
+    ContentHasher::ContentHasher()
+        : state{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19} {}
+
+    void ContentHasher::update(const unsigned char* data, std::size_t size) {
+        totalLength += size;
+        if (blockLength > 0) {
+            std::size_t take = std::min(size, sizeof(block) - blockLength);
+            std::memcpy(block + blockLength, data, take);
+            blockLength += take;
+            data += take;
+            size -= take;
+            if (blockLength < sizeof(block)) return;
+            compress(block);
+            blockLength = 0;
+        }
+        // Whole blocks straight from the input, without staging them
+        for (; size >= sizeof(block); data += sizeof(block), size -= sizeof(block)) compress(data);
+        if (size > 0) std::memcpy(block, data, size);
+        blockLength = size;
+    }
+
+    std::string ContentHasher::hex() {
+        std::uint64_t bits = totalLength * 8;
+        block[blockLength++] = 0x80;
+        if (blockLength > 56) {
+            std::memset(block + blockLength, 0, sizeof(block) - blockLength);
+            compress(block);
+            blockLength = 0;
+        }
+        std::memset(block + blockLength, 0, 56 - blockLength);
+        for (int i = 0; i < 8; ++i) block[56 + i] = static_cast<unsigned char>(bits >> (56 - 8 * i));
+        compress(block);
+        blockLength = 0;
+
+        std::ostringstream ss;
+        ss << std::hex << std::setfill('0');
+        for (std::uint32_t word : state) ss << std::setw(8) << word;
+        return ss.str();
+    }
+
+    void ContentHasher::compress(const unsigned char* chunk) {
+        std::uint32_t w[64];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = (std::uint32_t(chunk[4 * i]) << 24) | (std::uint32_t(chunk[4 * i + 1]) << 16) |
+                   (std::uint32_t(chunk[4 * i + 2]) << 8) | std::uint32_t(chunk[4 * i + 3]);
+        }
+        for (int i = 16; i < 64; ++i) {
+            std::uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            std::uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        std::uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        std::uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            std::uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + kRoundConstants[i] + w[i];
+            std::uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+
+    std::string contentHash(const unsigned char* data, std::size_t size) {
+        ContentHasher hasher;
+        hasher.update(data, size);
+        return hasher.hex();
+    }
+
+    DiskCache::DiskCache(const fs::path& directory, std::uint64_t maxBytes)
+        : directory(directory), limitBytes(maxBytes) {
+        std::error_code ec;
+        fs::create_directories(directory, ec);
+
+        // Rebuild the index from disk, most recently used first
+        struct Found { std::string key; std::uint64_t size; fs::file_time_type time; };
+        std::vector<Found> found;
+        for (const auto& file : fs::recursive_directory_iterator(directory, ec)) {
+            if (!file.is_regular_file()) continue;
+            if (file.path().extension() == ".tmp") {
+                // Left by a write that never got to its rename; nothing will ever finish it
+                std::error_code removeError;
+                fs::remove(file.path(), removeError);
+                continue;
+            }
+            if (file.path().has_extension()) continue;
+            found.push_back({file.path().filename().string(), file.file_size(), file.last_write_time()});
+        }
+        std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) { return a.time > b.time; });
+
+        for (const auto& f : found) {
+            lru.push_back({f.key, f.size});
+            index[f.key] = std::prev(lru.end());
+            replayOrder.push_back(f.key);
+            usedBytes += f.size;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        evictLocked();
+    }
+
+    std::string DiskCache::keyOf(const ByteBuffer& payload) {
+        return contentHash(payload.data(), payload.size());
+    }
+
+    std::string DiskCache::put(const ByteBuffer& payload) {
+        std::string key = keyOf(payload);
+        put(key, {{payload.data(), payload.size()}});
+        return key;
+    }
+
+    void DiskCache::put(const std::string& key, const std::vector<Part>& parts) {
+        fs::path path = pathOf(key);
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            auto it = index.find(key);
+            if (it != index.end()) {
+                touchLocked(it->second);
+                lock.unlock();
+                touchFile(path);
+                return;
+            }
+        }
+
+        // Write to a uniquely named temporary and rename, so readers never map a partial file
+        std::error_code ec;
+        fs::create_directories(path.parent_path(), ec);
+
+        std::ostringstream tmpName;
+        tmpName << key << "." << std::this_thread::get_id() << ".tmp";
+        fs::path tmp = path.parent_path() / tmpName.str();
+        std::uint64_t size = 0;
+        {
+            std::ofstream out(tmp, std::ios::binary);
+            for (const auto& [data, length] : parts) {
+                out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(length));
+                size += length;
+            }
+            if (!out) {
+                fs::remove(tmp, ec);
+                return;
+            }
+        }
+        fs::rename(tmp, path, ec);
+        if (ec) {
+            fs::remove(tmp, ec);
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (index.find(key) == index.end()) {
+            lru.push_front({key, size});
+            index[key] = lru.begin();
+            replayOrder.push_back(key);
+            usedBytes += size;
+            evictLocked();
+        }
+    }
+
+    std::optional<ByteBuffer> DiskCache::get(const std::string& key) {
+        std::uint64_t size = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = index.find(key);
+            if (it == index.end()) return std::nullopt;
+            touchLocked(it->second);
+            size = it->second->size;
+        }
+
+        fs::path path = pathOf(key);
+        touchFile(path);
+        ByteBuffer buffer = ByteBuffer::mapFile(path.string());
+        if (buffer.empty() || buffer.size() != size) return std::nullopt;
+        return buffer;
+    }
+
+    std::optional<ByteBuffer> DiskCache::replayNext() {
+        std::string key;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (replayOrder.empty()) return std::nullopt;
+            key = replayOrder[replayCursor++ % replayOrder.size()];
+        }
+        return get(key);
+    }
+
+    void DiskCache::setMaxBytes(std::uint64_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        limitBytes = bytes;
+        evictLocked();
+    }
+
+    std::uint64_t DiskCache::maxBytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return limitBytes;
+    }
+
+    std::uint64_t DiskCache::totalBytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return usedBytes;
+    }
+
+    std::size_t DiskCache::entryCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return lru.size();
+    }
+
+    fs::path DiskCache::pathOf(const std::string& key) const {
+        // Fan out over 256 subdirectories to keep directory listings short
+        return directory / key.substr(0, 2) / key;
+    }
+
+    void DiskCache::touchLocked(std::list<Entry>::iterator it) {
+        lru.splice(lru.begin(), lru, it);
+    }
+
+    void DiskCache::touchFile(const fs::path& path) {
+        // Only orders entries after a restart, so a race with eviction removing the file is harmless
+        std::error_code ec;
+        fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    }
+
+    void DiskCache::evictLocked() {
+        while (usedBytes > limitBytes && !lru.empty()) {
+            const Entry& victim = lru.back();
+
+            // Mappings handed out earlier stay valid on POSIX; on Windows the delete may fail while mapped
+            std::error_code ec;
+            fs::remove(pathOf(victim.key), ec);
+
+            replayOrder.erase(std::remove(replayOrder.begin(), replayOrder.end(), victim.key), replayOrder.end());
+            index.erase(victim.key);
+            usedBytes -= victim.size;
+            lru.pop_back();
+        }
+    }
+
+}
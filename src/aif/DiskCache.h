@@ -0,0 +1,94 @@
+#ifndef AMF_DISK_CACHE_H
+#define AMF_DISK_CACHE_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <cstdint>
+#include <unordered_map>
+#include <filesystem>
+
+#include "ByteBuffer.h"
+
+namespace aif{
+
+// Incremental SHA-256. Cached payloads are named by their digest, so two entries share a name only if
+// they hold the same bytes; a short non-cryptographic hash would let a collision serve the wrong image.
+class ContentHasher {
+    public:
+        ContentHasher();
+
+        void update(const unsigned char* data, std::size_t size);
+
+        // The digest as 64 lowercase hex digits. Ends the hash: call it once, after the last update().
+        std::string hex();
+    private:
+        void compress(const unsigned char* chunk);
+
+        std::uint32_t state[8];
+        unsigned char block[64];
+        std::size_t blockLength = 0;
+        std::uint64_t totalLength = 0;
+    };
+
+// SHA-256 of `size` bytes as 64 hex digits; the content address of cached payloads.
+std::string contentHash(const unsigned char* data, std::size_t size);
+
+// Content-addressed on-disk store for fetched payloads, bounded by size with LRU eviction.
+// Entries are read back as read-only file mappings, so hits are never copied.
+// Recency is kept in the files' modification times and survives restarts. Temporaries left by writes
+// that were interrupted are deleted when the cache opens.
+class DiskCache {
+    public:
+        DiskCache(const std::filesystem::path& directory, std::uint64_t maxBytes);
+
+        // Stores `payload` under its content hash (no-op if already present) and returns the key.
+        std::string put(const ByteBuffer& payload);
+
+        // Stores `parts` back to back under `key` (no-op if already present), for entries keyed by
+        // something other than their own bytes or assembled from pieces that live apart.
+        using Part = std::pair<const unsigned char*, std::size_t>;
+        void put(const std::string& key, const std::vector<Part>& parts);
+
+        // Maps the entry for `key` and marks it most recently used. Misses when the file on disk is not
+        // the size that was stored, e.g. after it was truncated or replaced behind the cache's back.
+        std::optional<ByteBuffer> get(const std::string& key);
+
+        // Serves the stored entries one after another, wrapping around, for offline replay.
+        std::optional<ByteBuffer> replayNext();
+
+        void setMaxBytes(std::uint64_t bytes);
+
+        std::uint64_t maxBytes() const;
+        std::uint64_t totalBytes() const;
+        std::size_t entryCount() const;
+
+        static std::string keyOf(const ByteBuffer& payload);
+    private:
+        struct Entry {
+            std::string key;
+            std::uint64_t size;
+        };
+
+        std::filesystem::path pathOf(const std::string& key) const;
+        // Moves `it` to the front; the caller updates the file's time with touchFile() after unlocking.
+        void touchLocked(std::list<Entry>::iterator it);
+        static void touchFile(const std::filesystem::path& path);
+        void evictLocked();
+
+        std::filesystem::path directory;
+        std::uint64_t limitBytes;
+        std::uint64_t usedBytes = 0;
+
+        mutable std::mutex mutex;
+        std::list<Entry> lru; // front = most recently used
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        std::vector<std::string> replayOrder;
+        std::size_t replayCursor = 0;
+    };
+}
+
+#endif // AMF_DISK_CACHE_H
@@ -0,0 +1,64 @@
+#include "Executor.h"
+#include <algorithm>
+
+namespace aif{
+
+    ThreadPoolExecutor::ThreadPoolExecutor(std::size_t threadCount) {
+        threadCount = std::max<std::size_t>(threadCount, 1);
+        for (std::size_t i = 0; i < threadCount; ++i) {
+            threads.emplace_back([this]() { run(); });
+        }
+    }
+
+    ThreadPoolExecutor::~ThreadPoolExecutor() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cond.notify_all();
+        for (auto& thread : threads) thread.join();
+    }
+
+    void ThreadPoolExecutor::post(std::function<void()> work) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(std::move(work));
+        }
+        cond.notify_one();
+    }
+
+    void ThreadPoolExecutor::run() {
+        while (true) {
+            std::function<void()> work;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait(lock, [this]() { return stopping || !queue.empty(); });
+                // Only leave once the queue is drained, including work posted by work run meanwhile
+                if (queue.empty()) return;
+                work = std::move(queue.front());
+                queue.pop_front();
+            }
+            work();
+        }
+    }
+
+    FrameExecutor::~FrameExecutor() {
+        while (runPending() > 0) {}
+    }
+
+    void FrameExecutor::post(std::function<void()> work) {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(work));
+    }
+
+    std::size_t FrameExecutor::runPending() {
+        std::vector<std::function<void()>> pending;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.swap(queue);
+        }
+        for (auto& work : pending) work();
+        return pending.size();
+    }
+
+}
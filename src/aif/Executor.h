@@ -0,0 +1,72 @@
+#ifndef AMF_EXECUTOR_H
+#define AMF_EXECUTOR_H
+
+#include <functional>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <coroutine>
+#include <cstddef>
+
+namespace aif{
+
+// Somewhere to run work: a thread pool, or a thread that drains a queue at a known point.
+class Executor {
+    public:
+        virtual ~Executor() = default;
+        virtual void post(std::function<void()> work) = 0;
+    };
+
+// Fixed set of threads draining one queue, e.g. for decoding. Work still queued when the pool is
+// destroyed runs before the destructor returns, so a coroutine resumed through post() is never left
+// suspended with its frame leaked.
+class ThreadPoolExecutor : public Executor {
+    public:
+        explicit ThreadPoolExecutor(std::size_t threadCount);
+        ~ThreadPoolExecutor() override;
+
+        void post(std::function<void()> work) override;
+
+        std::size_t threadCount() const { return threads.size(); }
+    private:
+        void run();
+
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::deque<std::function<void()>> queue;
+        bool stopping = false;
+        std::vector<std::thread> threads;
+    };
+
+// Queues work until the owning thread calls runPending(), e.g. the GL thread at the start of a frame.
+// The destructor runs whatever is still queued, and what that work posts, on the destroying thread, so
+// coroutines waiting to continue here finish instead of leaking their frames.
+class FrameExecutor : public Executor {
+    public:
+        FrameExecutor() = default;
+        ~FrameExecutor() override;
+
+        void post(std::function<void()> work) override;
+
+        // Runs everything posted before the call. Work posted meanwhile waits for the next call.
+        std::size_t runPending();
+    private:
+        std::mutex mutex;
+        std::vector<std::function<void()>> queue;
+    };
+
+// `co_await resumeOn(executor)` continues the coroutine on `executor`.
+inline auto resumeOn(Executor& executor) {
+    struct Awaiter {
+        Executor& executor;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { executor.post([handle]() { handle.resume(); }); }
+        void await_resume() const noexcept {}
+    };
+    return Awaiter{executor};
+}
+}
+
+#endif // AMF_EXECUTOR_H
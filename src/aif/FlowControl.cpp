@@ -0,0 +1,140 @@
+#include "FlowControl.h"
+#include <algorithm>
+#include <cmath>
+
+namespace aif{
+
+    AimdController::AimdController(double initial, double minimum, double maximum)
+        : current(initial), minimum(minimum), maximum(std::max(minimum, maximum)) {
+        current = std::clamp(current, this->minimum, this->maximum);
+    }
+
+    void AimdController::onSuccess(double latencyMs) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        smoothedMs = smoothedMs == 0.0 ? latencyMs : smoothedMs + 0.2 * (latencyMs - smoothedMs);
+        if (baselineMs == 0.0 || latencyMs < baselineMs) {
+            baselineMs = latencyMs;
+        } else {
+            // Let the baseline follow a genuinely slower link instead of backing off forever
+            baselineMs += 0.005 * (latencyMs - baselineMs);
+        }
+
+        if (smoothedMs > baselineMs * kLatencyTolerance) {
+            decreaseLocked(kLatencyBackoff);
+        } else {
+            current = std::min(maximum, current + (slowStart ? 1.0 : 1.0 / current));
+        }
+    }
+
+    void AimdController::onThrottled() {
+        std::lock_guard<std::mutex> lock(mutex);
+        decreaseLocked(kDecreaseFactor);
+    }
+
+    void AimdController::decreaseLocked(double factor) {
+        auto now = Clock::now();
+        if (now < holdUntil) return;
+
+        slowStart = false;
+        current = std::max(minimum, current * factor);
+        auto roundTrip = std::chrono::duration<double, std::milli>(std::max(smoothedMs, 50.0));
+        holdUntil = now + std::chrono::duration_cast<Clock::duration>(roundTrip);
+    }
+
+    void AimdController::setMaximum(double maximum) {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->maximum = std::max(minimum, maximum);
+        current = std::min(current, this->maximum);
+    }
+
+    void AimdController::reset(double initial) {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = std::clamp(initial, minimum, maximum);
+        baselineMs = 0.0;
+        smoothedMs = 0.0;
+        slowStart = true;
+        holdUntil = {};
+    }
+
+    std::size_t AimdController::limit() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return static_cast<std::size_t>(current);
+    }
+
+    double AimdController::smoothedLatencyMs() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return smoothedMs;
+    }
+
+    void RateLimiter::configure(double perSecond, double burst) {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->perSecond = perSecond;
+        this->burst = std::max(1.0, burst);
+        buckets.clear();
+    }
+
+    double RateLimiter::rate() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return perSecond;
+    }
+
+    Clock::duration RateLimiter::acquire(const std::string& host, Clock::time_point now) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto [it, inserted] = buckets.try_emplace(host);
+        Bucket& bucket = it->second;
+        if (inserted) {
+            bucket.tokens = burst;
+            bucket.refilled = now;
+        }
+
+        if (now < bucket.pausedUntil) return bucket.pausedUntil - now;
+        if (perSecond <= 0.0) return Clock::duration::zero();
+
+        double elapsed = std::chrono::duration<double>(now - bucket.refilled).count();
+        bucket.tokens = std::min(burst, bucket.tokens + elapsed * perSecond);
+        bucket.refilled = now;
+
+        if (bucket.tokens >= 1.0) {
+            bucket.tokens -= 1.0;
+            return Clock::duration::zero();
+        }
+
+        auto wait = std::chrono::duration<double>((1.0 - bucket.tokens) / perSecond);
+        return std::chrono::duration_cast<Clock::duration>(wait) + Clock::duration(1);
+    }
+
+    void RateLimiter::pauseUntil(const std::string& host, Clock::time_point until) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Bucket& bucket = buckets[host];
+        bucket.pausedUntil = std::max(bucket.pausedUntil, until);
+    }
+
+    void RetryPolicy::configure(int maxAttempts, std::chrono::milliseconds baseDelay, std::chrono::milliseconds maxDelay) {
+        std::lock_guard<std::mutex> lock(mutex);
+        attempts = std::max(1, maxAttempts);
+        this->baseDelay = baseDelay;
+        this->maxDelay = maxDelay;
+    }
+
+    int RetryPolicy::maxAttempts() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return attempts;
+    }
+
+    bool RetryPolicy::retryable(long status) {
+        return status == 0 || status == 429 || status == 502 || status == 503 || status == 504;
+    }
+
+    Clock::duration RetryPolicy::delay(int attempt, std::chrono::seconds retryAfter) {
+        if (retryAfter.count() > 0) return retryAfter;
+
+        // Full jitter: uniform in [0, min(cap, base * 2^attempt)], so retries from a burst spread out
+        std::lock_guard<std::mutex> lock(mutex);
+        double ceiling = std::min<double>(maxDelay.count(), baseDelay.count() * std::pow(2.0, attempt - 1));
+        std::uniform_real_distribution<double> jitter(0.0, ceiling);
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(jitter(random)));
+    }
+
+}
@@ -0,0 +1,96 @@
+#ifndef AMF_FLOW_CONTROL_H
+#define AMF_FLOW_CONTROL_H
+
+#include <string>
+#include <mutex>
+#include <chrono>
+#include <random>
+#include <unordered_map>
+#include <cstddef>
+
+namespace aif{
+
+using Clock = std::chrono::steady_clock;
+
+// Additive-increase / multiplicative-decrease concurrency limit.
+// The limit grows by one per window of successful requests while latency stays near the
+// best seen, and is cut when the provider throttles, fails, or latency inflates (queueing).
+class AimdController {
+    public:
+        static constexpr double kDecreaseFactor = 0.5;   // on throttling or failure
+        static constexpr double kLatencyBackoff = 0.9;   // on latency inflation
+        static constexpr double kLatencyTolerance = 2.0; // smoothed / baseline latency that counts as inflated
+
+        AimdController(double initial, double minimum, double maximum);
+
+        // `latencyMs` is the request's time on the wire.
+        void onSuccess(double latencyMs);
+        // 429/503 or a transport error.
+        void onThrottled();
+
+        void setMaximum(double maximum);
+        void reset(double initial);
+
+        std::size_t limit() const;
+        double smoothedLatencyMs() const;
+    private:
+        void decreaseLocked(double factor);
+
+        mutable std::mutex mutex;
+        double current;
+        double minimum;
+        double maximum;
+        double baselineMs = 0.0;   // best recent latency, drifting up slowly
+        double smoothedMs = 0.0;
+        bool slowStart = true;         // grow by one per success (doubling per round trip) until the first decrease
+        Clock::time_point holdUntil{}; // one decrease per round trip: responses already in flight say nothing new
+    };
+
+// Per-host token buckets. Hosts may also be paused outright, e.g. for a Retry-After.
+class RateLimiter {
+    public:
+        // `perSecond` <= 0 disables limiting. `burst` is the bucket capacity.
+        void configure(double perSecond, double burst);
+
+        double rate() const;
+
+        // Takes a token for `host`. Returns zero on success, otherwise how long to wait before trying again.
+        Clock::duration acquire(const std::string& host, Clock::time_point now);
+
+        void pauseUntil(const std::string& host, Clock::time_point until);
+    private:
+        struct Bucket {
+            double tokens = 0.0;
+            Clock::time_point refilled{};
+            Clock::time_point pausedUntil{};
+        };
+
+        mutable std::mutex mutex;
+        double perSecond = 0.0;
+        double burst = 1.0;
+        std::unordered_map<std::string, Bucket> buckets;
+    };
+
+// Exponential backoff with full jitter; a server-provided Retry-After takes precedence.
+class RetryPolicy {
+    public:
+        // `maxAttempts` includes the first try.
+        void configure(int maxAttempts, std::chrono::milliseconds baseDelay, std::chrono::milliseconds maxDelay);
+
+        int maxAttempts() const;
+
+        // HTTP 429/502/503/504, or 0 for a transport error.
+        static bool retryable(long status);
+
+        // Delay before attempt number `attempt` (1 = first retry).
+        Clock::duration delay(int attempt, std::chrono::seconds retryAfter);
+    private:
+        mutable std::mutex mutex;
+        int attempts = 4;
+        std::chrono::milliseconds baseDelay{200};
+        std::chrono::milliseconds maxDelay{10000};
+        std::minstd_rand random{std::random_device{}()};
+    };
+}
+
+#endif // AMF_FLOW_CONTROL_H
@@ -1,111 +1,670 @@
 #include "ImageFetcher.h"
 #include <cpr/cpr.h>
 #include <iostream>
+#include <algorithm>
+#include <optional>
+#include <iterator>
 
 namespace aif{ 
 
-    ImageFetcher::ImageFetcher() : running(true), worker(&ImageFetcher::workerLoop, this) {}
+    namespace {
+        // Upper bound on how long the multiplexer sleeps when neither sockets nor the queue need it
+        constexpr int kMultiplexPollTimeoutMs = 250;
+    }
+
+    ImageFetcher::ImageFetcher(std::size_t workerCount, Engine engine)
+        : running(true), currentEngine(Engine::ThreadPool), inFlightLimit(kDefaultMaxInFlight),
+          currentCacheMode(CacheMode::Off),
+          controller(kInitialAdaptiveConcurrency, 1, kDefaultMaxInFlight),
+          buffers(BufferPool::create()), multi(0, sessions.share()) {
+        multi.setBufferPool(buffers);
+        setWorkerCount(workerCount);
+        setEngine(engine);
+    }
 
     ImageFetcher::~ImageFetcher() {
+        shutdown();
+    }
+
+    void ImageFetcher::shutdown() {
         running = false;
-        queueCond.notify_all();
-        if (worker.joinable()) {
-            worker.join();
+        workersIdle.notifyAll();
+        multi.wakeup();
+
+        // Joined outside the lock, since their last callbacks may ask for the worker count
+        std::vector<Worker> stopping;
+        {
+            std::lock_guard<std::mutex> lock(workersMutex);
+            stopping.swap(workers);
+            std::move(retiredWorkers.begin(), retiredWorkers.end(), std::back_inserter(stopping));
+            retiredWorkers.clear();
+        }
+        // jthread requests stop and joins on destruction
+        stopping.clear();
+        if (multiplexer.joinable()) {
+            multiplexer.request_stop();
+            multiplexer.join();
         }
     }
 
-    void ImageFetcher::fetchOne(const std::string& url, const OneImageCallback& callback) {
+    void ImageFetcher::setWorkerCount(std::size_t count) {
+        count = std::max<std::size_t>(count, 1);
+
+        std::lock_guard<std::mutex> lock(workersMutex);
+
+        // Only workers retired by an earlier resize that have already exited: joining them returns at once
+        std::erase_if(retiredWorkers, [](const Worker& worker) { return worker.exited->load(); });
+
+        while (workers.size() < count) {
+            auto exited = std::make_shared<std::atomic<bool>>(false);
+            std::jthread thread([this, exited](std::stop_token stopToken) {
+                workerLoop(stopToken);
+                *exited = true;
+            });
+            workers.push_back({std::move(thread), std::move(exited)});
+        }
+
+        if (workers.size() > count) {
+            for (auto it = workers.begin() + count; it != workers.end(); ++it) {
+                it->thread.request_stop();
+                retiredWorkers.push_back(std::move(*it));
+            }
+            workers.erase(workers.begin() + count, workers.end());
+            workersIdle.notifyAll();
+        }
+
+        if (currentEngine == Engine::ThreadPool) {
+            controller.setMaximum(static_cast<double>(workers.size()));
+        }
+    }
+
+    std::size_t ImageFetcher::workerCount() const {
+        std::lock_guard<std::mutex> lock(workersMutex);
+        return workers.size();
+    }
+
+    void ImageFetcher::setEngine(Engine engine) {
         {
+            std::lock_guard<std::mutex> lock(workersMutex);
+            if (engine == Engine::Multiplexed && !multiplexer.joinable()) {
+                multiplexer = std::jthread([this](std::stop_token stopToken) { multiplexLoop(stopToken); });
+            }
+        }
+
+        // Sleeping workers re-check the engine after prepare(), so the notify below cannot be missed
+        currentEngine = engine;
+        updateConcurrencyCap();
+        workersIdle.notifyAll();
+        multi.wakeup();
+    }
+
+    void ImageFetcher::setMaxInFlight(std::size_t count) {
+        inFlightLimit = std::max<std::size_t>(count, 1);
+        updateConcurrencyCap();
+        multi.wakeup();
+    }
+
+    void ImageFetcher::updateConcurrencyCap() {
+        // The controller never allows more than the engine can run
+        double cap = currentEngine == Engine::ThreadPool ? static_cast<double>(workerCount()) : static_cast<double>(inFlightLimit);
+        controller.setMaximum(cap);
+    }
+
+    void ImageFetcher::setAdaptive(bool enabled) {
+        if (enabled && !adaptiveEnabled) {
+            controller.reset(kInitialAdaptiveConcurrency);
+        }
+        adaptiveEnabled = enabled;
+        workersIdle.notifyAll();
+        multi.wakeup();
+    }
+
+    void ImageFetcher::setRateLimit(double perSecond, double burst) {
+        limiter.configure(perSecond, burst);
+    }
+
+    void ImageFetcher::setRetryPolicy(int maxAttempts, std::chrono::milliseconds baseDelay, std::chrono::milliseconds maxDelay) {
+        retryPolicy.configure(maxAttempts, baseDelay, maxDelay);
+    }
+
+    ImageFetcher::FlowStats ImageFetcher::flowStats() const {
+        FlowStats stats{};
+        stats.concurrencyLimit = controller.limit();
+        stats.inFlight = networkInFlight;
+        stats.throttled = throttledCount;
+        stats.retries = retryCount;
+        stats.latencyMs = controller.smoothedLatencyMs();
+        stats.delayed = delayedCount;
+        return stats;
+    }
+
+    void ImageFetcher::warmUp(const std::string& url, std::size_t connections, Priority priority) {
+        if (currentCacheMode == CacheMode::Replay || currentEngine != Engine::ThreadPool) return;
+
+        std::size_t missing = sessions.planWarmUp(url, connections);
+        std::vector<Task> tasks;
+        tasks.reserve(missing);
+        for (std::size_t i = 0; i < missing; ++i) {
+            Task task{url, [this, url](bool, RawImage) { sessions.finishWarmUp(url); }, {}, priority};
+            task.warmUp = true;
+            tasks.push_back(std::move(task));
+        }
+        enqueue(tasks, priority);
+    }
+
+    void ImageFetcher::enableDiskCache(const std::string& directory, std::uint64_t maxBytes) {
+        cache = std::make_unique<DiskCache>(directory, maxBytes);
+    }
+
+    void ImageFetcher::setVerifyTls(bool enabled) {
+        sessions.setVerifyTls(enabled);
+        multi.setVerifyTls(enabled);
+    }
+
+    CancelToken ImageFetcher::fetchOne(const std::string& url, const OneImageCallback& callback,
+                                       Priority priority, CancelToken token) {
+        if (!token.valid()) token = CancelToken::create();
+        std::vector<Task> tasks;
+        tasks.push_back(Task{url, callback, token, priority});
+        enqueue(tasks, priority);
+        return token;
+    }
+
+    CancelToken ImageFetcher::fetchEach(std::span<const std::string> urls, const EachImageCallback& callback,
+                                        Priority priority, CancelToken token) {
+        if (!token.valid()) token = CancelToken::create();
+
+        std::vector<Task> tasks;
+        tasks.reserve(urls.size());
+        for (std::size_t i = 0; i < urls.size(); ++i) {
+            tasks.push_back(Task{urls[i], [callback, i](bool success, RawImage image) {
+                callback(i, success, std::move(image));
+            }, token, priority});
+        }
+        enqueue(tasks, priority);
+        return token;
+    }
+
+    void ImageFetcher::enqueue(std::vector<Task>& tasks, Priority priority) {
+        if (tasks.empty()) return;
+
+        auto index = static_cast<std::size_t>(priority);
+        std::size_t pushed = 0;
+        auto spill = [&]() {
+            for (auto it = tasks.begin() + pushed; it != tasks.end(); ++it) {
+                backlog[index].push_back(std::move(*it));
+            }
+            backlogCount += tasks.size() - pushed;
+        };
+        if (backlogCount == 0) {
+            pushed = taskQueues[index].tryPushBulk(std::span<Task>(tasks));
+            if (pushed < tasks.size()) {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                spill();
+            }
+        } else {
+            // While older tasks of the class wait in the backlog, new ones queue behind them
             std::lock_guard<std::mutex> lock(queueMutex);
-            taskQueue.push(Task{url, callback});
+            if (backlog[index].empty()) pushed = taskQueues[index].tryPushBulk(std::span<Task>(tasks));
+            spill();
+        }
+
+        // One wakeup per batch rather than per task
+        if (currentEngine == Engine::Multiplexed) {
+            multi.wakeup();
+        } else if (tasks.size() == 1) {
+            workersIdle.notifyOne();
+        } else {
+            workersIdle.notifyAll();
         }
-        queueCond.notify_one();
     }
     
-    void ImageFetcher::fetchMany(int count, const std::string& url, const ManyImageCallback& callback){
-        struct Batch {
-            int remaining;
+    Async<ImageFetcher::FetchResult> ImageFetcher::fetch(std::string url, Priority priority, CancelToken token, Executor* executor) {
+        struct Awaiter {
+            ImageFetcher& fetcher;
             std::string url;
-            std::vector<RawImage> results;
-            ManyImageCallback callback;
-            std::mutex mutex;
+            Priority priority;
+            CancelToken token;
+            Executor* executor;
+            FetchResult result;
+
+            bool await_ready() const noexcept { return false; }
+
+            void await_suspend(std::coroutine_handle<> handle) {
+                // The callback may run before fetchOne returns; nothing here is touched after that
+                fetcher.fetchOne(url, [this, handle](bool success, RawImage data) {
+                    result = FetchResult{success, std::move(data)};
+                    if (executor) {
+                        executor->post([handle]() { handle.resume(); });
+                    } else {
+                        handle.resume();
+                    }
+                }, priority, token);
+            }
+
+            FetchResult await_resume() { return std::move(result); }
         };
 
-        auto batch = std::make_shared<Batch>();
-        batch->remaining = count;
-        batch->url = url;
-        batch->callback = callback;
+        // A named awaiter: GCC mishandles the lifetime of temporaries with non-trivial members in co_await
+        Awaiter awaiter{*this, std::move(url), priority, std::move(token), executor, {}};
+        co_return co_await awaiter;
+    }
+
+    CancelToken ImageFetcher::fetchMany(int count, const std::string& url, const ManyImageCallback& callback,
+                                        Priority priority, CancelToken token){
+        return fetchManyFromUrls(std::vector<std::string>(std::max(count, 0), url), callback, priority, std::move(token));
+    }
+    
+    CancelToken ImageFetcher::fetchManyFromUrls(const std::vector<std::string>& urls, const ManyImageCallback& callback,
+                                                Priority priority, CancelToken token){
+        if (urls.empty()) {
+            callback(false, {});
+            return token.valid() ? token : CancelToken::create();
+        }
 
-        auto oneDone = [batch](bool success, const RawImage& data) {
-            {
-                std::lock_guard<std::mutex> lock(batch->mutex);
-                if (success) {
-                    batch->results.push_back(data);
+        // Have connections ready for the workers that are about to pick these up
+        if (currentEngine == Engine::ThreadPool) {
+            warmUp(urls.front(), std::min(urls.size(), workerCount()), priority);
+        }
+
+        // Each callback fills its own slot; whoever finishes last hands over the batch in url order
+        struct Join {
+            std::vector<FetchResult> results;
+            std::atomic<std::size_t> remaining;
+        };
+        auto join = std::make_shared<Join>();
+        join->results.resize(urls.size());
+        join->remaining = urls.size();
+
+        return fetchEach(urls, [join, callback](std::size_t index, bool success, RawImage image) {
+            join->results[index] = FetchResult{success, std::move(image)};
+            if (join->remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+            std::vector<RawImage> images;
+            for (auto& result : join->results) {
+                if (result.success) images.push_back(std::move(result.data));
+            }
+            bool any = !images.empty();
+            callback(any, std::move(images));
+        }, priority, std::move(token));
+    }
+
+    CancelToken ImageFetcher::fetchStream(const std::vector<std::string>& urls, const StreamOptions& options,
+                                          const BatchItemsCallback& onItems, const BatchDoneCallback& onDone,
+                                          CancelToken token) {
+        if (currentEngine == Engine::ThreadPool && !urls.empty()) {
+            warmUp(urls.front(), std::min({urls.size(), options.window, workerCount()}), options.priority);
+        }
+
+        if (!token.valid()) token = CancelToken::create();
+        auto stream = std::make_shared<BatchStream>(*this, urls, options, onItems, onDone, token);
+        stream->start();
+        return token;
+    }
+
+    CancelToken ImageFetcher::fetchStream(int count, const std::string& url, const StreamOptions& options,
+                                          const BatchItemsCallback& onItems, const BatchDoneCallback& onDone,
+                                          CancelToken token) {
+        return fetchStream(std::vector<std::string>(std::max(count, 0), url), options, onItems, onDone, std::move(token));
+    }
+
+    void ImageFetcher::workerLoop(std::stop_token stopToken) {
+        while (running && !stopToken.stop_requested()) {
+            promoteDue(Clock::now());
+
+            Task task;
+            if (currentEngine != Engine::ThreadPool || !claimNetworkSlot()) {
+                waitForWork(stopToken);
+                continue;
+            }
+            if (!popTask(task)) {
+                // No wakeup needed: this worker re-checks for work itself before it sleeps
+                --networkInFlight;
+                waitForWork(stopToken);
+                continue;
+            }
+
+            if (task.token.cancelled()) {
+                releaseNetworkSlot();
+                drop(task);
+                continue;
+            }
+            if (task.warmUp) {
+                // Paced like a request, but nothing to replay: offline it just completes
+                if (currentCacheMode == CacheMode::Replay) {
+                    drop(task);
+                } else if (!deferForRate(task)) {
+                    openConnection(task);
                 }
-                batch->remaining--;
+                releaseNetworkSlot();
+                continue;
+            }
+            if (replayFromCache(task) || deferForRate(task)) {
+                releaseNetworkSlot();
+                continue;
             }
 
-            if (batch->remaining == 0) {
-                bool any = !batch->results.empty();
-                batch->callback(any, batch->results);
+            // Stream the body into pooled storage instead of cpr's response string, which would need a copy
+            auto body = std::make_shared<std::vector<unsigned char>>(buffers->acquire());
+            auto session = sessions.acquire(task.url);
+            CURL* handle = session->GetCurlHolder()->handle;
+            session->SetUrl(cpr::Url{task.url});
+            session->SetWriteCallback(cpr::WriteCallback{[body, handle, sized = false](const auto& data, intptr_t) mutable {
+                if (!sized) {
+                    sized = true;
+                    curl_off_t contentLength = -1;
+                    if (curl_easy_getinfo(handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &contentLength) == CURLE_OK && contentLength > 0) {
+                        body->reserve(static_cast<std::size_t>(contentLength));
+                    }
+                }
+                body->insert(body->end(), data.begin(), data.end());
+                return true;
+            }});
+            // Returning false from the progress callback aborts the transfer once the request is cancelled
+            // or the fetcher shuts down; libcurl calls it about once a second even while a transfer stalls
+            session->SetProgressCallback(cpr::ProgressCallback{[this, token = task.token](auto&&...) {
+                return running && !token.cancelled();
+            }});
+            task.started = Clock::now();
+            auto response = session->Get();
+            curl_off_t retryAfter = 0;
+            curl_easy_getinfo(handle, CURLINFO_RETRY_AFTER, &retryAfter);
+            // A transport error or a body cut short counts as no response, which is retried, never cached
+            long status = response.status_code;
+            curl_off_t contentLength = -1;
+            curl_easy_getinfo(handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &contentLength);
+            if (response.error || (contentLength > 0 && body->size() < static_cast<std::size_t>(contentLength))) {
+                status = 0;
+            }
+            releaseNetworkSlot();
+            complete(task, status, std::move(*body), std::chrono::seconds(retryAfter));
+        }
+    }
+
+    void ImageFetcher::multiplexLoop(std::stop_token stopToken) {
+        while (running && !stopToken.stop_requested()) {
+            // Top up the in-flight window from the shared queue
+            // Cancelled tasks are dropped here without taking a slot of the window
+            std::vector<Task> admitted;
+            std::vector<Task> dropped;
+            int pollTimeoutMs = kMultiplexPollTimeoutMs;
+            if (currentEngine == Engine::Multiplexed) {
+                auto now = Clock::now();
+                promoteDue(now);
+
+                std::size_t limit = inFlightLimit;
+                if (adaptiveEnabled) limit = std::min(limit, controller.limit());
+
+                Task task;
+                while (multi.inFlight() + admitted.size() < limit && popTask(task)) {
+                    (task.token.cancelled() ? dropped : admitted).push_back(std::move(task));
+                }
+
+                if (delayedCount > 0) {
+                    std::lock_guard<std::mutex> lock(queueMutex);
+                    if (!delayed.empty()) {
+                        auto untilDue = std::chrono::duration_cast<std::chrono::milliseconds>(delayed.front().notBefore - now);
+                        pollTimeoutMs = static_cast<int>(std::clamp<long long>(untilDue.count() + 1, 0, kMultiplexPollTimeoutMs));
+                    }
+                }
+            }
+
+            for (const Task& task : dropped) drop(task);
+
+            for (Task& task : admitted) {
+                // Pooled sessions are the thread pool's; curl multi keeps its own connections
+                if (task.warmUp) {
+                    drop(task);
+                    continue;
+                }
+                if (replayFromCache(task) || deferForRate(task)) continue;
+
+                std::string url = task.url;
+                CancelToken token = task.token;
+                task.started = Clock::now();
+                ++networkInFlight;
+                multi.add(url, [this, task = std::move(task)](long status, std::vector<unsigned char>&& body, long retryAfter) {
+                    --networkInFlight;
+                    complete(task, status, std::move(body), std::chrono::seconds(retryAfter));
+                }, [token]() { return token.cancelled(); });
             }
-        };
 
-        for (int i = 0; i < count; ++i) {
-            fetchOne(url, oneDone);
+            multi.poll(pollTimeoutMs);
         }
+
+        // Transfers still on the wire are reported as cancelled rather than dropped
+        multi.abortAll();
     }
-    
-    void ImageFetcher::fetchManyFromUrls(const std::vector<std::string>& urls, const ManyImageCallback& callback){
-        struct Batch{
-            int remaining;
-            std::vector<RawImage> results;
-            ManyImageCallback callback;
-            std::mutex mutex;
-        };
 
-        auto batch = std::make_shared<Batch>();
-        batch->remaining = urls.size();
-        batch->callback = callback;
+    bool ImageFetcher::popTask(Task& task) {
+        for (std::size_t i = 0; i < kPriorityCount; ++i) {
+            // Retries first: they have waited already
+            if (promotedCount > 0) {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                if (!promoted[i].empty()) {
+                    task = std::move(promoted[i].front());
+                    promoted[i].pop_front();
+                    --promotedCount;
+                    return true;
+                }
+            }
+            // The ring holds a class's oldest submissions, the backlog the ones that did not fit behind them
+            if (taskQueues[i].tryPop(task)) {
+                if (backlogCount > 0) refillFromBacklog(i);
+                return true;
+            }
+            if (backlogCount > 0) {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                if (!backlog[i].empty()) {
+                    task = std::move(backlog[i].front());
+                    backlog[i].pop_front();
+                    --backlogCount;
+                    refillFromBacklogLocked(i);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
 
-        auto oneDone = [batch](bool success, const RawImage& data){
-            std::lock_guard<std::mutex> lock(batch->mutex);
-            if(success){
-                batch->results.push_back(data);
+    void ImageFetcher::refillFromBacklog(std::size_t index) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        refillFromBacklogLocked(index);
+    }
+
+    void ImageFetcher::refillFromBacklogLocked(std::size_t index) {
+        auto& pending = backlog[index];
+        while (!pending.empty() && taskQueues[index].tryPush(std::move(pending.front()))) {
+            pending.pop_front();
+            --backlogCount;
+        }
+    }
+
+    bool ImageFetcher::hasTask() const {
+        return backlogCount > 0 || promotedCount > 0 ||
+               std::any_of(taskQueues.begin(), taskQueues.end(), [](const auto& queue) { return !queue.emptyApprox(); });
+    }
+
+    void ImageFetcher::waitForWork(std::stop_token stopToken) {
+        auto key = workersIdle.prepare();
+        if (!running || stopToken.stop_requested() ||
+            (currentEngine == Engine::ThreadPool && hasTask() && networkSlotFree())) {
+            workersIdle.cancel();
+            return;
+        }
+
+        // Nothing signals when a delayed task falls due, so wake up for the earliest one
+        std::optional<Clock::time_point> due;
+        if (delayedCount > 0 && currentEngine == Engine::ThreadPool) {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (!delayed.empty()) due = delayed.front().notBefore;
+        }
+
+        if (due) {
+            workersIdle.parkUntil(key, *due);
+        } else {
+            workersIdle.park(key);
+        }
+    }
+
+    void ImageFetcher::promoteDue(Clock::time_point now) {
+        if (delayedCount == 0) return;
+        std::lock_guard<std::mutex> lock(queueMutex);
+        promoteDueLocked(now);
+    }
+
+    void ImageFetcher::promoteDueLocked(Clock::time_point now) {
+        auto later = [](const Task& a, const Task& b) { return a.notBefore > b.notBefore; };
+
+        // Cancelled tasks need not wait out their delay; they are dropped as soon as they are popped
+        if (std::any_of(delayed.begin(), delayed.end(), [](const Task& task) { return task.token.cancelled(); })) {
+            for (auto it = delayed.begin(); it != delayed.end();) {
+                if (it->token.cancelled()) {
+                    promoted[static_cast<std::size_t>(it->priority)].push_front(std::move(*it));
+                    ++promotedCount;
+                    it = delayed.erase(it);
+                } else {
+                    ++it;
+                }
             }
-            batch->remaining--;
+            std::make_heap(delayed.begin(), delayed.end(), later);
+        }
 
-            if(batch->remaining == 0){
-                bool anySuccess = !batch->results.empty();
-                batch->callback(anySuccess, std::move(batch->results));
+        while (!delayed.empty() && delayed.front().notBefore <= now) {
+            std::pop_heap(delayed.begin(), delayed.end(), later);
+            Task& task = delayed.back();
+            // Retries go ahead of their class: they have waited already
+            promoted[static_cast<std::size_t>(task.priority)].push_back(std::move(task));
+            ++promotedCount;
+            delayed.pop_back();
+        }
+        delayedCount = delayed.size();
+    }
+
+    void ImageFetcher::defer(Task task, Clock::duration delay) {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            task.notBefore = Clock::now() + delay;
+            delayed.push_back(std::move(task));
+            std::push_heap(delayed.begin(), delayed.end(), [](const Task& a, const Task& b) { return a.notBefore > b.notBefore; });
+            delayedCount = delayed.size();
+        }
+        // Sleepers recompute their deadline
+        workersIdle.notifyAll();
+        multi.wakeup();
+    }
+
+    bool ImageFetcher::deferForRate(Task& task) {
+        auto wait = limiter.acquire(SessionPool::hostOf(task.url), Clock::now());
+        if (wait <= Clock::duration::zero()) return false;
+
+        defer(std::move(task), wait);
+        return true;
+    }
+
+    bool ImageFetcher::networkSlotFree() const {
+        return !adaptiveEnabled || networkInFlight < controller.limit();
+    }
+
+    bool ImageFetcher::claimNetworkSlot() {
+        if (!adaptiveEnabled) {
+            ++networkInFlight;
+            return true;
+        }
+
+        std::size_t limit = controller.limit();
+        std::size_t current = networkInFlight.load();
+        while (current < limit) {
+            if (networkInFlight.compare_exchange_weak(current, current + 1)) return true;
+        }
+        return false;
+    }
+
+    void ImageFetcher::releaseNetworkSlot() {
+        --networkInFlight;
+        workersIdle.notifyOne();
+    }
+
+    void ImageFetcher::drop(const Task& task) {
+        std::string errorMessage = kCancelledMessage;
+        task.callback(false, RawImage(errorMessage.cbegin(), errorMessage.cend()));
+    }
+
+    void ImageFetcher::openConnection(const Task& task) {
+        // A HEAD request performs DNS + TCP + TLS and leaves the connection open
+        auto lease = sessions.open(task.url);
+        lease->SetUrl(cpr::Url{task.url});
+        lease->SetProgressCallback(cpr::ProgressCallback{[this, token = task.token](auto&&...) {
+            return running && !token.cancelled();
+        }});
+        auto response = lease->Head();
+        curl_off_t retryAfter = 0;
+        curl_easy_getinfo(lease->GetCurlHolder()->handle, CURLINFO_RETRY_AFTER, &retryAfter);
+
+        // Only a throttling answer says something about the provider; a warm-up is never retried
+        long status = response.error ? 0 : response.status_code;
+        if (RetryPolicy::retryable(status)) {
+            ++throttledCount;
+            controller.onThrottled();
+            if (retryAfter > 0) {
+                limiter.pauseUntil(SessionPool::hostOf(task.url), Clock::now() + std::chrono::seconds(retryAfter));
             }
-        };
-        for(const auto& url: urls){
-            fetchOne(url, oneDone);
         }
+        task.callback(!response.error, RawImage());
     }
 
-    void ImageFetcher::workerLoop() {
-        while (running) {
-            Task task;
-            {
-                std::unique_lock<std::mutex> lock(queueMutex);
-                queueCond.wait(lock, [this]() { return !taskQueue.empty() || !running; });
+    void ImageFetcher::complete(const Task& task, long status, std::vector<unsigned char>&& body, std::chrono::seconds retryAfter) {
+        // Shutting down: nothing would run a retry
+        if (task.token.cancelled() || !running) {
+            buffers->recycle(std::move(body));
+            drop(task);
+            return;
+        }
 
-                if (!running && taskQueue.empty()) return;
+        if (status == 200) {
+            controller.onSuccess(std::chrono::duration<double, std::milli>(Clock::now() - task.started).count());
+        } else if (RetryPolicy::retryable(status)) {
+            ++throttledCount;
+            controller.onThrottled();
+            if (retryAfter.count() > 0) {
+                limiter.pauseUntil(SessionPool::hostOf(task.url), Clock::now() + retryAfter);
+            }
 
-                task = std::move(taskQueue.front());
-                taskQueue.pop();
+            if (task.attempt + 1 < retryPolicy.maxAttempts()) {
+                buffers->recycle(std::move(body));
+                Task retry = task;
+                ++retry.attempt;
+                ++retryCount;
+                auto delay = retryPolicy.delay(retry.attempt, retryAfter);
+                defer(std::move(retry), delay);
+                return;
             }
+        }
 
-            auto response = cpr::Get(cpr::Url{task.url});
-            if (response.status_code == 200) {
-                task.callback(true, RawImage(response.text.cbegin(), response.text.cend()));
-            } else {
-                std::string errorMessage =  "HTTP error code: " + std::to_string(response.status_code);
-                task.callback(false, RawImage(errorMessage.cbegin(), errorMessage.cend()));
+        if (status == 200) {
+            RawImage image = buffers->seal(std::move(body));
+            if (cache && currentCacheMode == CacheMode::WriteThrough) {
+                cache->put(image);
             }
+            task.callback(true, std::move(image));
+        } else {
+            buffers->recycle(std::move(body));
+            std::string errorMessage =  "HTTP error code: " + std::to_string(status);
+            task.callback(false, RawImage(errorMessage.cbegin(), errorMessage.cend()));
+        }
+    }
+
+    bool ImageFetcher::replayFromCache(const Task& task) {
+        if (currentCacheMode != CacheMode::Replay) return false;
+
+        auto cached = cache ? cache->replayNext() : std::nullopt;
+        if (cached) {
+            task.callback(true, std::move(*cached));
+        } else {
+            std::string errorMessage = "Disk cache is empty";
+            task.callback(false, RawImage(errorMessage.cbegin(), errorMessage.cend()));
         }
+        return true;
     }
 
-}
\ No newline at end of file
+}
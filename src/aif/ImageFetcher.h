@@ -5,44 +5,263 @@
 #include <thread>
 #include <functional>
 #include <vector>
-#include <queue>
+#include <deque>
+#include <array>
 #include <mutex>
-#include <condition_variable>
 #include <atomic>
+#include <stop_token>
+#include <memory>
+#include <cstdint>
+#include <chrono>
+#include <span>
+
+#include "CurlMulti.h"
+#include "SessionPool.h"
+#include "ByteBuffer.h"
+#include "DiskCache.h"
+#include "BatchStream.h"
+#include "Request.h"
+#include "FlowControl.h"
+#include "Async.h"
+#include "Executor.h"
+#include "MpmcQueue.h"
+#include "Parker.h"
 
 namespace aif{
     
 class ImageFetcher {
     public:
-        using RawImage = std::vector<unsigned char>;
+        using RawImage = ByteBuffer;
         using OneImageCallback = std::function<void(bool, RawImage)>;
         using ManyImageCallback = std::function<void(bool, std::vector<RawImage>)>;
+        using EachImageCallback = std::function<void(std::size_t index, bool, RawImage)>;
+
+        // ThreadPool: every worker runs one blocking transfer at a time.
+        // Multiplexed: a single event-loop thread drives many transfers through curl multi.
+        enum class Engine { ThreadPool, Multiplexed };
+
+        // WriteThrough: fetch over the network and store every payload in the disk cache.
+        // Replay: serve every request from the disk cache without touching the network.
+        enum class CacheMode { Off, WriteThrough, Replay };
+
+        static constexpr std::size_t kDefaultWorkerCount = 8;
+        static constexpr std::size_t kDefaultMaxInFlight = 100;
+        static constexpr std::size_t kInitialAdaptiveConcurrency = 4;
+        // Per priority class; submissions beyond it spill into a locked backlog
+        static constexpr std::size_t kTaskQueueCapacity = 4096;
+
+        struct FetchResult {
+            bool success = false;
+            RawImage data; // the payload, or the error message when !success
+        };
+
+        struct FlowStats {
+            std::size_t concurrencyLimit; // what the adaptive controller currently allows
+            std::size_t inFlight;         // transfers on the wire
+            std::size_t delayed;          // waiting for a retry or a rate-limit token
+            std::size_t throttled;        // 429/503 responses and transport errors seen
+            std::size_t retries;
+            double latencyMs;             // smoothed time on the wire
+        };
     
-        explicit ImageFetcher();
+        // Starts `workerCount` worker threads that drain the shared task queue (at least one).
+        explicit ImageFetcher(std::size_t workerCount = kDefaultWorkerCount, Engine engine = Engine::ThreadPool);
         ~ImageFetcher();
+
+        // Stops and joins the workers and the multiplexer. Transfers in flight report back (cancelled)
+        // before it returns; queued requests are never started. Call before whatever the callbacks refer
+        // to goes away. The destructor calls it too.
+        void shutdown();
     
         // Fetchs an image from `url` asynchronously and invokes the callback when the image is ready.
-        void fetchOne(const std::string& url, const OneImageCallback& callback);
+        // Returns `token` (or a new token when none is given); cancelling it drops the request if it has not
+        // started and aborts the transfer if it has. A cancelled request still gets its callback, with false.
+        CancelToken fetchOne(const std::string& url, const OneImageCallback& callback,
+                             Priority priority = Priority::Normal, CancelToken token = {});
 
         
+        // Queues every url in one bulk operation and invokes `callback` once per image, with the url's index.
+        // The returned token cancels the whole batch.
+        CancelToken fetchEach(std::span<const std::string> urls, const EachImageCallback& callback,
+                              Priority priority = Priority::Normal, CancelToken token = {});
+
         // Fetchs `count` images from same `url` asynchronously and invokes the callback when all `n`images are ready.
-        void fetchMany(int count, const std::string& url, const ManyImageCallback& callback);
+        // The returned token cancels the whole batch. Built on fetchEach(), which queues the whole batch in
+        // one bulk push; coroutines that want the same join can co_await whenAll() over fetch() instead.
+        CancelToken fetchMany(int count, const std::string& url, const ManyImageCallback& callback,
+                              Priority priority = Priority::Normal, CancelToken token = {});
         
 
-        void fetchManyFromUrls(const std::vector<std::string>& urls, const ManyImageCallback& callback);
+        CancelToken fetchManyFromUrls(const std::vector<std::string>& urls, const ManyImageCallback& callback,
+                                      Priority priority = Priority::Normal, CancelToken token = {});
+
+        // Awaitable fetch: `auto result = co_await fetcher.fetch(url);`. The request is queued when awaited.
+        // The coroutine resumes on `executor` when given, otherwise on the fetch thread that finished the
+        // transfer, which for the multiplexed engine is its event loop: keep that continuation short.
+        Async<FetchResult> fetch(std::string url, Priority priority = Priority::Normal, CancelToken token = {},
+                                 Executor* executor = nullptr);
+
+        // Streams a batch: `onItems` receives images (in groups of `options.deliverEvery`) as they arrive,
+        // and at most `options.window` requests are outstanding until their items' credits are released.
+        // `onDone` follows the last delivery with the per-item outcome.
+        // Cancelling the returned token stops issuing requests; the skipped ones are reported as failed.
+        CancelToken fetchStream(const std::vector<std::string>& urls, const StreamOptions& options,
+                                const BatchItemsCallback& onItems, const BatchDoneCallback& onDone,
+                                CancelToken token = {});
+
+        CancelToken fetchStream(int count, const std::string& url, const StreamOptions& options,
+                                const BatchItemsCallback& onItems, const BatchDoneCallback& onDone,
+                                CancelToken token = {});
+
+        // Grows or shrinks the worker pool at runtime. Retiring workers finish their current download first,
+        // without the caller waiting for them.
+        void setWorkerCount(std::size_t count);
+
+        std::size_t workerCount() const;
+
+        // Selects which engine drains the task queue. Transfers already running finish on their engine.
+        void setEngine(Engine engine);
+
+        Engine engine() const { return currentEngine; }
+
+        // Caps the transfers the multiplexed engine keeps in flight at once.
+        void setMaxInFlight(std::size_t count);
+
+        std::size_t maxInFlight() const { return inFlightLimit; }
+
+        // Opens keep-alive connections to the host of `url` ahead of a batch, until `connections` are idle.
+        // Each is a HEAD request on a new session, queued at `priority` and run by the thread pool like
+        // any other request, so it takes a worker slot and a rate-limit token and throttling responses
+        // feed the adaptive limit. The multiplexed engine keeps its own connections and skips them.
+        void warmUp(const std::string& url, std::size_t connections, Priority priority = Priority::Normal);
+
+        // Reuses pooled sessions (keep-alive connections) across requests. Disable to measure the difference.
+        void setSessionReuse(bool enabled) { sessions.setReuse(enabled); }
+
+        bool sessionReuse() const { return sessions.reuseEnabled(); }
+
+        // Turns certificate verification off, for local stand-in servers with self-signed certificates only.
+        void setVerifyTls(bool enabled);
+
+        // Lets an AIMD controller choose how many transfers run at once, up to the worker count
+        // (thread pool) or the in-flight cap (multiplexed), backing off when the provider throttles.
+        void setAdaptive(bool enabled);
+
+        bool adaptive() const { return adaptiveEnabled; }
+
+        // Caps requests per second to each host (0 = unlimited), allowing bursts of `burst` requests.
+        void setRateLimit(double perSecond, double burst = 1.0);
+
+        double rateLimit() const { return limiter.rate(); }
+
+        // Throttled (429/503), gateway and transport failures are retried with jittered exponential
+        // backoff, or after the server's Retry-After. `maxAttempts` includes the first try; 1 disables retries.
+        void setRetryPolicy(int maxAttempts, std::chrono::milliseconds baseDelay, std::chrono::milliseconds maxDelay);
+
+        FlowStats flowStats() const;
+
+        // Attaches an on-disk cache bounded to `maxBytes`. Call before the first fetch.
+        void enableDiskCache(const std::string& directory, std::uint64_t maxBytes);
+
+        void setCacheMode(CacheMode mode) { currentCacheMode = mode; }
+
+        CacheMode cacheMode() const { return currentCacheMode; }
+
+        // nullptr until enableDiskCache() is called.
+        DiskCache* diskCache() const { return cache.get(); }
+
+        // Storage recycled between response bodies; released buffers come back here.
+        const BufferPool& bufferPool() const { return *buffers; }
     private:
-        void workerLoop();
+        void workerLoop(std::stop_token stopToken);
+        void multiplexLoop(std::stop_token stopToken);
     
         struct Task {
             std::string url;
             OneImageCallback callback;
+            CancelToken token;
+            Priority priority = Priority::Normal;
+            int attempt = 0;
+            Clock::time_point notBefore{}; // while delayed
+            Clock::time_point started{};   // when the transfer went on the wire
+            bool warmUp = false;           // opens a pooled connection instead of fetching; `callback` gets no payload
         };
+
+        // Queues tasks of one priority class with a single bulk push and wakes the engine once.
+        void enqueue(std::vector<Task>& tasks, Priority priority);
+        // Takes the next task from the highest non-empty priority class: its due retries, then its
+        // submissions in the order they were queued.
+        bool popTask(Task& task);
+        // Moves the oldest backlog tasks of a class into its ring, as far as they fit.
+        void refillFromBacklog(std::size_t index);
+        void refillFromBacklogLocked(std::size_t index);
+        bool hasTask() const;
+        // Sleeps until a task, a free slot, an engine change or the earliest delayed task is due.
+        void waitForWork(std::stop_token stopToken);
+        // Moves delayed tasks that are due (or cancelled) to their class's promoted queue.
+        void promoteDue(Clock::time_point now);
+        void promoteDueLocked(Clock::time_point now);
+        // Parks `task` for `delay` before it becomes eligible again.
+        void defer(Task task, Clock::duration delay);
+        // Defers the task when its host has no rate-limit token left. Returns true if it was deferred.
+        bool deferForRate(Task& task);
+        // Whether the thread pool may start another transfer under the adaptive limit.
+        bool networkSlotFree() const;
+        // Takes a slot if one is free, without a lock, so concurrent workers cannot overshoot the limit.
+        bool claimNetworkSlot();
+        void releaseNetworkSlot();
+        void updateConcurrencyCap();
+        // Reports a cancelled task to its callback without touching the network.
+        static void drop(const Task& task);
+        // Runs a warm-up task on the calling worker: a HEAD request on a new session, which is then pooled.
+        void openConnection(const Task& task);
+
+        // Runs the task's callback for a finished transfer and feeds the disk cache.
+        void complete(const Task& task, long status, std::vector<unsigned char>&& body, std::chrono::seconds retryAfter);
+        // Serves the task from the disk cache when replaying. Returns false if the task still needs the network.
+        bool replayFromCache(const Task& task);
     
-        std::queue<Task> taskQueue;
-        std::mutex queueMutex;
-        std::condition_variable queueCond;
-        std::thread worker;
+        // Fresh submissions, indexed by Priority. Workers only touch queueMutex for the backlog and delays.
+        std::array<MpmcQueue<Task>, kPriorityCount> taskQueues;
+        Parker workersIdle;
+        // Submissions that did not fit taskQueues, or came while older ones of their class were here
+        std::array<std::deque<Task>, kPriorityCount> backlog;
+        // Retries and cancelled tasks whose delay is over; they go ahead of their class
+        std::array<std::deque<Task>, kPriorityCount> promoted;
+        std::vector<Task> delayed; // min-heap on notBefore
+        std::atomic<std::size_t> backlogCount{0};
+        std::atomic<std::size_t> promotedCount{0};
+        std::atomic<std::size_t> delayedCount{0};
+        mutable std::mutex queueMutex;
         std::atomic<bool> running;
+        std::atomic<Engine> currentEngine;
+        std::atomic<std::size_t> inFlightLimit;
+        std::atomic<CacheMode> currentCacheMode;
+
+        std::atomic<bool> adaptiveEnabled{false};
+        std::atomic<std::size_t> networkInFlight{0};
+        std::atomic<std::size_t> throttledCount{0};
+        std::atomic<std::size_t> retryCount{0};
+        AimdController controller;
+        RateLimiter limiter;
+        RetryPolicy retryPolicy;
+
+        std::unique_ptr<DiskCache> cache;
+        std::shared_ptr<BufferPool> buffers;
+
+        SessionPool sessions;
+        CurlMulti multi;
+        std::jthread multiplexer;
+
+        struct Worker {
+            std::jthread thread;
+            std::shared_ptr<std::atomic<bool>> exited; // set once workerLoop has returned
+        };
+
+        mutable std::mutex workersMutex;
+        std::vector<Worker> workers;
+        // Stopped workers still finishing a download; reaped once they have exited, so a resize never waits on them
+        std::vector<Worker> retiredWorkers;
     };
 }
 
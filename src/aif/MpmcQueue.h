@@ -0,0 +1,132 @@
+#ifndef AMF_MPMC_QUEUE_H
+#define AMF_MPMC_QUEUE_H
+
+#include <atomic>
+#include <memory>
+#include <span>
+#include <cstddef>
+#include <cstdint>
+
+namespace aif{
+
+// Bounded lock-free multi-producer/multi-consumer queue (Vyukov's ring of sequenced cells).
+// Producers and consumers each claim a position with one CAS and never block each other;
+// a full queue makes tryPush fail instead of waiting. T must be default-constructible and movable.
+template<typename T>
+class MpmcQueue {
+    public:
+        static constexpr std::size_t kDefaultCapacity = 1024;
+
+        // `capacity` is rounded up to a power of two.
+        explicit MpmcQueue(std::size_t capacity = kDefaultCapacity) {
+            std::size_t size = 2;
+            while (size < capacity) size <<= 1;
+            mask = size - 1;
+            cells.reset(new Cell[size]);
+            for (std::size_t i = 0; i < size; ++i) {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MpmcQueue(const MpmcQueue&) = delete;
+        MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+        bool tryPush(T&& value) {
+            std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+            Cell* cell;
+            while (true) {
+                cell = &cells[pos & mask];
+                std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+                if (diff == 0) {
+                    if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                } else if (diff < 0) {
+                    return false; // full: the cell still holds last lap's value
+                } else {
+                    pos = enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+            cell->value = std::move(value);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Claims a run of consecutive cells with a single CAS and moves in as many of `values` as fit.
+        // Returns how many were pushed: always a prefix of `values`.
+        std::size_t tryPushBulk(std::span<T> values) {
+            if (values.empty()) return 0;
+
+            std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+            std::size_t count;
+            while (true) {
+                // Cells only become free behind consumers, so a run seen free stays free until enqueuePos moves
+                count = 0;
+                while (count < values.size() && count <= mask &&
+                       cells[(pos + count) & mask].sequence.load(std::memory_order_acquire) == pos + count) {
+                    ++count;
+                }
+
+                if (count == 0) {
+                    auto sequence = cells[pos & mask].sequence.load(std::memory_order_acquire);
+                    if (static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos) < 0) return 0;
+                    pos = enqueuePos.load(std::memory_order_relaxed);
+                    continue;
+                }
+                if (enqueuePos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) break;
+            }
+
+            for (std::size_t i = 0; i < count; ++i) {
+                Cell& cell = cells[(pos + i) & mask];
+                cell.value = std::move(values[i]);
+                cell.sequence.store(pos + i + 1, std::memory_order_release);
+            }
+            return count;
+        }
+
+        bool tryPop(T& value) {
+            std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+            Cell* cell;
+            while (true) {
+                cell = &cells[pos & mask];
+                std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos + 1);
+                if (diff == 0) {
+                    if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                } else if (diff < 0) {
+                    return false; // empty
+                } else {
+                    pos = dequeuePos.load(std::memory_order_relaxed);
+                }
+            }
+            value = std::move(cell->value);
+            cell->sequence.store(pos + mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Exact only while nobody pushes or pops concurrently.
+        std::size_t sizeApprox() const {
+            std::size_t tail = enqueuePos.load(std::memory_order_relaxed);
+            std::size_t head = dequeuePos.load(std::memory_order_relaxed);
+            return tail > head ? tail - head : 0;
+        }
+
+        bool emptyApprox() const { return sizeApprox() == 0; }
+
+        std::size_t capacity() const { return mask + 1; }
+    private:
+        static constexpr std::size_t kCacheLine = 64;
+
+        // One cell per cache line so neighbouring producers and consumers do not false-share
+        struct alignas(kCacheLine) Cell {
+            std::atomic<std::size_t> sequence;
+            T value;
+        };
+
+        std::unique_ptr<Cell[]> cells;
+        std::size_t mask = 0;
+        alignas(kCacheLine) std::atomic<std::size_t> enqueuePos{0};
+        alignas(kCacheLine) std::atomic<std::size_t> dequeuePos{0};
+    };
+}
+
+#endif // AMF_MPMC_QUEUE_H
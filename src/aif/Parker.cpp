@@ -0,0 +1,48 @@
+#include "Parker.h"
+
+namespace aif{
+
+    std::uint32_t Parker::prepare() {
+        parked.fetch_add(1, std::memory_order_seq_cst);
+        return epoch.load(std::memory_order_seq_cst);
+    }
+
+    void Parker::cancel() {
+        parked.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void Parker::park(std::uint32_t key) {
+        epoch.wait(key, std::memory_order_seq_cst);
+        parked.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void Parker::parkUntil(std::uint32_t key, std::chrono::steady_clock::time_point deadline) {
+        {
+            std::unique_lock<std::mutex> lock(timedMutex);
+            timedParked.fetch_add(1, std::memory_order_seq_cst);
+            timedCond.wait_until(lock, deadline, [this, key]() { return epoch.load(std::memory_order_seq_cst) != key; });
+            timedParked.fetch_sub(1, std::memory_order_relaxed);
+        }
+        parked.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void Parker::notify(bool all) {
+        // A read-modify-write rather than a load, so it is ordered against prepare() on the same counter:
+        // either we see the sleeper, or its re-check sees the work published before this call
+        if (parked.fetch_add(0, std::memory_order_seq_cst) == 0) return;
+
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        if (all) {
+            epoch.notify_all();
+        } else {
+            epoch.notify_one();
+        }
+
+        if (timedParked.load(std::memory_order_seq_cst) > 0) {
+            // Taking the mutex closes the gap between a timed sleeper's predicate check and its wait
+            std::lock_guard<std::mutex> lock(timedMutex);
+            timedCond.notify_all();
+        }
+    }
+
+}
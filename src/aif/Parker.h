@@ -0,0 +1,46 @@
+#ifndef AMF_PARKER_H
+#define AMF_PARKER_H
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+namespace aif{
+
+// Lets consumers of a lock-free queue sleep without a lock on the producer side (an event count).
+// Waiting is `std::atomic::wait`, a futex on Linux, and notifying costs a single uncontended atomic
+// read-modify-write (a `fetch_add(0)`) while nobody sleeps. Timed waits, which atomics cannot do, fall back to a condition variable.
+//
+//     auto key = parker.prepare();
+//     if (workAvailable()) parker.cancel(); else parker.park(key);
+class Parker {
+    public:
+        // Announces the intent to sleep. Re-check for work afterwards: a notify from then on is not lost.
+        std::uint32_t prepare();
+
+        // Backs out of prepare() when the re-check found work.
+        void cancel();
+
+        // Sleeps until a notify that follows prepare().
+        void park(std::uint32_t key);
+
+        // Like park(), but gives up at `deadline`.
+        void parkUntil(std::uint32_t key, std::chrono::steady_clock::time_point deadline);
+
+        // Call after publishing work.
+        void notifyOne() { notify(false); }
+        void notifyAll() { notify(true); }
+    private:
+        void notify(bool all);
+
+        std::atomic<std::uint32_t> epoch{0};
+        std::atomic<std::uint32_t> parked{0};
+        std::atomic<std::uint32_t> timedParked{0};
+        std::mutex timedMutex;
+        std::condition_variable timedCond;
+    };
+}
+
+#endif // AMF_PARKER_H
@@ -0,0 +1,40 @@
+#ifndef AMF_REQUEST_H
+#define AMF_REQUEST_H
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+
+namespace aif{
+
+// Queued requests are served strictly by class: textures for visible entities go first,
+// speculative prefetching only when nothing else is waiting.
+enum class Priority { Visible, Normal, Prefetch };
+
+constexpr std::size_t kPriorityCount = 3;
+
+// Payload handed to the callbacks of cancelled requests.
+constexpr const char* kCancelledMessage = "Request cancelled";
+
+// Shared cancellation flag. Copies refer to the same flag, so one token can cover a whole batch.
+// A default-constructed token is inert: it can never be cancelled.
+class CancelToken {
+    public:
+        CancelToken() = default;
+
+        static CancelToken create() { return CancelToken(std::make_shared<std::atomic<bool>>(false)); }
+
+        void cancel() const { if (flag) flag->store(true); }
+
+        bool cancelled() const { return flag && flag->load(std::memory_order_relaxed); }
+
+        // False for the inert default token.
+        bool valid() const { return flag != nullptr; }
+    private:
+        explicit CancelToken(std::shared_ptr<std::atomic<bool>> flag) : flag(std::move(flag)) {}
+
+        std::shared_ptr<std::atomic<bool>> flag;
+    };
+}
+
+#endif // AMF_REQUEST_H
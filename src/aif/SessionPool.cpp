@@ -0,0 +1,138 @@
+#include "SessionPool.h"
+#include <cpr/cpr.h>
+#include <algorithm>
+
+namespace aif{
+
+    namespace {
+        // How long resolved addresses stay cached (libcurl default is 60 s)
+        constexpr long kDnsCacheTimeoutSeconds = 300;
+        // A connection that takes longer to open, or a transfer slower than kLowSpeedBytesPerSecond for
+        // kLowSpeedSeconds, fails as a transport error and is retried instead of holding a worker
+        constexpr long kConnectTimeoutSeconds = 10;
+        constexpr long kLowSpeedBytesPerSecond = 1024;
+        constexpr long kLowSpeedSeconds = 15;
+    }
+
+    SessionPool::Lease::Lease(SessionPool* pool, std::string host, std::unique_ptr<cpr::Session> session)
+        : pool(pool), host(std::move(host)), session(std::move(session)) {}
+
+    SessionPool::Lease::Lease(Lease&& other) noexcept
+        : pool(other.pool), host(std::move(other.host)), session(std::move(other.session)) {
+        other.pool = nullptr;
+    }
+
+    SessionPool::Lease::~Lease() {
+        if (pool && session) {
+            pool->release(host, std::move(session));
+        }
+    }
+
+    SessionPool::SessionPool() {
+        curlShare = curl_share_init();
+        curl_share_setopt(curlShare, CURLSHOPT_LOCKFUNC, &SessionPool::lockShare);
+        curl_share_setopt(curlShare, CURLSHOPT_UNLOCKFUNC, &SessionPool::unlockShare);
+        curl_share_setopt(curlShare, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+
+    SessionPool::~SessionPool() {
+        {
+            std::lock_guard<std::mutex> lock(idleMutex);
+            idle.clear();
+        }
+        // Every easy handle using the share is gone by now
+        curl_share_cleanup(curlShare);
+    }
+
+    SessionPool::Lease SessionPool::acquire(const std::string& url) {
+        std::string host = hostOf(url);
+        std::unique_ptr<cpr::Session> session;
+
+        if (reuse) {
+            std::lock_guard<std::mutex> lock(idleMutex);
+            auto it = idle.find(host);
+            if (it != idle.end() && !it->second.empty()) {
+                // Most recently used first: its connection is the least likely to have timed out
+                session = std::move(it->second.back());
+                it->second.pop_back();
+            }
+        }
+
+        if (!session) {
+            session = makeSession();
+        }
+        session->SetVerifySsl(cpr::VerifySsl{verifyTls});
+        return Lease(this, std::move(host), std::move(session));
+    }
+
+    SessionPool::Lease SessionPool::open(const std::string& url) {
+        auto session = makeSession();
+        session->SetVerifySsl(cpr::VerifySsl{verifyTls});
+        return Lease(this, hostOf(url), std::move(session));
+    }
+
+    std::size_t SessionPool::planWarmUp(const std::string& url, std::size_t connections) {
+        if (!reuse) return 0;
+
+        std::string host = hostOf(url);
+        std::lock_guard<std::mutex> lock(idleMutex);
+        std::size_t ready = idle[host].size() + warming[host];
+        std::size_t missing = connections > ready ? connections - ready : 0;
+        warming[host] += missing;
+        return missing;
+    }
+
+    void SessionPool::finishWarmUp(const std::string& url) {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        auto it = warming.find(hostOf(url));
+        if (it != warming.end() && it->second > 0) --it->second;
+    }
+
+    std::size_t SessionPool::idleCount(const std::string& url) {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        auto it = idle.find(hostOf(url));
+        return it != idle.end() ? it->second.size() : 0;
+    }
+
+    std::string SessionPool::hostOf(const std::string& url) {
+        // scheme://host[:port]/path -> scheme://host[:port]
+        auto schemeEnd = url.find("://");
+        auto hostStart = schemeEnd == std::string::npos ? 0 : schemeEnd + 3;
+        auto hostEnd = url.find_first_of("/?#", hostStart);
+        return url.substr(0, hostEnd);
+    }
+
+    std::unique_ptr<cpr::Session> SessionPool::makeSession() {
+        auto session = std::make_unique<cpr::Session>();
+
+        CURL* handle = session->GetCurlHolder()->handle;
+        curl_easy_setopt(handle, CURLOPT_SHARE, curlShare);
+        curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(handle, CURLOPT_DNS_CACHE_TIMEOUT, kDnsCacheTimeoutSeconds);
+        curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, kConnectTimeoutSeconds);
+        curl_easy_setopt(handle, CURLOPT_LOW_SPEED_LIMIT, kLowSpeedBytesPerSecond);
+        curl_easy_setopt(handle, CURLOPT_LOW_SPEED_TIME, kLowSpeedSeconds);
+        return session;
+    }
+
+    void SessionPool::release(const std::string& host, std::unique_ptr<cpr::Session> session) {
+        if (!reuse) return;
+
+        std::lock_guard<std::mutex> lock(idleMutex);
+        auto& sessions = idle[host];
+        if (sessions.size() < kMaxIdlePerHost) {
+            sessions.push_back(std::move(session));
+        }
+    }
+
+    void SessionPool::lockShare(CURL*, curl_lock_data data, curl_lock_access, void* userptr) {
+        static_cast<SessionPool*>(userptr)->shareMutexes[data].lock();
+    }
+
+    void SessionPool::unlockShare(CURL*, curl_lock_data data, void* userptr) {
+        static_cast<SessionPool*>(userptr)->shareMutexes[data].unlock();
+    }
+
+}
@@ -0,0 +1,91 @@
+#ifndef AMF_SESSION_POOL_H
+#define AMF_SESSION_POOL_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+
+#include <curl/curl.h>
+
+namespace cpr { class Session; }
+
+namespace aif{
+
+// Per-host pool of reusable cpr::Session objects.
+// A session keeps its connection alive between requests, and every session shares one
+// DNS cache and TLS session cache, so new connections skip the lookup and resume TLS.
+class SessionPool {
+    public:
+        // Returns its session to the pool when destroyed.
+        class Lease {
+            public:
+                Lease(SessionPool* pool, std::string host, std::unique_ptr<cpr::Session> session);
+                Lease(Lease&&) noexcept;
+                ~Lease();
+
+                cpr::Session& operator*() const { return *session; }
+                cpr::Session* operator->() const { return session.get(); }
+            private:
+                SessionPool* pool;
+                std::string host;
+                std::unique_ptr<cpr::Session> session;
+        };
+
+        static constexpr std::size_t kMaxIdlePerHost = 64;
+
+        SessionPool();
+        ~SessionPool();
+
+        SessionPool(const SessionPool&) = delete;
+        SessionPool& operator=(const SessionPool&) = delete;
+
+        // Hands out an idle session for the host of `url`, or a new one when none is idle.
+        Lease acquire(const std::string& url);
+
+        // Always a new session, e.g. to open one more connection; pooled like any other once released.
+        Lease open(const std::string& url);
+
+        // How many connections to open so that `connections` are idle or being opened for the host of `url`.
+        // They count as being opened until finishWarmUp() is called for each, so warm-ups planned meanwhile
+        // do not open the same ones again. The caller opens them, so they pass through its flow control.
+        std::size_t planWarmUp(const std::string& url, std::size_t connections);
+
+        void finishWarmUp(const std::string& url);
+
+        // Disabling reuse gives every request a fresh session (and connection) for comparison.
+        void setReuse(bool enabled) { reuse = enabled; }
+
+        bool reuseEnabled() const { return reuse; }
+
+        // Turns certificate verification off for local stand-in servers with self-signed certificates.
+        void setVerifyTls(bool enabled) { verifyTls = enabled; }
+
+        // DNS + TLS session share handle; also attached to the multiplexed engine's transfers.
+        CURLSH* share() const { return curlShare; }
+
+        std::size_t idleCount(const std::string& url);
+
+        static std::string hostOf(const std::string& url);
+    private:
+        std::unique_ptr<cpr::Session> makeSession();
+        void release(const std::string& host, std::unique_ptr<cpr::Session> session);
+
+        static void lockShare(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr);
+        static void unlockShare(CURL* handle, curl_lock_data data, void* userptr);
+
+        std::mutex idleMutex;
+        std::unordered_map<std::string, std::vector<std::unique_ptr<cpr::Session>>> idle;
+        std::unordered_map<std::string, std::size_t> warming; // planned connections not opened yet
+
+        CURLSH* curlShare;
+        std::mutex shareMutexes[CURL_LOCK_DATA_LAST];
+
+        std::atomic<bool> reuse{true};
+        std::atomic<bool> verifyTls{true};
+    };
+}
+
+#endif // AMF_SESSION_POOL_H
@@ -2,19 +2,20 @@
 #include <windows.h>
 #include <psapi.h>
 #endif
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
 
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <map>
 #include <filesystem>
 #include <cmath>
 #include <random>
 #include <limits>
 #include <algorithm>
+#include <tuple>
+#include <unordered_set>
 #include <ranges>
 
 #include <chrono>
@@ -22,6 +23,13 @@
 #include <fstream>
 #include <iomanip>
 #include <array>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <optional>
+#include <cstring>
+#include <cstdlib>
 
 
 #include <GL/glew.h>
@@ -37,6 +45,16 @@
 #include <imgui_impl_opengl3.h>
 
 #include "aif/ImageFetcher.h"
+#include "aif/MpmcQueue.h"
+#include "texgan/loading/PixelOps.h"
+#include "texgan/loading/ImageCodec.h"
+#include "texgan/loading/MipChain.h"
+#include "texgan/loading/BlockCompression.h"
+#include "texgan/loading/TextureCache.h"
+#include "texgan/loading/UploadScheduler.h"
+#include "texgan/loading/DecodePool.h"
+#include "texgan/loading/DecodedImageReservoir.h"
+#include "texgan/monitoring/PipelineStats.h"
 
 
 // ==================== Namespace Aliases ====================
@@ -44,6 +62,12 @@ namespace fs = std::filesystem;
 
 // ==================== Constants ====================
 const std::string IMAGE_PROVIDER_URL = "https://thispersondoesnotexist.com";
+const std::uint64_t IMAGE_CACHE_MAX_BYTES = 1ull << 30; // 1 GB of fetched payloads on disk
+const std::uint64_t TEXTURE_CACHE_MAX_BYTES = 2ull << 30; // 2 GB of GPU-ready textures on disk
+const std::size_t FETCH_STREAM_WINDOW = 32; // downloaded-but-unprocessed images held at once
+const std::size_t FETCH_STREAM_GROUP = 4;   // images handed to the uploader per delivery
+const std::size_t RESERVOIR_TARGET = 50;                    // decoded images kept ready by default
+const std::size_t RESERVOIR_MAX_BYTES = 512ull << 20;       // 512 MB of decoded pixels
 
 
 using Image = aif::ImageFetcher::RawImage;
@@ -571,11 +595,30 @@ namespace texgan::ecs{
 
     };
     
+    // Shared handle to a pooled GL texture; the texture goes back to its pool when the last copy is dropped
+    using TextureRef = std::shared_ptr<const GLuint>;
+
+    // A layer of a shared GL_TEXTURE_2D_ARRAY. The array object is replaced when the array grows, so
+    // `array` is read at draw time; the layer goes back to the array when the last copy is dropped.
+    struct TextureLayer{
+        std::shared_ptr<const GLuint> array;
+        GLint index;
+    };
+    using TextureLayerRef = std::shared_ptr<const TextureLayer>;
+
     struct TextureComponent{
         GLuint textureId{};
+        TextureRef texture; // keeps textureId alive while the entity shows it
+        TextureLayerRef layer; // set instead of the two above when the image went into a texture array
+        uint64_t lastDrawnFrame{0}; // set by the renderer, read by the texture residency manager
+        std::string source; // texture cache key the pixels can be uploaded again from, empty when there is none
 
-        ~TextureComponent() {
-            // if (textureId) glDeleteTextures(1, &textureId);
+        bool textured() const { return textureId != 0 || (layer && *layer->array != 0); }
+
+        // Shows `other` from now on; when the entity was last drawn stays as it is
+        void assign(TextureComponent other) {
+            other.lastDrawnFrame = lastDrawnFrame;
+            *this = std::move(other);
         }
     };
 
@@ -796,6 +839,100 @@ namespace texgan::rendering{
         GLuint m_programID;
     };
          
+    // What the strategies sent to the driver in the current frame
+    struct FrameStats {
+        size_t drawCalls = 0;
+        size_t textureBinds = 0;
+        size_t culled = 0; // entities outside the view frustum, not drawn
+    };
+
+    inline FrameStats& frameStats() {
+        static FrameStats stats;
+        return stats;
+    }
+
+    // Number of the frame being rendered, counted by Renderer::render. Textures record the frame they
+    // were last drawn in against it.
+    inline uint64_t& currentFrame() {
+        static uint64_t frame = 0;
+        return frame;
+    }
+
+    // The six planes of a view-projection matrix, for testing bounding spheres against the view
+    class Frustum {
+    public:
+        explicit Frustum(const glm::mat4& viewProjection) {
+            glm::vec4 rows[4];
+            for (int i = 0; i < 4; ++i) {
+                rows[i] = {viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]};
+            }
+            for (int i = 0; i < 3; ++i) {
+                m_planes[2 * i] = rows[3] + rows[i];
+                m_planes[2 * i + 1] = rows[3] - rows[i];
+            }
+            for (auto& plane : m_planes) plane /= glm::length(glm::vec3(plane));
+        }
+
+        bool intersects(const glm::vec3& center, float radius) const {
+            for (const auto& plane : m_planes) {
+                if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) return false;
+            }
+            return true;
+        }
+
+    private:
+        glm::vec4 m_planes[6];
+    };
+
+    // Binds entity textures for one strategy pass, skipping textures that are already bound.
+    // 2D textures go to unit 0 (texture0) and texture array layers to unit 1 (textureLayers), so a
+    // batch drawn from one array costs a single bind however many different images it shows.
+    class TextureBinder {
+    public:
+        explicit TextureBinder(const ShaderProgram& shader): m_shader(shader){}
+
+        void apply(ecs::TextureComponent* texture) {
+            if (texture) texture->lastDrawnFrame = currentFrame();
+            if (texture && texture->layer && *texture->layer->array) {
+                bind(GL_TEXTURE1, GL_TEXTURE_2D_ARRAY, *texture->layer->array, m_boundArray);
+                setTexture(true, texture->layer->index);
+            } else if (texture && texture->textureId > 0) {
+                bind(GL_TEXTURE0, GL_TEXTURE_2D, texture->textureId, m_bound2D);
+                setTexture(true, -1);
+            } else {
+                setTexture(false, -1);
+            }
+        }
+
+    private:
+        static void bind(GLenum unit, GLenum target, GLuint texture, GLuint& bound) {
+            if (bound == texture) return;
+            glActiveTexture(unit);
+            glBindTexture(target, texture);
+            glActiveTexture(GL_TEXTURE0);
+            bound = texture;
+            frameStats().textureBinds++;
+        }
+
+        void setTexture(bool useTexture, GLint layer) {
+            if (useTexture != m_useTexture) {
+                m_shader.setInt("useTexture", useTexture);
+                m_useTexture = useTexture;
+            }
+            if (useTexture && layer != m_layer) {
+                m_shader.setInt("textureLayer", layer);
+                m_layer = layer;
+            }
+        }
+
+        const ShaderProgram& m_shader;
+        GLuint m_bound2D = 0;
+        GLuint m_boundArray = 0;
+        // Unknown until set in this pass
+        std::optional<bool> m_useTexture;
+        std::optional<GLint> m_layer;
+    };
+
     class IRenderStrategy{
     public:
         virtual ~IRenderStrategy() = default;
@@ -809,6 +946,7 @@ namespace texgan::rendering{
         void render(const std::vector<ecs::Entity>& entities, ecs::World& world) override {
 
             m_shader.use();
+            TextureBinder textures(m_shader);
             for (auto entity : entities) {
                 auto* transform = world.getTransform(entity);
                 auto* mesh = world.getMesh(entity);
@@ -816,13 +954,7 @@ namespace texgan::rendering{
                 auto* render = world.getRenderComponent(entity);
 
                 
-                if (texture && texture->textureId > 0) {
-                    m_shader.setInt("useTexture", 1);
-                    glActiveTexture(GL_TEXTURE0);
-                    glBindTexture(GL_TEXTURE_2D, texture->textureId);
-                }else{
-                    m_shader.setInt("useTexture", 0);
-                }
+                textures.apply(texture);
 
                 if(transform){
                     m_shader.setMat4("model", transform->getModelMatrix());
@@ -837,6 +969,7 @@ namespace texgan::rendering{
                     }else{
                         glDrawArrays(render->primitive, 0, mesh->getVertexCount());
                     }
+                    frameStats().drawCalls++;
                     mesh->unbind();
                 }
             }
@@ -860,6 +993,7 @@ namespace texgan::rendering{
             if(entities.empty()) return;
             m_shader.use();  
             m_shader.setInt("useInstancing", 1);
+            TextureBinder textures(m_shader);
 
             
 
@@ -877,13 +1011,7 @@ namespace texgan::rendering{
                 }
 
 
-                if (texture && texture->textureId > 0) {
-                    m_shader.setInt("useTexture", 1);
-                    glActiveTexture(GL_TEXTURE0);
-                    glBindTexture(GL_TEXTURE_2D, texture->textureId);
-                }else{
-                    m_shader.setInt("useTexture", 0);
-                }
+                textures.apply(texture);
 
                 if(mesh && render){
                     
@@ -894,6 +1022,7 @@ namespace texgan::rendering{
                     } else {
                         glDrawArraysInstanced(render->primitive, 0, mesh->getVertexCount(), mesh->getInstanceCount());
                     }
+                    frameStats().drawCalls++;
                     mesh->unbind();
                 }
             }
@@ -912,16 +1041,36 @@ namespace texgan::rendering{
         explicit Renderer(core::Window & window): m_window{window}{
            
             m_defaultShader.loadFromFiles(texgan::utils::shader("shader.vert"), texgan::utils::shader("shader.frag"));
+            // Fixed texture units, see TextureBinder
+            m_defaultShader.use();
+            m_defaultShader.setInt("texture0", 0);
+            m_defaultShader.setInt("textureLayers", 1);
+            ShaderProgram::unuse();
 
             m_strategies[ecs::RenderType::Simple] = std::make_unique<SimpleRenderer>(m_defaultShader);
             m_strategies[ecs::RenderType::Instanced] = std::make_unique<InstancedRenderer>(m_defaultShader);
         }
 
-        void render(ecs::World & world){
+        // Draws every entity with a render component. Simple entities whose bounding sphere (the unit
+        // cube, scaled) is outside the view are skipped; instanced ones are always drawn, since their
+        // instances can be anywhere.
+        void render(ecs::World & world, const glm::mat4& viewProjection){
+            frameStats() = {};
+            currentFrame()++;
+            Frustum frustum(viewProjection);
             std::unordered_map<ecs::RenderType, std::vector<ecs::Entity>> renderGroups;
 
             for (auto entity : world.getEntities()) {
                 if (auto* render = world.getRenderComponent(entity)) {
+                    auto* transform = world.getTransform(entity);
+                    if (render->type == ecs::RenderType::Simple && transform) {
+                        glm::vec3 scale = glm::abs(transform->scale);
+                        float radius = 0.87f * std::max({scale.x, scale.y, scale.z}); // half the cube's diagonal
+                        if (!frustum.intersects(transform->position, radius)) {
+                            frameStats().culled++;
+                            continue;
+                        }
+                    }
                     renderGroups[render->type].push_back(entity);
                 }
             }
@@ -1006,110 +1155,791 @@ namespace texgan::monitoring{
         int frameCount;
         std::chrono::steady_clock::time_point lastTime, startTime;
     };
+
 }
 
 
 
 // ==================== [TEXTURE LOADING] ====================
 namespace texgan::loading{
-    // A struct to hold decoded image data
-    struct DecodedImage {
-        Image pixels;
-        int width;
-        int height;
-        int channels;
+    // Persistently mapped pixel-unpack buffer that decode threads write pixels into directly, so the
+    // GL thread only issues glTexSubImage2D from an offset and the driver copies asynchronously.
+    // Space is handed out in ring order and reused once the fence placed after its upload has signalled.
+    // Needs GL 4.4 or ARB_buffer_storage (Mesa llvmpipe has it, macOS does not); without it the ring
+    // stays unavailable and every image takes the pooled-memory path.
+    // The mapping is write-combined on many drivers, so decoders should only write to it.
+    class PboUploadRing : public PixelStorage {
+    public:
+        static constexpr size_t kDefaultBytes = 64ull << 20;
+        static constexpr size_t kAlignment = 64;
+
+        struct Stats {
+            size_t capacity;
+            size_t usedBytes;
+            size_t regions;
+            uint64_t allocations;
+            uint64_t fallbacks; // images that did not fit and went to pooled memory
+        };
+
+        // Creates the buffer; call with the GL context current
+        explicit PboUploadRing(size_t bytes = kDefaultBytes) : m_capacity(bytes) {
+            if (!(GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage)) return;
+
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glGenBuffers(1, &m_buffer);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+            glBufferStorage(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, flags);
+            m_mapped = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(bytes), flags));
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+            if (!m_mapped) {
+                glDeleteBuffers(1, &m_buffer);
+                m_buffer = 0;
+            }
+        }
+
+        // Call with the GL context current, after every buffer taken from the ring is gone
+        ~PboUploadRing() override {
+            for (auto& region : m_regions) {
+                if (region.fence) glDeleteSync(region.fence);
+            }
+            if (m_buffer) {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                glDeleteBuffers(1, &m_buffer);
+            }
+        }
+
+        PboUploadRing(const PboUploadRing&) = delete;
+        PboUploadRing& operator=(const PboUploadRing&) = delete;
+
+        // Whether persistent mapping worked
+        bool available() const { return m_mapped != nullptr; }
+
+        void setEnabled(bool enabled) { m_enabled = enabled; }
+        bool enabled() const { return m_enabled && available(); }
+
+        GLuint buffer() const { return m_buffer; }
+
+        // Whether `pixels` lives in this ring, so it can be uploaded from the buffer
+        bool holds(const PixelBuffer& pixels) const { return pixels.storage() == this; }
+
+        GLintptr offsetOf(const PixelBuffer& pixels) const { return pixels.data() - m_mapped; }
+
+        // Decode threads: claims the next `size` bytes of the ring
+        bool allocate(size_t size, PixelBuffer& pixels) override {
+            if (!enabled() || size == 0) return false;
+            size_t aligned = (size + kAlignment - 1) & ~(kAlignment - 1);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            size_t offset = 0;
+            if (!m_regions.empty()) {
+                size_t tail = m_regions.front().offset;
+                if (m_head > tail) {
+                    // Free space runs from the head to the end, then from the start up to the tail
+                    if (m_head + aligned <= m_capacity) offset = m_head;
+                    else if (aligned <= tail) offset = 0;
+                    else return fallback();
+                } else {
+                    // Wrapped: only the gap between head and tail is free
+                    if (m_head + aligned <= tail) offset = m_head;
+                    else return fallback();
+                }
+            } else if (aligned > m_capacity) {
+                return fallback();
+            }
+
+            uint64_t ticket = m_nextTicket++;
+            m_regions.push_back({ticket, offset, aligned});
+            m_head = offset + aligned;
+            m_allocations++;
+            pixels.adopt(m_mapped + offset, size, this, ticket);
+            return true;
+        }
+
+        // Any thread: the image is gone. Its space comes back once its upload (if any) has completed.
+        void release(uint64_t ticket) override {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (Region* region = find(ticket)) region->released = true;
+        }
+
+        // GL thread, right after the commands reading `pixels` have been issued
+        void submitted(const PixelBuffer& pixels) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (Region* region = find(pixels.ticket())) {
+                if (region->fence) glDeleteSync(region->fence);
+                region->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            }
+        }
+
+        // GL thread, once per frame: reclaims space from the oldest regions whose uploads have finished
+        void retire() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            while (!m_regions.empty()) {
+                Region& oldest = m_regions.front();
+                if (!oldest.released) break;
+                if (oldest.fence) {
+                    GLenum status = glClientWaitSync(oldest.fence, 0, 0);
+                    if (status == GL_TIMEOUT_EXPIRED) break;
+                    glDeleteSync(oldest.fence);
+                }
+                m_regions.pop_front();
+            }
+            if (m_regions.empty()) m_head = 0;
+        }
+
+        Stats stats() const {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            size_t used = 0;
+            for (const auto& region : m_regions) used += region.size;
+            return {available() ? m_capacity : 0, used, m_regions.size(), m_allocations, m_fallbacks};
+        }
+
+    private:
+        struct Region {
+            uint64_t ticket;
+            size_t offset;
+            size_t size;
+            bool released = false;
+            GLsync fence = nullptr;
+        };
+
+        bool fallback() {
+            m_fallbacks++;
+            return false;
+        }
+
+        Region* find(uint64_t ticket) {
+            for (auto& region : m_regions) {
+                if (region.ticket == ticket) return &region;
+            }
+            return nullptr;
+        }
+
+        size_t m_capacity;
+        GLuint m_buffer = 0;
+        unsigned char* m_mapped = nullptr;
+        std::atomic<bool> m_enabled{true};
+
+        mutable std::mutex m_mutex;
+        std::deque<Region> m_regions; // oldest first
+        size_t m_head = 0;            // where the next region starts
+        uint64_t m_nextTicket = 1;
+        uint64_t m_allocations = 0;
+        uint64_t m_fallbacks = 0;
     };
 
-    unsigned int loadTextureFromFile(const char* path){
-        unsigned int textureID;
-        glGenTextures(1, &textureID);
+    // Texture objects recycled by format. Storage is allocated once, immutable where the driver has
+    // glTexStorage2D (GL 4.2 / ARB_texture_storage), and the next image of the same size and format is
+    // uploaded into it with glTexSubImage2D, so batch after batch reuses the same VRAM.
+    // Handles may be dropped on any thread; GL calls only happen in acquire(), collect() and the
+    // destructor, which run where a context is current.
+    // A released texture may still be read by draws the GPU has not run yet, and with shared contexts
+    // a loader thread would upload into it without waiting for them. So collect() fences the releases
+    // since the last frame, and acquire() only reuses textures whose fence has signalled.
+    class TexturePool : public std::enable_shared_from_this<TexturePool> {
+    public:
+        static constexpr size_t kDefaultRetainedBytes = 256ull << 20; // free textures kept for reuse
 
-        int width, height, nrChannels;
-        unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 0);
-        
-        if (data) 
-        {
-            GLenum format;
-            if (nrChannels == 1)
-                format = GL_RED;
-            else if (nrChannels == 3)
-                format = GL_RGB;
-            else if (nrChannels == 4)
-                format = GL_RGBA;
-
-            glBindTexture(GL_TEXTURE_2D, textureID);
-            glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
+        struct Format {
+            GLsizei width;
+            GLsizei height;
+            GLenum internalFormat;
+            GLsizei levels;
+
+            bool operator==(const Format&) const = default;
+        };
+
+        struct Stats {
+            size_t live;
+            size_t free;
+            size_t liveBytes;
+            size_t freeBytes;
+            uint64_t created;
+            uint64_t reused;
+        };
+
+        static std::shared_ptr<TexturePool> create(size_t retainedBytes = kDefaultRetainedBytes) {
+            return std::shared_ptr<TexturePool>(new TexturePool(retainedBytes));
+        }
+
+        ~TexturePool() {
+            for (auto& [format, textures] : m_free) {
+                for (const auto& free : textures) glDeleteTextures(1, &free.texture);
+            }
+            if (!m_doomed.empty()) glDeleteTextures(static_cast<GLsizei>(m_doomed.size()), m_doomed.data());
+            for (const auto& pending : m_fences) glDeleteSync(pending.fence);
+        }
+
+        // Format for a `channels`-channel image with a full mip chain, or for its `blocks` when compressed
+        static Format formatFor(int width, int height, int channels, BlockFormat blocks = BlockFormat::None) {
+            GLenum internalFormat = channels == 4 ? GL_RGBA8 : channels == 3 ? GL_RGB8 : GL_R8;
+            if (blocks == BlockFormat::Bc1) internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+            return {width, height, internalFormat, mipLevelCount(width, height)};
+        }
+
+        // Client format that allocates `internalFormat` through glTexImage2D/3D
+        static GLenum baseFormatOf(GLenum internalFormat) {
+            return internalFormat == GL_RGBA8 ? GL_RGBA : internalFormat == GL_R8 ? GL_RED : GL_RGB;
+        }
+
+        // A texture with storage for `format`, recycled when a free one exists. Goes back to the pool
+        // when the last copy of the handle is dropped.
+        ecs::TextureRef acquire(const Format& format) {
+            GLuint texture = 0;
+            size_t bytes = bytesOf(format);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                // Oldest first: anything after the first unsignalled release is newer still
+                auto it = m_free.find(format);
+                if (it != m_free.end() && !it->second.empty() && it->second.front().epoch < m_safeEpoch) {
+                    texture = it->second.front().texture;
+                    it->second.pop_front();
+                    m_freeBytes -= bytes;
+                    m_reused++;
+                }
+                m_live++;
+                m_liveBytes += bytes;
+            }
+            if (!texture) {
+                texture = allocate(format);
+                m_created++;
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_liveFormats[texture] = format;
+            }
+
+            std::weak_ptr<TexturePool> pool = weak_from_this();
+            return ecs::TextureRef(new GLuint(texture), [pool, format](const GLuint* id) {
+                // Without the pool the context is going away with it
+                if (auto alive = pool.lock()) alive->release(*id, format);
+                delete id;
+            });
+        }
+
+        // Deletes textures released beyond the retained budget, fences the textures released since the
+        // last call and makes those whose fence has signalled reusable. Main thread, once per frame.
+        void collect() {
+            std::vector<GLuint> doomed;
+            bool fence = false;
+            uint64_t fencedEpoch = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                doomed.swap(m_doomed);
+                if (m_unfenced) {
+                    // The fence below covers every release up to now; later ones get the next epoch
+                    fence = true;
+                    fencedEpoch = m_epoch++;
+                    m_unfenced = false;
+                }
+            }
+            if (!doomed.empty()) glDeleteTextures(static_cast<GLsizei>(doomed.size()), doomed.data());
+
+            // Fences signal in order, so stop at the first one that has not
+            uint64_t safeEpoch = 0;
+            while (!m_fences.empty()) {
+                GLenum status = glClientWaitSync(m_fences.front().fence, 0, 0);
+                if (status == GL_TIMEOUT_EXPIRED) break;
+                safeEpoch = m_fences.front().epoch + 1;
+                glDeleteSync(m_fences.front().fence);
+                m_fences.pop_front();
+            }
+
+            if (fence) {
+                m_fences.push_back({glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), fencedEpoch});
+                glFlush(); // so the fence reaches the GPU even if the next frame is late
+            }
+            if (safeEpoch > 0) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_safeEpoch = std::max(m_safeEpoch, safeEpoch);
+            }
+        }
+
+        // Gives up free textures until `bytes` have gone or none are left; the next collect() deletes
+        // them. Returns the bytes given up.
+        size_t trim(size_t bytes) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            size_t trimmed = 0;
+            for (auto& [format, textures] : m_free) {
+                size_t each = bytesOf(format);
+                // Deleting a texture the GPU still reads is fine: GL frees it once those draws are done
+                while (trimmed < bytes && !textures.empty()) {
+                    m_doomed.push_back(textures.back().texture);
+                    textures.pop_back();
+                    m_freeBytes -= each;
+                    trimmed += each;
+                }
+            }
+            return trimmed;
+        }
+
+        // Format of a texture handed out by acquire() and still in use
+        std::optional<Format> formatOf(GLuint texture) const {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_liveFormats.find(texture);
+            if (it == m_liveFormats.end()) return std::nullopt;
+            return it->second;
+        }
+
+        // VRAM taken by a texture of `format`, mip chain included
+        static size_t bytesOf(const Format& format) {
+            if (format.internalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT) {
+                return bc1ChainBytes(format.width, format.height, format.levels);
+            }
+            size_t texel = format.internalFormat == GL_R8 ? 1 : 4; // drivers pad RGB8 to 4 bytes
+            size_t bytes = 0;
+            for (GLsizei level = 0; level < format.levels; ++level) {
+                bytes += static_cast<size_t>(std::max(1, format.width >> level)) * std::max(1, format.height >> level) * texel;
+            }
+            return bytes;
+        }
+
+        Stats stats() const {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            size_t free = 0;
+            for (const auto& [format, textures] : m_free) free += textures.size();
+            return {m_live, free, m_liveBytes, m_freeBytes, m_created, m_reused};
+        }
 
-            // Set texture parameters
+        // A new texture with storage for `format`, not tracked by any pool
+        static GLuint allocate(const Format& format) {
+            GLuint texture = 0;
+            glGenTextures(1, &texture);
+            glBindTexture(GL_TEXTURE_2D, texture);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            if (GLEW_VERSION_4_2 || GLEW_ARB_texture_storage) {
+                glTexStorage2D(GL_TEXTURE_2D, format.levels, format.internalFormat, format.width, format.height);
+            } else {
+                // Same layout through mutable storage, one level at a time
+                GLenum baseFormat = baseFormatOf(format.internalFormat);
+                for (GLsizei level = 0; level < format.levels; ++level) {
+                    glTexImage2D(GL_TEXTURE_2D, level, format.internalFormat, std::max(1, format.width >> level),
+                                 std::max(1, format.height >> level), 0, baseFormat, GL_UNSIGNED_BYTE, nullptr);
+                }
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, format.levels - 1);
+            }
+            glBindTexture(GL_TEXTURE_2D, 0);
+            return texture;
+        }
+
+    private:
+        struct FormatHash {
+            size_t operator()(const Format& f) const {
+                size_t h = std::hash<GLsizei>()(f.width);
+                h = h * 31 + std::hash<GLsizei>()(f.height);
+                h = h * 31 + std::hash<GLenum>()(f.internalFormat);
+                return h * 31 + std::hash<GLsizei>()(f.levels);
+            }
+        };
+
+        struct FreeTexture {
+            GLuint texture;
+            uint64_t epoch; // reusable once m_safeEpoch is past it
+        };
 
-            stbi_image_free(data);
+        struct PendingFence {
+            GLsync fence;
+            uint64_t epoch; // the releases it covers
+        };
+
+        explicit TexturePool(size_t retainedBytes) : m_retainedBytes(retainedBytes) {}
+
+        void release(GLuint texture, const Format& format) {
+            size_t bytes = bytesOf(format);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_live--;
+            m_liveBytes -= bytes;
+            m_liveFormats.erase(texture);
+            if (m_freeBytes + bytes <= m_retainedBytes) {
+                m_free[format].push_back({texture, m_epoch});
+                m_freeBytes += bytes;
+                m_unfenced = true;
+            } else {
+                m_doomed.push_back(texture);
+            }
         }
-        else 
-        {
-            std::cerr << "Failed to load texture at path: " << path << std::endl;
-            stbi_image_free(data);
+
+        const size_t m_retainedBytes;
+        mutable std::mutex m_mutex;
+        std::unordered_map<Format, std::deque<FreeTexture>, FormatHash> m_free; // oldest release first
+        std::vector<GLuint> m_doomed; // deleted by the next collect()
+        std::deque<PendingFence> m_fences; // main thread only
+        uint64_t m_epoch = 0;              // of the releases since the last fence
+        uint64_t m_safeEpoch = 0;          // releases before this one are done on the GPU
+        bool m_unfenced = false;           // a release is waiting for the next fence
+        std::unordered_map<GLuint, Format> m_liveFormats;
+        size_t m_freeBytes = 0;
+        size_t m_live = 0;
+        size_t m_liveBytes = 0;
+        std::atomic<uint64_t> m_created{0};
+        std::atomic<uint64_t> m_reused{0};
+    };
+
+    // One GL_TEXTURE_2D_ARRAY holding same-sized images as layers, so every entity showing one of them
+    // is drawn with the same texture bound. The array grows in chunks of layers: a bigger array is
+    // allocated and the existing layers are copied across, with glCopyImageSubData (GL 4.3 /
+    // ARB_copy_image) or otherwise through a read framebuffer, which cannot read compressed layers, so
+    // BC1 images only go into arrays where glCopyImageSubData exists. Its format is set by the first
+    // image and can only change once no layer is in use; images of another size go to 2D textures instead.
+    // Layers may be dropped on any thread; GL calls only happen in acquire(), flush() and the destructor.
+    class TextureArray : public std::enable_shared_from_this<TextureArray> {
+    public:
+        static constexpr GLsizei kLayersPerChunk = 32;
+
+        struct Stats {
+            size_t live;     // layers in use
+            size_t capacity; // layers allocated
+            size_t bytes;
+            uint64_t grows;
+        };
+
+        static std::shared_ptr<TextureArray> create() {
+            return std::shared_ptr<TextureArray>(new TextureArray());
+        }
+
+        ~TextureArray() {
+            if (m_framebuffers[0]) glDeleteFramebuffers(2, m_framebuffers);
+            if (*m_name) glDeleteTextures(1, m_name.get());
+            *m_name = 0; // layers still held by entities draw untextured
         }
 
-        return textureID;
+        // A free layer for an image of `format`, growing the array when it is full. Null when the
+        // array holds another format, or has reached the driver's layer limit.
+        ecs::TextureLayerRef acquire(const TexturePool::Format& format) {
+            if (format.internalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT && !(GLEW_VERSION_4_3 || GLEW_ARB_copy_image)) {
+                return nullptr;
+            }
+            GLint index = -1;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!(format == m_format)) {
+                    if (m_live > 0) return nullptr;
+                    reset(format);
+                }
+                if (!m_freeLayers.empty()) {
+                    index = m_freeLayers.back();
+                    m_freeLayers.pop_back();
+                } else if (m_nextLayer < m_capacity) {
+                    index = m_nextLayer++;
+                }
+            }
+            if (index < 0) {
+                if (!grow()) return nullptr;
+                std::lock_guard<std::mutex> lock(m_mutex);
+                index = m_nextLayer++;
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_live++;
+            }
+
+            std::weak_ptr<TextureArray> array = weak_from_this();
+            return ecs::TextureLayerRef(new ecs::TextureLayer{m_name, index}, [array](const ecs::TextureLayer* layer) {
+                if (auto alive = array.lock()) alive->release(layer->index);
+                delete layer;
+            });
+        }
+
+        // `layer` was uploaded without its mip chain. Main thread.
+        void invalidateMipmaps(GLint layer) { m_dirtyLayers.push_back(layer); }
+
+        // Rebuilds the mip chains of the layers uploaded without one since the last call. Main thread,
+        // once per frame. glGenerateMipmap would redo every layer of the array each time, so a batch
+        // filling N layers would cost O(N^2); instead each touched layer blits its levels down one by
+        // one. Compressed layers always arrive with their chain, so the blits only meet renderable formats.
+        void flush() {
+            if (!*m_name || (!m_dirty && m_dirtyLayers.empty())) return;
+            if (m_dirty) {
+                // Every layer lost its mips when the array grew without glCopyImageSubData
+                glBindTexture(GL_TEXTURE_2D_ARRAY, *m_name);
+                glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+                glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+            } else {
+                std::sort(m_dirtyLayers.begin(), m_dirtyLayers.end());
+                m_dirtyLayers.erase(std::unique(m_dirtyLayers.begin(), m_dirtyLayers.end()), m_dirtyLayers.end());
+                blitMipmaps(m_dirtyLayers);
+            }
+            m_dirty = false;
+            m_dirtyLayers.clear();
+        }
+
+        Stats stats() const {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            size_t bytes = TexturePool::bytesOf(m_format) * m_capacity;
+            return {m_live, static_cast<size_t>(m_capacity), bytes, m_grows};
+        }
+
+    private:
+        TextureArray() : m_name(std::make_shared<GLuint>(0)) {}
+
+        // Drops the (unused) array so the next grow() allocates one of `format`. Called with the lock held.
+        void reset(const TexturePool::Format& format) {
+            if (*m_name) glDeleteTextures(1, m_name.get());
+            *m_name = 0;
+            m_format = format;
+            m_capacity = 0;
+            m_nextLayer = 0;
+            m_freeLayers.clear();
+            // Pending mip rebuilds were for layers of the array just deleted
+            m_dirty = false;
+            m_dirtyLayers.clear();
+        }
+
+        bool grow() {
+            if (m_maxLayers == 0) glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &m_maxLayers);
+            if (m_capacity >= m_maxLayers) return false;
+            GLsizei layers = std::min(m_capacity + kLayersPerChunk, m_maxLayers);
+
+            GLuint texture = allocate(m_format, layers);
+            if (m_capacity > 0) {
+                copyLayers(*m_name, texture);
+                glDeleteTextures(1, m_name.get());
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            *m_name = texture;
+            m_capacity = layers;
+            m_grows++;
+            return true;
+        }
+
+        static GLuint allocate(const TexturePool::Format& format, GLsizei layers) {
+            GLuint texture = 0;
+            glGenTextures(1, &texture);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            if (GLEW_VERSION_4_2 || GLEW_ARB_texture_storage) {
+                glTexStorage3D(GL_TEXTURE_2D_ARRAY, format.levels, format.internalFormat, format.width, format.height, layers);
+            } else {
+                GLenum baseFormat = TexturePool::baseFormatOf(format.internalFormat);
+                for (GLsizei level = 0; level < format.levels; ++level) {
+                    glTexImage3D(GL_TEXTURE_2D_ARRAY, level, format.internalFormat, std::max(1, format.width >> level),
+                                 std::max(1, format.height >> level), layers, 0, baseFormat, GL_UNSIGNED_BYTE, nullptr);
+                }
+                glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, format.levels - 1);
+            }
+            glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+            return texture;
+        }
+
+        // Copies the first m_capacity layers of `from` into `to`, which has the same format
+        void copyLayers(GLuint from, GLuint to) {
+            if (GLEW_VERSION_4_3 || GLEW_ARB_copy_image) {
+                for (GLsizei level = 0; level < m_format.levels; ++level) {
+                    glCopyImageSubData(from, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, to, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+                                       std::max(1, m_format.width >> level), std::max(1, m_format.height >> level), m_capacity);
+                }
+                return;
+            }
+
+            // Base level only, one layer at a time; the mips are rebuilt by the next flush()
+            GLuint framebuffer = 0;
+            glGenFramebuffers(1, &framebuffer);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, to);
+            for (GLint layer = 0; layer < m_capacity; ++layer) {
+                glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, from, 0, layer);
+                glCopyTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, 0, 0, m_format.width, m_format.height);
+            }
+            glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+            glDeleteFramebuffers(1, &framebuffer);
+            m_dirty = true;
+        }
+
+        // Fills levels 1 and up of each of `layers` from the level above it, with a linear blit
+        void blitMipmaps(const std::vector<GLint>& layers) {
+            if (!m_framebuffers[0]) glGenFramebuffers(2, m_framebuffers);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffers[0]);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_framebuffers[1]);
+            for (GLint layer : layers) {
+                for (GLsizei level = 1; level < m_format.levels; ++level) {
+                    glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, *m_name, level - 1, layer);
+                    glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, *m_name, level, layer);
+                    glBlitFramebuffer(0, 0, std::max(1, m_format.width >> (level - 1)), std::max(1, m_format.height >> (level - 1)),
+                                      0, 0, std::max(1, m_format.width >> level), std::max(1, m_format.height >> level),
+                                      GL_COLOR_BUFFER_BIT, GL_LINEAR);
+                }
+            }
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        }
+
+        void release(GLint index) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_live--;
+            m_freeLayers.push_back(index);
+        }
+
+        std::shared_ptr<GLuint> m_name; // shared with the layers, updated when the array is replaced
+        TexturePool::Format m_format{};
+        GLint m_maxLayers = 0;
+        bool m_dirty = false;              // every layer needs its mips rebuilt; main thread only
+        std::vector<GLint> m_dirtyLayers;  // layers uploaded without mips; main thread only
+        GLuint m_framebuffers[2] = {0, 0}; // read and draw, for blitMipmaps()
+
+        mutable std::mutex m_mutex;
+        GLsizei m_capacity = 0;
+        GLint m_nextLayer = 0; // layers below this have been handed out at least once
+        std::vector<GLint> m_freeLayers;
+        size_t m_live = 0;
+        uint64_t m_grows = 0;
+    };
+
+    // Client pixel format of a decoded image with `channels` channels
+    inline GLenum pixelFormatFor(int channels) {
+        return channels == 1 ? GL_RED : channels == 4 ? GL_RGBA : GL_RGB;
     }
 
-    // 1. Decode function (can be called in a worker thread)
-    bool decodeImageToMemory(const Image& image, DecodedImage& out) {
-        stbi_set_flip_vertically_on_load(true);
-        int w, h, c;
-        unsigned char* data = stbi_load_from_memory(image.data(), image.size(), &w, &h, &c, 0);
-        if (!data) return false;
-        size_t size = static_cast<size_t>(w) * h * c;
-        out.pixels.assign(data, data + size);
-        out.width = w;
-        out.height = h;
-        out.channels = c;
-        stbi_image_free(data);
-        return true;
+    // First mip level of `img` that fits within `maxSize` (0 for no limit). Only levels the decoder built
+    // can be dropped, so images without a chain always start at level 0.
+    inline int baseLevelFor(const DecodedImage& img, int maxSize) {
+        int level = 0;
+        while (maxSize > 0 && level + 1 < img.levels &&
+               std::max(mipSize(img.width, level), mipSize(img.height, level)) > maxSize) {
+            ++level;
+        }
+        return level;
+    }
+
+    // Uploads the levels of `img` from `baseLevel` on into the bound `target`: GL_TEXTURE_2D, or layer
+    // `layer` of GL_TEXTURE_2D_ARRAY. Pixels that live in `ring` are uploaded from the buffer object, and
+    // the ring is told once the copies have been issued. Compressed images go through
+    // glCompressedTexSubImage*, into storage the pool already allocated. Returns the number of levels uploaded.
+    GLsizei uploadMipLevels(GLenum target, GLint layer, const DecodedImage& img, int baseLevel, PboUploadRing* ring) {
+        bool fromRing = ring && ring->holds(img.pixels);
+        if (fromRing) glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring->buffer());
+
+        GLenum format = pixelFormatFor(img.channels);
+        // rows of 1- and 3-channel images are not 4-byte aligned
+        glPixelStorei(GL_UNPACK_ALIGNMENT, img.channels == 4 ? 4 : 1);
+        bool compressed = img.blocks == BlockFormat::Bc1;
+        for (int level = baseLevel; level < img.levels; ++level) {
+            size_t offset = compressed ? bc1LevelOffset(img.width, img.height, level)
+                                       : mipLevelOffset(img.width, img.height, img.channels, level);
+            const void* source = fromRing ? reinterpret_cast<const void*>(ring->offsetOf(img.pixels) + offset)
+                                          : img.pixels.data() + offset;
+            GLsizei width = mipSize(img.width, level);
+            GLsizei height = mipSize(img.height, level);
+            if (compressed) {
+                GLsizei size = static_cast<GLsizei>(bc1LevelBytes(width, height));
+                if (target == GL_TEXTURE_2D_ARRAY) {
+                    glCompressedTexSubImage3D(target, level - baseLevel, 0, 0, layer, width, height, 1,
+                                              GL_COMPRESSED_RGB_S3TC_DXT1_EXT, size, source);
+                } else {
+                    glCompressedTexSubImage2D(target, level - baseLevel, 0, 0, width, height,
+                                              GL_COMPRESSED_RGB_S3TC_DXT1_EXT, size, source);
+                }
+            } else if (target == GL_TEXTURE_2D_ARRAY) {
+                glTexSubImage3D(target, level - baseLevel, 0, 0, layer, width, height, 1, format, GL_UNSIGNED_BYTE, source);
+            } else {
+                glTexSubImage2D(target, level - baseLevel, 0, 0, width, height, format, GL_UNSIGNED_BYTE, source);
+            }
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        if (fromRing) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            ring->submitted(img.pixels);
+        }
+        return img.levels - baseLevel;
     }
 
     // 2. Generate GL texture (must run on main thread with valid context)
-    GLuint generateGLTexture(const DecodedImage& img) {
-        if (img.pixels.empty()) return 0;
-        GLenum format = GL_RGB;
-        if (img.channels == 1) format = GL_RED;
-        else if (img.channels == 3) format = GL_RGB;
-        else if (img.channels == 4) format = GL_RGBA;
-
-        GLuint textureID = 0;
-        glGenTextures(1, &textureID);
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        // set parameters as desired
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        // upload
-        glTexImage2D(GL_TEXTURE_2D, 0, format, img.width, img.height, 0, format, GL_UNSIGNED_BYTE, img.pixels.data());
-        glGenerateMipmap(GL_TEXTURE_2D);
+    // The texture comes from `pool`, so only the pixels are uploaded: every level the decoder built,
+    // starting from the first one within `maxSize`. glGenerateMipmap only runs for images without a chain.
+    ecs::TextureRef generateGLTexture(const DecodedImage& img, TexturePool& pool, PboUploadRing* ring = nullptr,
+                                      int maxSize = 0) {
+        if (img.pixels.empty()) return nullptr;
+        int baseLevel = baseLevelFor(img, maxSize);
+        auto format = TexturePool::formatFor(mipSize(img.width, baseLevel), mipSize(img.height, baseLevel), img.channels,
+                                             img.blocks);
+
+        ecs::TextureRef texture = pool.acquire(format);
+        glBindTexture(GL_TEXTURE_2D, *texture);
+        if (uploadMipLevels(GL_TEXTURE_2D, 0, img, baseLevel, ring) < format.levels) {
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
         glBindTexture(GL_TEXTURE_2D, 0);
-        return textureID;
+        return texture;
+    }
+
+    // Loads an image file shipped with the app into a texture of its own, e.g. for the UI. Decoded like a
+    // fetched image, mip chain included, so the GL thread only uploads it. Kept top row first, as ImGui
+    // draws it. 0 when the file cannot be read or decoded.
+    GLuint loadTextureFromFile(const char* path) {
+        std::ifstream file(path, std::ios::binary);
+        DecodedImage img;
+        DecodeOptions options;
+        options.pixels.flipVertically = false;
+        options.mipmaps = true;
+        if (!file || !decodeImageToMemory(Image(std::vector<unsigned char>(std::istreambuf_iterator<char>(file), {})), img, options)) {
+            std::cerr << "Failed to load texture at path: " << path << std::endl;
+            return 0;
+        }
+
+        GLuint texture = TexturePool::allocate(TexturePool::formatFor(img.width, img.height, img.channels, img.blocks));
+        glBindTexture(GL_TEXTURE_2D, texture);
+        if (uploadMipLevels(GL_TEXTURE_2D, 0, img, 0, nullptr) < mipLevelCount(img.width, img.height)) {
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return texture;
+    }
+
+    // Same as generateGLTexture, into a free layer of `array`. Null when the image does not match the
+    // array's format or the array is full, so the caller can fall back to a 2D texture. A missing mip
+    // chain is left to the array's next flush().
+    ecs::TextureLayerRef generateGLTextureLayer(const DecodedImage& img, TextureArray& array, PboUploadRing* ring = nullptr,
+                                                int maxSize = 0) {
+        if (img.pixels.empty()) return nullptr;
+        int baseLevel = baseLevelFor(img, maxSize);
+        auto format = TexturePool::formatFor(mipSize(img.width, baseLevel), mipSize(img.height, baseLevel), img.channels,
+                                             img.blocks);
+        ecs::TextureLayerRef layer = array.acquire(format);
+        if (!layer) return nullptr;
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, *layer->array);
+        if (uploadMipLevels(GL_TEXTURE_2D_ARRAY, layer->index, img, baseLevel, ring) < format.levels) {
+            array.invalidateMipmaps(layer->index);
+        }
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        return layer;
     }
 
 
     struct TextureLoader{
         virtual ~TextureLoader() = default;
-        /// Clean up any GL resources or windows
+        // Clean up any GL resources or windows
         virtual void cleanup() = 0;
-        /// Called on the main thread each frame to upload pending textures and assign them to entities
+        // Called on the main thread each frame to upload pending textures and assign them to entities
         virtual void update(texgan::ecs::World& world) = 0;
-        /// Called from the image-fetch callback (possibly worker thread) to enqueue or immediately upload
-        virtual void processImages(bool success, const Images& images) = 0;
+        // Called from the image-fetch callback (possibly worker thread) to hand the images to the decode pool,
+        // which passes them on to processDecoded. `keepAlive` is held until they are uploaded.
+        virtual void processImages(bool success, Images images, std::shared_ptr<void> keepAlive = {}) = 0;
+        // Called with decoded images, from a decode thread or with images taken from the prefetch reservoir.
+        // `keepAlive` (the stream credits of the images) is released once the last of them is uploaded, so
+        // a stream never gets further ahead of the uploads than its window.
+        virtual void processDecoded(std::vector<DecodedImage> images, std::shared_ptr<void> keepAlive = {}) = 0;
+        // Called when a new batch starts. Textures of earlier batches are no longer handed out, and go back
+        // to the texture pool once the entities showing them have been given new ones.
+        virtual void startBatch() = 0;
     };
 
     class SingleContextUploadApproach : public TextureLoader{
     public:
-        SingleContextUploadApproach() = default;
+        SingleContextUploadApproach(DecodePool& decoder, std::shared_ptr<TexturePool> texturePool,
+                                    std::shared_ptr<TextureArray> textureArray)
+            : decoder(decoder), texturePool(std::move(texturePool)), textureArray(std::move(textureArray)),
+              ring(std::make_unique<PboUploadRing>()) {}
         ~SingleContextUploadApproach() override {
             cleanup();
         }
@@ -1117,147 +1947,565 @@ namespace texgan::loading{
         
         virtual void cleanup() override {
             std::lock_guard<std::mutex> lock(mutex);
-            for(GLuint texture: textures) glDeleteTextures(1, &texture);
-            textures.clear();
+            assigned = 0; // entities keep the textures they show
         }
 
-        /// Called on the main thread each frame to upload pending textures and assign them to entities
+        virtual void startBatch() override {
+            std::lock_guard<std::mutex> lock(mutex);
+            assigned = 0;
+        }
+
+        // Called on the main thread each frame to upload pending textures and assign them to entities.
+        // Uploads only as many as the scheduler's per-frame budget allows; the rest wait for later frames.
         virtual void update(texgan::ecs::World& world) override {
-            std::deque<DecodedImage> localQueue;
+            ring->retire();
+            scheduler.beginFrame();
+            std::vector<ecs::TextureComponent> uploaded;
+
+            while (true) {
+                Queued next; // its credits go back to the stream at the end of this iteration
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (imageQueue.empty() || !scheduler.admit(imageQueue.front().image.pixels.size())) break;
+                    next = std::move(imageQueue.front());
+                    imageQueue.pop_front();
+                    pendingBytes -= next.image.pixels.size();
+                }
+                const DecodedImage& decodedImage = next.image;
+
+                auto start = std::chrono::steady_clock::now();
+                auto texture = upload(decodedImage);
+                auto elapsed = std::chrono::steady_clock::now() - start;
+                scheduler.uploaded(decodedImage.pixels.size(), elapsed);
+                if(texture.textureId || texture.layer) {
+                    uploaded.push_back(std::move(texture));
+                    monitoring::pipelineStats().upload.record(1, decodedImage.pixels.size(), elapsed);
+                }
+            }
 
-            // Safely move pendingImageQueue to local queue. which means pendingImageQueue is now empty
             {
                 std::lock_guard<std::mutex> lock(mutex);
-                if(imageQueue.empty()) return;
-                localQueue.swap(imageQueue);
+                scheduler.endFrame(imageQueue.size(), pendingBytes);
             }
 
-            for(const DecodedImage& decodedImage: localQueue){
-                GLuint textureID = generateGLTexture(decodedImage);
-                if(textureID) textures.push_back(textureID);
+            if (!uploaded.empty()) {
+                textureArray->flush();
+                assignTextures(world, std::move(uploaded));
             }
-
-            assignTextures(world);
         }
 
-        /// Called from the image-fetch callback (possibly worker thread) to enqueue or immediately upload
-        virtual void processImages(bool success, const Images& images) override {
-            if(!success) return;
+        UploadScheduler& uploadScheduler() { return scheduler; }
+        PboUploadRing& uploadRing() { return *ring; }
 
-            for(const auto& image: images){
+        // Upload same-sized images into layers of the texture array instead of separate 2D textures.
+        // Applies to images uploaded afterwards.
+        void setUseTextureArray(bool enabled) { useTextureArray = enabled; }
+        bool usesTextureArray() const { return useTextureArray; }
 
-                DecodedImage decodedImage;
-                if(!decodeImageToMemory(image, decodedImage)) continue; // failure
+        // Largest texture edge to upload, 0 for full size. Mip levels above it are dropped.
+        void setMaxTextureSize(int size) { maxTextureSize = std::max(size, 0); }
 
-                // Safely push to a shared queue
-                {
-                    std::lock_guard<std::mutex> lock(mutex);
-                    imageQueue.push_back(std::move(decodedImage));
-                }
+        // Called from the image-fetch callback (possibly worker thread) to hand the images to the decode pool
+        virtual void processImages(bool success, Images images, std::shared_ptr<void> keepAlive = {}) override {
+            if(!success) return;
+            // Decode threads write straight into the upload ring while it has room
+            decoder.decode(std::move(images), [this, keepAlive](std::vector<DecodedImage> decoded) {
+                processDecoded(std::move(decoded), keepAlive);
+            }, {}, ring.get());
+        }
+
+        // Queues decoded images for the next update() on the main thread
+        virtual void processDecoded(std::vector<DecodedImage> images, std::shared_ptr<void> keepAlive = {}) override {
+            std::lock_guard<std::mutex> lock(mutex);
+            for(auto& decodedImage: images){
+                pendingBytes += decodedImage.pixels.size();
+                imageQueue.push_back({std::move(decodedImage), keepAlive});
             }
         }
 
     private:
+        DecodePool& decoder;
+        std::shared_ptr<TexturePool> texturePool;
+        std::shared_ptr<TextureArray> textureArray;
+        bool useTextureArray = false;
+        int maxTextureSize = 0;
+        UploadScheduler scheduler; // main thread only
+        std::unique_ptr<PboUploadRing> ring; // declared before the queue, whose images may point into it
         std::mutex mutex;
-        std::deque<DecodedImage> imageQueue;
-        std::vector<GLuint> textures;
+        struct Queued {
+            DecodedImage image;
+            std::shared_ptr<void> keepAlive;
+        };
+        std::deque<Queued> imageQueue;
+        size_t pendingBytes = 0;
+        size_t assigned = 0; // entities given a texture of this batch, in entity order
 
 
-        void assignTextures(texgan::ecs::World& world) {
+        // A layer of the texture array when that mode is on and the image fits it, a pooled 2D texture otherwise
+        ecs::TextureComponent upload(const DecodedImage& decodedImage) {
+            if (useTextureArray) {
+                if (auto layer = generateGLTextureLayer(decodedImage, *textureArray, ring.get(), maxTextureSize)) {
+                    return {0, nullptr, layer};
+                }
+            }
+            auto texture = generateGLTexture(decodedImage, *texturePool, ring.get(), maxTextureSize);
+            return {texture ? *texture : 0, texture, nullptr, 0, decodedImage.cacheKey};
+        }
+
+        // Hands `uploaded` to the next entities of the batch. Only the entities hold on to the textures,
+        // so one they stop showing goes straight back to the pool.
+        void assignTextures(texgan::ecs::World& world, std::vector<ecs::TextureComponent> uploaded) {
             const auto& ents = world.getEntities();
             std::lock_guard<std::mutex> lock(mutex);
-            size_t count = std::min(textures.size(), ents.size());
-            for (size_t i = 0; i < count; ++i) {
-                if (auto* tc = world.getTexture(ents[i])) {
-                    tc->textureId = textures[i];
-                }
+            for (auto& texture : uploaded) {
+                if (assigned >= ents.size()) break;
+                if (auto* tc = world.getTexture(ents[assigned])) tc->assign(std::move(texture));
+                assigned++;
             }
         }
     };
 
+    // Uploads on loader threads, each owning a GL context shared with the main one for its whole life.
+    // Decoded images queue up for the loaders, which take them one at a time; each upload is followed by a
+    // fence, and the texture is handed to the render thread through a lock-free queue. The render thread
+    // only polls: it takes textures in the order their images were queued, each once its fence has
+    // signalled, so which loader finishes first never changes which entity gets which texture.
+    // More than one loader only pays off on drivers that upload from several contexts in parallel.
     class SharedContextUploadApproach : public TextureLoader{
     public:
-        SharedContextUploadApproach() = default;
+        static constexpr size_t kHandoffCapacity = 1024;
+        static constexpr size_t kMaxWorkers = 8;
+
+        SharedContextUploadApproach(DecodePool& decoder, std::shared_ptr<TexturePool> texturePool)
+            : m_decoder(decoder), m_texturePool(std::move(texturePool)), m_uploaded(kHandoffCapacity) {}
         ~SharedContextUploadApproach() override {
             cleanup();
         }
 
 
-        void initSharedContext(GLFWwindow* mainWindow) {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            if (m_sharedContextWindow) {
+        // Creates the shared contexts and starts a loader thread on each. Main thread, as GLFW requires.
+        void initSharedContext(GLFWwindow* mainWindow, size_t workerCount = 1) {
+            if (!m_workers.empty()) {
                 // already initialized
                 return;
             }
-            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
-            m_sharedContextWindow = glfwCreateWindow(1, 1, "Shared Context", nullptr, mainWindow);
-            if (!m_sharedContextWindow) {
-                throw std::runtime_error("Failed to create shared GLFW context");
-            }
+            m_mainWindow = mainWindow;
+            startWorkers(workerCount);
+        }
 
-            m_mainContextWindow = mainWindow;
+        // Restarts the loaders with `count` contexts. Images already queued are kept. Main thread; it
+        // waits for each loader to finish the image it is on.
+        void setWorkerCount(size_t count) {
+            if (!m_mainWindow || count == m_workers.size()) return;
+            stopWorkers();
+            startWorkers(count);
         }
 
+        size_t workerCount() const { return m_workers.size(); }
+
         
-        /// Clean up any GL resources or windows
+        // Stops the loaders and destroys their contexts. Main thread.
         virtual void cleanup() override {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            if(m_sharedContextWindow){
-                glfwDestroyWindow(m_sharedContextWindow);
-                m_sharedContextWindow = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_pending.clear();
             }
+            stopWorkers();
 
-            for(GLuint texture: m_textures) glDeleteTextures(1, &texture);
+            // Whatever was queued but dropped above will never arrive
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_expectedSequence = m_nextSequence;
+            }
+            for (auto& [sequence, uploaded] : m_ready) {
+                if (uploaded.fence) glDeleteSync(uploaded.fence);
+            }
+            m_ready.clear();
+            m_assigned = 0; // entities keep the textures they show
+        }
 
-            m_textures.clear();
+        virtual void startBatch() override {
+            // Uploads of the old batch still drain through update(), which discards them
+            m_batch++;
+            m_assigned = 0;
         }
 
 
-        /// Called on the main thread each frame to upload pending textures and assign them to entities
+        // Called on the main thread each frame: takes the textures whose uploads have completed and
+        // assigns them to entities. Never waits.
         virtual void update(texgan::ecs::World& world) override {
-            std::lock_guard<std::mutex> lock(m_mutex);
+            drainUploaded();
 
             const auto& ents = world.getEntities();
-            size_t count = std::min(m_textures.size(), ents.size());
-            for (size_t i = 0; i < count; ++i) {
-                if (auto* tc = world.getTexture(ents[i])) {
-                    tc->textureId = m_textures[i];
+            while (!m_ready.empty() && m_ready.begin()->first == m_expectedSequence) {
+                Uploaded& next = m_ready.begin()->second;
+                bool current = next.texture && next.batch == m_batch;
+                // Stale textures wait too: the pool's release fence lives in this context and would not
+                // cover an upload still running in a loader's, so another loader could reuse it mid-upload
+                if (next.fence && glClientWaitSync(next.fence, 0, 0) == GL_TIMEOUT_EXPIRED) break;
+                // Only the entities hold on to the textures, so one they stop showing goes back to the pool
+                if (current && m_assigned < ents.size()) {
+                    if (auto* tc = world.getTexture(ents[m_assigned])) {
+                        tc->assign({*next.texture, std::move(next.texture), nullptr, 0, std::move(next.source)});
+                    }
+                    m_assigned++;
                 }
+                if (next.fence) glDeleteSync(next.fence);
+                m_ready.erase(m_ready.begin());
+                m_expectedSequence++;
             }
         }
 
 
-        /// Called from the image-fetch callback (possibly worker thread) to enqueue or immediately upload
-        virtual void processImages(bool success, const Images& images) override {
+        // Called from the image-fetch callback (possibly worker thread) to hand the images to the decode pool
+        virtual void processImages(bool success, Images images, std::shared_ptr<void> keepAlive = {}) override {
             if (!success) return;
-            std::lock_guard<std::mutex> lock(m_mutex);
+            m_decoder.decode(std::move(images), [this, keepAlive](std::vector<DecodedImage> decoded) {
+                processDecoded(std::move(decoded), keepAlive);
+            });
+        }
 
-            if (!m_sharedContextWindow || !m_mainContextWindow){
-                std::cout << "shared context not initialized!\n";
-                return;
+        // Queues decoded images for the loaders, numbered in arrival order and tagged with the current batch
+        virtual void processDecoded(std::vector<DecodedImage> images, std::shared_ptr<void> keepAlive = {}) override {
+            if (images.empty()) return;
+            uint64_t batch = m_batch;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (auto& decodedImage : images) {
+                    m_pending.push_back({std::move(decodedImage), batch, m_nextSequence++, keepAlive});
+                }
             }
+            m_wake.notify_all();
+        }
 
+        // Largest texture edge to upload, 0 for full size. Mip levels above it are dropped.
+        void setMaxTextureSize(int size) { m_maxTextureSize = std::max(size, 0); }
 
-            // Make shared context current
-            glfwMakeContextCurrent(m_sharedContextWindow);
-            for (const auto& image : images) {
-                DecodedImage decodedImage;
-                if (!decodeImageToMemory(image, decodedImage)) {
-                    continue;
+    private:
+        struct Pending {
+            DecodedImage image;
+            uint64_t batch;
+            uint64_t sequence;
+            std::shared_ptr<void> keepAlive; // released once the loader is done with the image
+        };
+
+        // Every queued image comes back as one of these, with a null texture when it was skipped
+        struct Uploaded {
+            ecs::TextureRef texture;
+            GLsync fence = nullptr;
+            uint64_t batch = 0;
+            uint64_t sequence = 0;
+            std::string source; // texture cache key of the image
+        };
+
+        struct Worker {
+            GLFWwindow* window = nullptr;
+            std::thread thread;
+        };
+
+        void startWorkers(size_t count) {
+            count = std::clamp<size_t>(count, 1, kMaxWorkers);
+            m_stopping = false;
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            for (size_t i = 0; i < count; ++i) {
+                GLFWwindow* window = glfwCreateWindow(1, 1, "Shared Context", nullptr, m_mainWindow);
+                if (!window) {
+                    if (i == 0) throw std::runtime_error("Failed to create shared GLFW context");
+                    break; // run with the contexts we got
                 }
-                GLuint textureID = generateGLTexture(decodedImage);
-                if (textureID) {
-                    m_textures.push_back(textureID);
+                m_running++;
+                m_workers.push_back({window, std::thread([this, window]() { loaderLoop(window); })});
+            }
+        }
+
+        void stopWorkers() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopping = true;
+            }
+            m_wake.notify_all();
+            // A loader may be waiting for room in the handoff queue, which only this thread makes
+            while (m_running > 0) {
+                drainUploaded();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            drainUploaded();
+            for (auto& worker : m_workers) {
+                worker.thread.join();
+                glfwDestroyWindow(worker.window);
+            }
+            m_workers.clear();
+        }
+
+        void loaderLoop(GLFWwindow* window) {
+            glfwMakeContextCurrent(window);
+
+            while (true) {
+                Pending pending;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_wake.wait(lock, [this]() { return m_stopping || !m_pending.empty(); });
+                    if (m_stopping) break;
+                    pending = std::move(m_pending.front());
+                    m_pending.pop_front();
                 }
+
+                Uploaded uploaded{nullptr, nullptr, pending.batch, pending.sequence, pending.image.cacheKey};
+                // Images of a batch that has been replaced are not worth uploading
+                if (pending.batch == m_batch) {
+                    auto start = std::chrono::steady_clock::now();
+                    uploaded.texture = generateGLTexture(pending.image, *m_texturePool, nullptr, m_maxTextureSize);
+                    if (uploaded.texture) {
+                        uploaded.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                        // Another context waits on the fence, so it has to reach the GPU
+                        glFlush();
+                        monitoring::pipelineStats().upload.record(1, pending.image.pixels.size(), std::chrono::steady_clock::now() - start);
+                    }
+                }
+                publish(std::move(uploaded));
             }
-            // Restore main context
-            glfwMakeContextCurrent(m_mainContextWindow);
+
+            glfwMakeContextCurrent(nullptr);
+            m_running--;
         }
-    private:
+
+        // Hands an upload to the render thread, waiting while the queue is full
+        void publish(Uploaded uploaded) {
+            while (!m_uploaded.tryPush(std::move(uploaded))) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        // Main thread
+        void drainUploaded() {
+            Uploaded uploaded;
+            while (m_uploaded.tryPop(uploaded)) {
+                uint64_t sequence = uploaded.sequence;
+                m_ready.emplace(sequence, std::move(uploaded));
+            }
+        }
+
+        DecodePool& m_decoder;
+        GLFWwindow* m_mainWindow = nullptr;
+        std::shared_ptr<TexturePool> m_texturePool;
+        std::atomic<int> m_maxTextureSize{0};
+        std::atomic<uint64_t> m_batch{0};
+
+        // Decode threads -> loaders
         std::mutex m_mutex;
-        GLFWwindow* m_sharedContextWindow = nullptr;
-        GLFWwindow* m_mainContextWindow = nullptr;
-        std::vector<GLuint> m_textures;
+        std::condition_variable m_wake;
+        std::deque<Pending> m_pending;
+        uint64_t m_nextSequence = 0;
+        std::atomic<bool> m_stopping{false};
+        std::atomic<size_t> m_running{0};
+        std::vector<Worker> m_workers;
+
+        // Loaders -> render thread
+        aif::MpmcQueue<Uploaded> m_uploaded;
+
+        // Render thread only
+        std::map<uint64_t, Uploaded> m_ready; // by sequence, until their turn comes and the fence has signalled
+        uint64_t m_expectedSequence = 0;
+        size_t m_assigned = 0; // entities given a texture of this batch, in entity order
+    };
+
+    // Keeps the VRAM taken by textures, mip chains included, within a budget. The renderer stamps each
+    // entity's texture with the frame it was last drawn in; once the pool's free textures are gone and
+    // the total is still over budget, the least recently drawn textures that have not been drawn for a
+    // while are halved (their top level dropped, the rest copied into a smaller texture with
+    // glCopyImageSubData) and, once small, dropped altogether. Only textures whose pixels the texture
+    // cache holds are touched, so an entity drawn again gets its full-size texture back from disk as soon
+    // as the budget has room for it. Texture array layers are counted but never evicted.
+    // Main thread only, apart from cache reads on the decode pool.
+    class TextureResidency {
+    public:
+        static constexpr uint64_t kIdleFrames = 60; // frames without a draw before a texture may shrink
+        static constexpr GLsizei kMinSize = 32; // textures no larger than this are dropped instead of halved
+        static constexpr size_t kMaxReductionsPerFrame = 8;
+        static constexpr size_t kMaxRestoresInFlight = 4;
+
+        struct Stats {
+            size_t budget;
+            size_t residentBytes;
+            size_t evicted; // textures shown below their full size, or not at all
+            size_t restoring;
+            uint64_t halved;
+            uint64_t dropped;
+            uint64_t restored;
+            uint64_t trimmedBytes; // free pool textures deleted to stay within budget
+        };
+
+        TextureResidency(DecodePool& decoder, std::shared_ptr<TexturePool> texturePool,
+                         std::shared_ptr<TextureArray> textureArray, std::shared_ptr<TextureCache> textureCache)
+            : m_decoder(decoder), m_texturePool(std::move(texturePool)), m_textureArray(std::move(textureArray)),
+              m_textureCache(std::move(textureCache)), m_inbox(std::make_shared<Inbox>()) {}
+
+        // VRAM the textures may take, 0 for no limit
+        void setBudget(size_t bytes) { m_budget = bytes; }
+        size_t budget() const { return m_budget; }
+
+        // Called on the main thread each frame, after the scene was drawn: takes in restored textures,
+        // asks for the ones drawn this frame that are still reduced, and shrinks idle ones while over budget
+        void update(ecs::World& world) {
+            finishRestores(world);
+
+            uint64_t frame = rendering::currentFrame();
+            std::unordered_map<GLuint, Shown> shown;
+            std::unordered_set<std::string> sources;
+            for (auto entity : world.getEntities()) {
+                auto* tc = world.getTexture(entity);
+                if (!tc || tc->source.empty()) continue;
+                sources.insert(tc->source);
+                if (tc->texture) {
+                    auto& texture = shown[*tc->texture];
+                    texture.components.push_back(tc);
+                    texture.lastDrawnFrame = std::max(texture.lastDrawnFrame, tc->lastDrawnFrame);
+                }
+                if (tc->lastDrawnFrame == frame) restore(*tc);
+            }
+            // Entities showing the other entries were given textures of a new batch
+            std::erase_if(m_evicted, [&](const auto& entry) { return !entry.second.loading && !sources.count(entry.first); });
+
+            if (m_budget == 0) return;
+            size_t resident = residentBytes();
+            if (resident <= m_budget) return;
+            m_trimmedBytes += m_texturePool->trim(resident - m_budget);
+
+            std::vector<std::pair<uint64_t, GLuint>> idle;
+            for (const auto& [texture, entry] : shown) {
+                if (entry.lastDrawnFrame + kIdleFrames < frame) idle.push_back({entry.lastDrawnFrame, texture});
+            }
+            std::sort(idle.begin(), idle.end());
+
+            bool canCopy = GLEW_VERSION_4_3 || GLEW_ARB_copy_image;
+            size_t reductions = 0;
+            for (const auto& [lastDrawn, texture] : idle) {
+                if (reductions == kMaxReductionsPerFrame || residentBytes() <= m_budget) break;
+                auto format = m_texturePool->formatOf(texture);
+                if (!format) continue;
+                const auto& components = shown[texture].components;
+                m_evicted.try_emplace(components.front()->source, Evicted{*format});
+
+                if (canCopy && format->levels > 1 && std::max(format->width, format->height) > kMinSize) {
+                    ecs::TextureRef smaller = halve(texture, *format);
+                    for (auto* tc : components) {
+                        tc->textureId = *smaller;
+                        tc->texture = smaller;
+                    }
+                    m_halved++;
+                } else {
+                    // Drawn untextured until it is restored
+                    for (auto* tc : components) {
+                        tc->textureId = 0;
+                        tc->texture.reset();
+                    }
+                    m_dropped++;
+                }
+                reductions++;
+                // The replaced texture went back to the free list; it is not kept while over budget
+                size_t now = residentBytes();
+                if (now > m_budget) m_trimmedBytes += m_texturePool->trim(now - m_budget);
+            }
+        }
+
+        Stats stats() const {
+            return {m_budget, residentBytes(), m_evicted.size(), m_inFlight, m_halved, m_dropped, m_restored, m_trimmedBytes};
+        }
+
+    private:
+        struct Shown {
+            std::vector<ecs::TextureComponent*> components;
+            uint64_t lastDrawnFrame = 0;
+        };
+
+        struct Evicted {
+            TexturePool::Format full; // what the texture was uploaded as
+            bool loading = false;
+        };
+
+        // Cache reads finished on the decode pool, taken in by the next update()
+        struct Inbox {
+            std::mutex mutex;
+            std::vector<std::tuple<std::string, bool, DecodedImage>> loaded;
+        };
+
+        size_t residentBytes() const {
+            auto pool = m_texturePool->stats();
+            return pool.liveBytes + pool.freeBytes + m_textureArray->stats().bytes;
+        }
+
+        // Levels 1..n of `texture` copied into a new texture half its size
+        ecs::TextureRef halve(GLuint texture, const TexturePool::Format& format) {
+            TexturePool::Format half{std::max(1, format.width >> 1), std::max(1, format.height >> 1),
+                                     format.internalFormat, format.levels - 1};
+            ecs::TextureRef smaller = m_texturePool->acquire(half);
+            for (GLsizei level = 0; level < half.levels; ++level) {
+                glCopyImageSubData(texture, GL_TEXTURE_2D, level + 1, 0, 0, 0, *smaller, GL_TEXTURE_2D, level, 0, 0, 0,
+                                   mipSize(format.width, level + 1), mipSize(format.height, level + 1), 1);
+            }
+            return smaller;
+        }
+
+        // Reads the full-size pixels of an evicted texture back when the budget has room for them
+        void restore(const ecs::TextureComponent& tc) {
+            auto it = m_evicted.find(tc.source);
+            if (it == m_evicted.end() || it->second.loading || m_inFlight == kMaxRestoresInFlight) return;
+            if (m_budget > 0) {
+                auto current = tc.texture ? m_texturePool->formatOf(*tc.texture) : std::nullopt;
+                size_t freed = current ? TexturePool::bytesOf(*current) : 0;
+                if (residentBytes() - freed + TexturePool::bytesOf(it->second.full) > m_budget) return;
+            }
+
+            it->second.loading = true;
+            m_inFlight++;
+            m_decoder.loadCached(m_textureCache, tc.source, [inbox = m_inbox, key = tc.source](bool ok, DecodedImage image) {
+                std::lock_guard<std::mutex> lock(inbox->mutex);
+                inbox->loaded.emplace_back(key, ok, std::move(image));
+            });
+        }
+
+        void finishRestores(ecs::World& world) {
+            std::vector<std::tuple<std::string, bool, DecodedImage>> loaded;
+            {
+                std::lock_guard<std::mutex> lock(m_inbox->mutex);
+                loaded.swap(m_inbox->loaded);
+            }
+            for (auto& [key, ok, image] : loaded) {
+                m_inFlight--;
+                auto it = m_evicted.find(key);
+                if (it == m_evicted.end()) continue;
+                const auto full = it->second.full;
+                m_evicted.erase(it);
+
+                // Uploaded at the size it had, whatever the texture size setting is now
+                ecs::TextureRef texture = ok ? generateGLTexture(image, *m_texturePool, nullptr, std::max(full.width, full.height))
+                                             : nullptr;
+                for (auto entity : world.getEntities()) {
+                    auto* tc = world.getTexture(entity);
+                    if (!tc || tc->source != key) continue;
+                    if (texture) {
+                        tc->textureId = *texture;
+                        tc->texture = texture;
+                    } else {
+                        tc->source.clear(); // the cache lost it: what is shown now stays
+                    }
+                }
+                if (texture) m_restored++;
+            }
+        }
+
+        DecodePool& m_decoder;
+        std::shared_ptr<TexturePool> m_texturePool;
+        std::shared_ptr<TextureArray> m_textureArray;
+        std::shared_ptr<TextureCache> m_textureCache;
+        std::shared_ptr<Inbox> m_inbox;
+        size_t m_budget = 0;
+        std::unordered_map<std::string, Evicted> m_evicted; // by texture cache key
+        size_t m_inFlight = 0;
+        uint64_t m_halved = 0;
+        uint64_t m_dropped = 0;
+        uint64_t m_restored = 0;
+        uint64_t m_trimmedBytes = 0;
     };
 
 }
@@ -1517,11 +2765,26 @@ namespace texgan::ui{
 
             // Default to single-context approach
             useSingleContextApproach = true;
-            m_singleUploader = std::make_unique<texgan::loading::SingleContextUploadApproach>();
+            m_singleUploader = std::make_unique<texgan::loading::SingleContextUploadApproach>(m_decoder, m_texturePool, m_textureArray);
             // Prepare shared context approach ahead of time
-            m_sharedUploader = std::make_unique<texgan::loading::SharedContextUploadApproach>();
+            m_sharedUploader = std::make_unique<texgan::loading::SharedContextUploadApproach>(m_decoder, m_texturePool);
             m_sharedUploader->initSharedContext(m_window);
 
+            // Fetched payloads can be kept on disk and replayed offline
+            m_fetcher.enableDiskCache(texgan::utils::asset("cache/images"), IMAGE_CACHE_MAX_BYTES);
+            // and images seen before are loaded from their decoded form instead of being decoded again
+            m_textureCache = std::make_shared<texgan::loading::TextureCache>(texgan::utils::asset("cache/textures"), TEXTURE_CACHE_MAX_BYTES);
+            m_decoder.setTextureCache(m_textureCache);
+            // which is also where textures evicted to stay within the VRAM budget are restored from
+            m_residency = std::make_unique<texgan::loading::TextureResidency>(m_decoder, m_texturePool, m_textureArray, m_textureCache);
+
+            // Open connections to the provider before the first batch is requested
+            m_fetcher.warmUp(IMAGE_PROVIDER_URL, m_fetcher.workerCount());
+
+            // Decoded images kept ready for the next batch, refilled while idle once the user has asked for one
+            m_reservoir = std::make_unique<texgan::loading::DecodedImageReservoir>(
+                m_fetcher, m_decoder, m_mainThreadWork, IMAGE_PROVIDER_URL, RESERVOIR_TARGET, RESERVOIR_MAX_BYTES);
+
             float fontSize = 18.0f;
 
             io.Fonts->AddFontFromFileTTF(texgan::utils::asset("fonts/mont/MontserratBold-DOWZd.ttf").c_str(), 35.0f);
@@ -1542,6 +2805,18 @@ namespace texgan::ui{
         }
 
         ~TextureLoaderUI() {
+            // No fetch or decode may call into the uploaders once they are gone. The fetcher goes first:
+            // its last callbacks still hand images to the decoder, whose last callbacks reach the uploaders.
+            // Cancelling first aborts the batch and the reservoir's prefetches still on the wire; the warm-ups
+            // have no token and are aborted by shutdown() itself
+            m_batchToken.cancel();
+            m_reservoir->clear();
+            m_fetcher.shutdown();
+            // Continuations the fetcher posted since the last frame still need the decoder, which the
+            // executor's own destructor would run too late for
+            while (m_mainThreadWork.runPending() > 0) {}
+            m_decoder.shutdown();
+
             // Cleanup uploader resources
             if (m_singleUploader) {
                 m_singleUploader->cleanup();
@@ -1645,6 +2920,65 @@ namespace texgan::ui{
             static int count = 5;
             ImGui::SetNextItemWidth(ws.size.x / 2);
             ImGui::SliderInt("Texture Batch Size", &count, 1, 500, "%d textures");
+
+            // Worker pool size (downloads run concurrently across workers)
+            static int workerCount = static_cast<int>(m_fetcher.workerCount());
+            ImGui::SetNextItemWidth(ws.size.x / 2);
+            ImGui::SliderInt("Fetch Workers", &workerCount, 1, 64, "%d threads");
+            if (ImGui::IsItemDeactivatedAfterEdit()) {
+                m_fetcher.setWorkerCount(static_cast<size_t>(workerCount));
+            }
+
+            // Fetch engine: blocking worker pool vs. one multiplexed curl event loop
+            bool multiplexed = m_fetcher.engine() == aif::ImageFetcher::Engine::Multiplexed;
+            if (ImGui::RadioButton("Thread Pool", !multiplexed)) {
+                m_fetcher.setEngine(aif::ImageFetcher::Engine::ThreadPool);
+            }
+            ImGui::SameLine();
+            if (ImGui::RadioButton("Multiplexed", multiplexed)) {
+                m_fetcher.setEngine(aif::ImageFetcher::Engine::Multiplexed);
+            }
+
+            static int maxInFlight = static_cast<int>(m_fetcher.maxInFlight());
+            ImGui::SetNextItemWidth(ws.size.x / 2);
+            ImGui::BeginDisabled(!multiplexed);
+            if (ImGui::SliderInt("Max In-Flight", &maxInFlight, 1, 500, "%d requests")) {
+                m_fetcher.setMaxInFlight(static_cast<size_t>(maxInFlight));
+            }
+            ImGui::EndDisabled();
+
+            // Adaptive flow control: back off when the provider throttles, retry with jittered backoff
+            bool adaptive = m_fetcher.adaptive();
+            if (ImGui::Checkbox("Adaptive Concurrency", &adaptive)) {
+                m_fetcher.setAdaptive(adaptive);
+            }
+            static float rateLimit = static_cast<float>(m_fetcher.rateLimit());
+            ImGui::SetNextItemWidth(ws.size.x / 2);
+            if (ImGui::SliderFloat("Rate Limit", &rateLimit, 0.0f, 100.0f, rateLimit > 0.0f ? "%.0f req/s" : "off")) {
+                m_fetcher.setRateLimit(rateLimit, std::max(1.0f, rateLimit / 4.0f));
+            }
+            auto flow = m_fetcher.flowStats();
+            if (adaptive) {
+                ImGui::TextDisabled("%zu/%zu in flight, %.0f ms", flow.inFlight, flow.concurrencyLimit, flow.latencyMs);
+            } else {
+                ImGui::TextDisabled("%zu in flight, %.0f ms", flow.inFlight, flow.latencyMs);
+            }
+            ImGui::TextDisabled("%zu waiting, %zu throttled, %zu retries", flow.delayed, flow.throttled, flow.retries);
+
+            // Disk cache: store downloads, or replay stored images without the network
+            using CacheMode = aif::ImageFetcher::CacheMode;
+            CacheMode cacheMode = m_fetcher.cacheMode();
+            ImGui::Text("Disk Cache:");
+            ImGui::SameLine();
+            if (ImGui::RadioButton("Off##cache", cacheMode == CacheMode::Off)) m_fetcher.setCacheMode(CacheMode::Off);
+            ImGui::SameLine();
+            if (ImGui::RadioButton("Store", cacheMode == CacheMode::WriteThrough)) m_fetcher.setCacheMode(CacheMode::WriteThrough);
+            ImGui::SameLine();
+            if (ImGui::RadioButton("Replay", cacheMode == CacheMode::Replay)) m_fetcher.setCacheMode(CacheMode::Replay);
+            if (const auto* cache = m_fetcher.diskCache()) {
+                ImGui::TextDisabled("%zu images, %.1f / %.0f MB", cache->entryCount(),
+                                    cache->totalBytes() / (1024.0 * 1024.0), cache->maxBytes() / (1024.0 * 1024.0));
+            }
             ImGui::Spacing();
 
             // Context mode selector using radio buttons
@@ -1673,33 +3007,202 @@ namespace texgan::ui{
             }
             ImGui::EndGroup();
 
+            // Single context: how much of each frame may go to uploads (leftovers wait for later frames)
+            static float uploadBudget = static_cast<float>(m_singleUploader->uploadScheduler().budget().millis);
+            ImGui::SetNextItemWidth(ws.size.x / 2);
+            ImGui::BeginDisabled(!useSingleContextApproach);
+            if (ImGui::SliderFloat("Upload Budget", &uploadBudget, 0.0f, 16.0f, uploadBudget > 0.0f ? "%.1f ms/frame" : "off")) {
+                texgan::loading::UploadBudget budget = m_singleUploader->uploadScheduler().budget();
+                budget.millis = uploadBudget;
+                m_singleUploader->uploadScheduler().setBudget(budget);
+            }
+            ImGui::EndDisabled();
+
+            // Decode straight into a persistently mapped pixel buffer ring (GL 4.4 / ARB_buffer_storage)
+            auto& ring = m_singleUploader->uploadRing();
+            bool useRing = ring.enabled();
+            ImGui::BeginDisabled(!useSingleContextApproach || !ring.available());
+            if (ImGui::Checkbox("PBO Upload Ring", &useRing)) {
+                ring.setEnabled(useRing);
+            }
+            ImGui::EndDisabled();
+            if (!ring.available()) {
+                ImGui::SameLine();
+                ImGui::TextDisabled("(no persistent mapping)");
+            }
+
+            // Same-sized images become layers of one texture array, drawn with a single bind
+            bool useArray = m_singleUploader->usesTextureArray();
+            ImGui::BeginDisabled(!useSingleContextApproach);
+            if (ImGui::Checkbox("Texture Array", &useArray)) {
+                m_singleUploader->setUseTextureArray(useArray);
+            }
+            ImGui::EndDisabled();
+
+            // Shared context: loader threads, each uploading through its own context
+            static int uploadWorkers = static_cast<int>(m_sharedUploader->workerCount());
+            ImGui::SetNextItemWidth(ws.size.x / 2);
+            ImGui::BeginDisabled(useSingleContextApproach);
+            ImGui::SliderInt("Upload Workers", &uploadWorkers, 1, static_cast<int>(texgan::loading::SharedContextUploadApproach::kMaxWorkers), "%d contexts");
+            if (ImGui::IsItemDeactivatedAfterEdit()) {
+                m_sharedUploader->setWorkerCount(static_cast<size_t>(uploadWorkers));
+                uploadWorkers = static_cast<int>(m_sharedUploader->workerCount());
+            }
+            ImGui::EndDisabled();
+
             ImGui::Spacing();
             ImGui::Separator();
             ImGui::Spacing();
 
             // Download action with visual feedback
-            static bool isLoading = false;
+            static std::atomic<bool> isLoading = false;
+            static std::atomic<int> arrived = 0;
+            static std::atomic<int> lastFailed = -1;
+            // Decode size: JPEGs larger than this are decoded at 1/2, 1/4 or 1/8 scale
+            static const int decodeSizes[] = {0, 1024, 512, 256, 128};
+            static int decodeSize = 0;
+            ImGui::SetNextItemWidth(ws.size.x / 2);
+            if (ImGui::Combo("Decode Size", &decodeSize, "Full\0" "1024 px\0" "512 px\0" "256 px\0" "128 px\0")) {
+                m_decoder.setTargetSize(decodeSizes[decodeSize]);
+            }
+            // Mip chains built on the decode threads; with them, levels above the texture size are never uploaded.
+            // On by default: copying a chain into the write-only upload ring costs a decode thread well under a
+            // millisecond, while glGenerateMipmap would cost the GL thread every frame that uploads.
+            bool cpuMipmaps = m_decoder.mipmaps();
+            if (ImGui::Checkbox("CPU Mipmaps", &cpuMipmaps)) {
+                m_decoder.setMipmaps(cpuMipmaps);
+            }
+            ImGui::SameLine();
+            static int textureSize = 0;
+            bool compressing = m_decoder.compression() != texgan::loading::CompressionPreset::Off;
+            ImGui::SetNextItemWidth(ws.size.x / 4);
+            ImGui::BeginDisabled(!cpuMipmaps && !compressing);
+            if (ImGui::Combo("Texture Size", &textureSize, "Full\0" "1024 px\0" "512 px\0" "256 px\0" "128 px\0")) {
+                m_singleUploader->setMaxTextureSize(decodeSizes[textureSize]);
+                m_sharedUploader->setMaxTextureSize(decodeSizes[textureSize]);
+            }
+            ImGui::EndDisabled();
+            // BC1 blocks encoded on the decode threads: an eighth of the VRAM and upload bytes of RGBA
+            static int compression = 0;
+            bool s3tc = GLEW_EXT_texture_compression_s3tc;
+            ImGui::SetNextItemWidth(ws.size.x / 2);
+            ImGui::BeginDisabled(!s3tc);
+            if (ImGui::Combo("Compression", &compression, "Off\0" "BC1 Fast\0" "BC1 Quality\0")) {
+                m_decoder.setCompression(static_cast<texgan::loading::CompressionPreset>(compression));
+            }
+            ImGui::EndDisabled();
+            if (!s3tc) {
+                ImGui::SameLine();
+                ImGui::TextDisabled("(no S3TC)");
+            }
+            // Images seen before skip decoding: their pixels are read back from the texture cache
+            bool textureCache = m_decoder.usesTextureCache();
+            if (ImGui::Checkbox("Texture Cache", &textureCache)) {
+                m_decoder.setTextureCache(textureCache ? m_textureCache : nullptr);
+            }
+            // Idle textures shrink while VRAM is over budget; only cached ones, which can be restored
+            static int budgetMegabytes = 0;
+            ImGui::SetNextItemWidth(ws.size.x / 2);
+            if (ImGui::SliderInt("VRAM Budget", &budgetMegabytes, 0, 4096, budgetMegabytes == 0 ? "off" : "%d MB")) {
+                m_residency->setBudget(static_cast<size_t>(budgetMegabytes) << 20);
+            }
+            // Prefetch reservoir: decoded images waiting for the next click
+            static int reservoirTarget = static_cast<int>(m_reservoir->target());
+            ImGui::SetNextItemWidth(ws.size.x / 2);
+            if (ImGui::SliderInt("Prefetch", &reservoirTarget, 0, 500, "%d images")) {
+                m_reservoir->setTarget(static_cast<size_t>(reservoirTarget));
+                m_reservoir->arm(); // choosing a size opts in before the first batch
+            }
+            {
+                size_t ready = m_reservoir->size();
+                size_t target = std::max<size_t>(m_reservoir->target(), 1);
+                char overlay[64];
+                std::snprintf(overlay, sizeof(overlay), "%zu ready, %.0f MB", ready, m_reservoir->bytes() / (1024.0 * 1024.0));
+                ImGui::ProgressBar(std::min(1.0f, static_cast<float>(ready) / target), ImVec2(ws.size.x / 2, 0), overlay);
+                ImGui::SameLine();
+                ImGui::Text("%.0f%% hits", m_reservoir->hitRate() * 100.0);
+            }
+            ImGui::Spacing();
+
             if (isLoading) {
-                ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.9f, 1.0f), "Downloading %d textures...", count);
+                ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.9f, 1.0f), "Downloading %d/%d textures...", arrived.load(), count);
+                ImGui::SameLine();
+                if (ImGui::SmallButton("Cancel")) {
+                    m_batchToken.cancel();
+                }
             } else {
+                // Refill only while idle so prefetching never competes with a batch
+                m_reservoir->refill();
+
                 if (ImGui::Button("Download Textures", ImVec2(ws.size.x - 30, 40))) {
-                    isLoading = true;
+                    // From now on the reservoir keeps the next batch ready
+                    m_reservoir->arm();
                     m_fpsLogger = std::make_unique<texgan::monitoring::FPSLogger>(useSingleContextApproach ? "single" : "shared", count); 
-                    m_fetcher.fetchMany(count, IMAGE_PROVIDER_URL,
-                        [this](bool success, const Images& images) {
-                            if (useSingleContextApproach) {
-                                m_singleUploader->processImages(success, images);
-                            } else {
-                                m_sharedUploader->processImages(success, images);
+                    m_singleUploader->uploadScheduler().resetStats();
+                    // The new batch replaces the textures on screen; the old ones go back to the pool
+                    m_singleUploader->startBatch();
+                    m_sharedUploader->startBatch();
+
+                    // Serve what we can from the reservoir right away
+                    auto prefetched = m_reservoir->take(static_cast<size_t>(count));
+                    int missing = count - static_cast<int>(prefetched.size());
+                    if (useSingleContextApproach) {
+                        m_singleUploader->processDecoded(std::move(prefetched));
+                    } else {
+                        m_sharedUploader->processDecoded(std::move(prefetched));
+                    }
+
+                    isLoading = missing > 0;
+                    arrived = count - missing;
+                    if (missing > 0) {
+                        // Images are decoded and uploaded as they arrive; a slot of the window is freed
+                        // (and the next download started) once its item has been processed
+                        aif::StreamOptions options;
+                        options.window = FETCH_STREAM_WINDOW;
+                        options.deliverEvery = FETCH_STREAM_GROUP;
+                        options.priority = aif::Priority::Visible;
+                        m_batchToken = m_fetcher.fetchStream(missing, IMAGE_PROVIDER_URL, options,
+                            [this](std::vector<aif::BatchItem> items) {
+                                Images images;
+                                size_t bytes = 0;
+                                for (auto& item : items) {
+                                    if (item.success) {
+                                        bytes += item.data.size();
+                                        images.push_back(item.data);
+                                    }
+                                }
+                                arrived += static_cast<int>(items.size());
+                                monitoring::pipelineStats().fetch.record(images.size(), bytes);
+
+                                // The items' credits travel with the images until they are uploaded, so the
+                                // stream window bounds how many wait for the decoder or the uploader
+                                auto credits = std::make_shared<std::vector<aif::BatchItem>>(std::move(items));
+                                bool any = !images.empty();
+                                if (useSingleContextApproach) {
+                                    m_singleUploader->processImages(any, std::move(images), credits);
+                                } else {
+                                    m_sharedUploader->processImages(any, std::move(images), credits);
+                                }
+                            },
+                            [](const aif::BatchReport& report) {
+                                for (size_t i = 0; i < report.items.size(); ++i) {
+                                    if (!report.items[i].success && report.items[i].error != aif::kCancelledMessage) {
+                                        std::cerr << "Texture " << i << " failed: " << report.items[i].error << std::endl;
+                                    }
+                                }
+                                lastFailed = static_cast<int>(report.failed());
+                                isLoading = false;
                             }
-                            isLoading = false;
-                        }
-                    );
+                        );
+                    }
                 }
                 
                 // Help marker
                 ImGui::SameLine();
             }
+            if (lastFailed > 0) {
+                ImGui::TextColored(ImVec4(0.9f, 0.5f, 0.4f, 1.0f), "Last batch: %d failed", lastFailed.load());
+            }
 
             ImGui::End();
             WindowStyle::resetStyles();
@@ -1781,7 +3284,7 @@ namespace texgan::ui{
             int texturedCount   = 0;
             for (const auto& e : entities) {
                 auto tex = m_world.getTexture(e);
-                if (tex && tex->textureId != 0)
+                if (tex && tex->textured())
                     ++texturedCount;
             }
 
@@ -1843,7 +3346,7 @@ namespace texgan::ui{
             ImGui::Begin("Performance Metrics", nullptr, ws.window.flags);
             ImGui::PopStyleColor();
 
-            float colW = (ws.size.x - 40.0f) / 3.0f;
+            float colW = (ws.size.x - 50.0f) / 4.0f;
 
             // FPS column
             ImGui::BeginChild("FPS", ImVec2(colW,0), true);
@@ -1858,6 +3361,9 @@ namespace texgan::ui{
             ImGui::BeginChild("FrameTime", ImVec2(colW,0), true);
             ImGui::TextColored(ImVec4(1,0.5f,0.2f,1), "Frame Time");
             ImGui::Text("%.2f ms", frameTimeHistory.back());
+            ImGui::SameLine();
+            auto frame = texgan::rendering::frameStats();
+            ImGui::TextDisabled("%zu draws, %zu binds, %zu culled", frame.drawCalls, frame.textureBinds, frame.culled);
             ImGui::PlotLines("##ft", frameTimeHistory.data(), frameTimeHistory.size(), 0, nullptr, 0.0f, 50.0f, ImVec2(colW-20,80));
             ImGui::EndChild();
 
@@ -1870,6 +3376,81 @@ namespace texgan::ui{
             ImGui::PlotLines("##mem", memoryHistory.data(), memoryHistory.size(), 0, nullptr, 0.0f, FLT_MAX, ImVec2(colW-20,80));
             ImGui::EndChild();
 
+            ImGui::SameLine();
+
+            // Loading pipeline column: throughput of each stage over the last second
+            {
+                struct StageRate { uint64_t lastItems = 0; uint64_t lastBytes = 0; float perSecond = 0; float mbPerSecond = 0; };
+                static std::array<StageRate, 3> rates{};
+                static float lastSample = now;
+
+                auto& stats = texgan::monitoring::pipelineStats();
+                const texgan::monitoring::StageStats* stages[3] = {&stats.fetch, &stats.decode, &stats.upload};
+                if (now - lastSample >= 1.0f) {
+                    float elapsed = now - lastSample;
+                    for (size_t i = 0; i < rates.size(); ++i) {
+                        uint64_t items = stages[i]->items, bytes = stages[i]->bytes;
+                        rates[i].perSecond = (items - rates[i].lastItems) / elapsed;
+                        rates[i].mbPerSecond = (bytes - rates[i].lastBytes) / elapsed / (1024.0f * 1024.0f);
+                        rates[i].lastItems = items;
+                        rates[i].lastBytes = bytes;
+                    }
+                    lastSample = now;
+                }
+
+                ImGui::BeginChild("Pipeline", ImVec2(colW,0), true);
+                ImGui::TextColored(ImVec4(0.9f,0.8f,0.2f,1), "Loading Pipeline");
+                ImGui::Text("Fetch   %5.1f img/s %6.1f MB/s", rates[0].perSecond, rates[0].mbPerSecond);
+                ImGui::Text("Decode  %5.1f img/s %6.1f ms/img (%zu threads)", rates[1].perSecond, stats.decode.millisPerItem(), m_decoder.threadCount());
+                ImGui::Text("Upload  %5.1f img/s %6.1f ms/img", rates[2].perSecond, stats.upload.millisPerItem());
+                for (const auto& codec : texgan::loading::defaultCodecs().stats()) {
+                    ImGui::TextDisabled("  %-13s %6.1f ms/img (%llu)", codec.name.c_str(), codec.millisPerImage,
+                                        static_cast<unsigned long long>(codec.decoded));
+                }
+                if (useSingleContextApproach) {
+                    auto uploads = m_singleUploader->uploadScheduler().stats();
+                    ImGui::Text("Queue   %5zu img %6zu frames to drain", uploads.pending, uploads.framesToDrain);
+                    ImGui::TextDisabled("  worst %.1f ms/frame, last drain %zu frames", uploads.worstFrameMillis, uploads.lastDrainFrames);
+                    auto ring = m_singleUploader->uploadRing().stats();
+                    if (ring.capacity > 0) {
+                        ImGui::TextDisabled("  ring %.0f/%.0f MB, %llu fallbacks", ring.usedBytes / (1024.0 * 1024.0),
+                                            ring.capacity / (1024.0 * 1024.0), static_cast<unsigned long long>(ring.fallbacks));
+                    }
+                }
+                if (m_singleUploader->usesTextureArray()) {
+                    auto layers = m_textureArray->stats();
+                    ImGui::Text("Array   %4zu/%zu layers %6.0f MB", layers.live, layers.capacity, layers.bytes / (1024.0 * 1024.0));
+                    ImGui::TextDisabled("  grown %llu times", static_cast<unsigned long long>(layers.grows));
+                }
+                auto textures = m_texturePool->stats();
+                ImGui::Text("Textures %4zu live %4zu free %6.0f MB", textures.live, textures.free,
+                            (textures.liveBytes + textures.freeBytes) / (1024.0 * 1024.0));
+                ImGui::TextDisabled("  %llu created, %llu reused", static_cast<unsigned long long>(textures.created),
+                                    static_cast<unsigned long long>(textures.reused));
+                if (m_decoder.usesTextureCache()) {
+                    auto cache = m_textureCache->stats();
+                    ImGui::Text("Cache   %5llu hits %5llu misses", static_cast<unsigned long long>(cache.hits),
+                                static_cast<unsigned long long>(cache.misses));
+                    ImGui::TextDisabled("  %zu textures, %.0f MB on disk, %.0f MB read", cache.entries,
+                                        cache.totalBytes / (1024.0 * 1024.0), cache.bytesRead / (1024.0 * 1024.0));
+                }
+                auto residency = m_residency->stats();
+                if (residency.budget > 0 || residency.evicted > 0) {
+                    ImGui::Text("VRAM    %5.0f/%.0f MB %4zu evicted", residency.residentBytes / (1024.0 * 1024.0),
+                                residency.budget / (1024.0 * 1024.0), residency.evicted);
+                    ImGui::TextDisabled("  %llu halved, %llu dropped, %llu restored, %.0f MB trimmed",
+                                        static_cast<unsigned long long>(residency.halved),
+                                        static_cast<unsigned long long>(residency.dropped),
+                                        static_cast<unsigned long long>(residency.restored),
+                                        residency.trimmedBytes / (1024.0 * 1024.0));
+                }
+                auto pool = texgan::loading::PixelBufferPool::shared().stats();
+                double served = static_cast<double>(pool.allocations + pool.reuses);
+                ImGui::Text("Pixel pool %5.0f MB free %5.0f%% reused", pool.retainedBytes / (1024.0 * 1024.0),
+                            served > 0 ? pool.reuses * 100.0 / served : 0.0);
+                ImGui::EndChild();
+            }
+
             ImGui::End();
             ImGui::PopStyleColor();
             WindowStyle::resetStyles();
@@ -2053,6 +3634,7 @@ namespace texgan::ui{
         ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(1, 0, 0, 1));
         ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1, 1, 1, 1));
         if (ImGui::Button("Clear All", ImVec2(buttonWidth, 40))) {
+            m_batchToken.cancel(); // stop downloading textures for entities that are gone
             m_world.clear();
         }
         ImGui::PopStyleColor(2);
@@ -2061,6 +3643,12 @@ namespace texgan::ui{
         WindowStyle::resetStyles();
     }
         
+        // Call this once per frame at the start of the main loop: resumes the coroutines whose awaits
+        // completed since the last frame, e.g. reservoir refills handing their fetched images to the decoder
+        void runMainThreadWork() {
+            m_mainThreadWork.runPending();
+        }
+
         // Call this once per frame in your main loop, after polling events but before 3D rendering:
         void render() {
             // Start ImGui frame
@@ -2098,7 +3686,7 @@ namespace texgan::ui{
 
             static WindowStyle tlWindowStyle;
             tlWindowStyle.position = {0, infoWindowStyle.size.y + infoWindowStyle.position.y };
-            tlWindowStyle.size = {350, 280};
+            tlWindowStyle.size = {350, 835};
             tlWindowStyle.window.flags = ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoScrollbar;
             showTextureLoaderControls(tlWindowStyle);
 
@@ -2132,6 +3720,8 @@ namespace texgan::ui{
 
             // Each frame, call update on the active uploader
             useSingleContextApproach ? m_singleUploader->update(m_world) : m_sharedUploader->update(m_world);
+            m_residency->update(m_world);
+            m_texturePool->collect();
 
 
             
@@ -2159,13 +3749,21 @@ namespace texgan::ui{
 
 
         texgan::core::Camera& m_camera;
+        aif::FrameExecutor m_mainThreadWork; // where coroutines continue on the main thread, see runMainThreadWork()
+        texgan::loading::DecodePool m_decoder; // outlives the fetcher, which feeds it
         aif::ImageFetcher m_fetcher;
+        aif::CancelToken m_batchToken; // current download batch
+        std::unique_ptr<texgan::loading::DecodedImageReservoir> m_reservoir;
 
         std::unique_ptr<monitoring::FPSLogger> m_fpsLogger;
 
         bool useSingleContextApproach;
+        std::shared_ptr<texgan::loading::TexturePool> m_texturePool = texgan::loading::TexturePool::create();
+        std::shared_ptr<texgan::loading::TextureArray> m_textureArray = texgan::loading::TextureArray::create();
+        std::shared_ptr<texgan::loading::TextureCache> m_textureCache;
         std::unique_ptr<texgan::loading::SingleContextUploadApproach> m_singleUploader;
         std::unique_ptr<texgan::loading::SharedContextUploadApproach> m_sharedUploader;
+        std::unique_ptr<texgan::loading::TextureResidency> m_residency;
         GLuint myImage{};
 
         ImVec4 m_viewport{};
@@ -2216,6 +3814,8 @@ void startApplication(){
     auto shader = renderer.m_defaultShader;
 
     while (!window.shouldClose()) {
+        ui.runMainThreadWork();
+
         // Update Camera controller
         cameraController.update();
 
@@ -2251,7 +3851,7 @@ void startApplication(){
         
         
         // Render scene
-        renderer.render(world);
+        renderer.render(world, camera.getProjectionMatrix(aspectRatio) * camera.getViewMatrix());
         
         ui.render();
         
@@ -0,0 +1,299 @@
+#include "BlockCompression.h"
+#include "MipChain.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace texgan::loading{
+    namespace {
+        struct Block {
+            int pixels[16][3];
+        };
+
+        // Weight of endpoint 0 for each index; endpoint 1 gets the rest
+        constexpr float kIndexWeights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+
+        void loadBlock(const std::uint8_t* src, int width, int height, int channels, int blockX, int blockY,
+                       Block& block) {
+            for (int y = 0; y < 4; ++y) {
+                int row = std::min(blockY * 4 + y, height - 1);
+                for (int x = 0; x < 4; ++x) {
+                    int column = std::min(blockX * 4 + x, width - 1);
+                    const std::uint8_t* pixel = src + (static_cast<std::size_t>(row) * width + column) * channels;
+                    for (int c = 0; c < 3; ++c) block.pixels[y * 4 + x][c] = pixel[c];
+                }
+            }
+        }
+
+        std::uint16_t pack565(const int color[3]) {
+            auto quantize = [](int value, int max) { return (std::clamp(value, 0, 255) * max + 127) / 255; };
+            return static_cast<std::uint16_t>((quantize(color[0], 31) << 11) | (quantize(color[1], 63) << 5) |
+                                              quantize(color[2], 31));
+        }
+
+        std::uint16_t pack565(const float color[3]) {
+            auto quantize = [](float value, int max) {
+                int q = static_cast<int>(std::lround(std::clamp(value, 0.0f, 255.0f) * max / 255.0f));
+                return std::clamp(q, 0, max);
+            };
+            return static_cast<std::uint16_t>((quantize(color[0], 31) << 11) | (quantize(color[1], 63) << 5) |
+                                              quantize(color[2], 31));
+        }
+
+        template <typename T>
+        void unpack565(std::uint16_t packed, T color[3]) {
+            int r = (packed >> 11) & 31;
+            int g = (packed >> 5) & 63;
+            int b = packed & 31;
+            color[0] = static_cast<T>((r << 3) | (r >> 2));
+            color[1] = static_cast<T>((g << 2) | (g >> 4));
+            color[2] = static_cast<T>((b << 3) | (b >> 2));
+        }
+
+        struct Encoded {
+            std::uint16_t color0;
+            std::uint16_t color1;
+            std::uint32_t indices;
+            float error;
+        };
+
+        // Orders the endpoints for four-colour mode and picks the nearest palette entry for each pixel
+        Encoded assignIndices(const Block& block, std::uint16_t color0, std::uint16_t color1) {
+            if (color0 < color1) std::swap(color0, color1);
+            Encoded encoded{color0, color1, 0, 0.0f};
+
+            float palette[4][3];
+            unpack565(color0, palette[0]);
+            unpack565(color1, palette[1]);
+            for (int c = 0; c < 3; ++c) {
+                palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+                palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+            }
+            // Equal endpoints mean three-colour mode, where only index 0 is safe
+            int choices = color0 == color1 ? 1 : 4;
+
+            for (int i = 0; i < 16; ++i) {
+                int best = 0;
+                float bestError = 1e30f;
+                for (int p = 0; p < choices; ++p) {
+                    float dr = block.pixels[i][0] - palette[p][0];
+                    float dg = block.pixels[i][1] - palette[p][1];
+                    float db = block.pixels[i][2] - palette[p][2];
+                    float error = dr * dr + dg * dg + db * db;
+                    if (error < bestError) {
+                        bestError = error;
+                        best = p;
+                    }
+                }
+                encoded.indices |= static_cast<std::uint32_t>(best) << (2 * i);
+                encoded.error += bestError;
+            }
+            return encoded;
+        }
+
+        // Endpoints that best reproduce the block with the indices of `encoded`, by least squares
+        bool refineEndpoints(const Block& block, const Encoded& encoded, float endpoint0[3], float endpoint1[3]) {
+            float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+            float ax[3] = {}, bx[3] = {};
+            for (int i = 0; i < 16; ++i) {
+                float a = kIndexWeights[(encoded.indices >> (2 * i)) & 3];
+                float b = 1.0f - a;
+                aa += a * a;
+                ab += a * b;
+                bb += b * b;
+                for (int c = 0; c < 3; ++c) {
+                    ax[c] += a * block.pixels[i][c];
+                    bx[c] += b * block.pixels[i][c];
+                }
+            }
+            float determinant = aa * bb - ab * ab;
+            if (std::fabs(determinant) < 1e-6f) return false;
+            for (int c = 0; c < 3; ++c) {
+                endpoint0[c] = (ax[c] * bb - bx[c] * ab) / determinant;
+                endpoint1[c] = (bx[c] * aa - ax[c] * ab) / determinant;
+            }
+            return true;
+        }
+
+        // Bounding box corners, taking the diagonal along which the channels vary together. Integer
+        // only, with each pixel's index read off its position along the line between the endpoints.
+        Encoded encodeFast(const Block& block) {
+            int low[3] = {255, 255, 255};
+            int high[3] = {0, 0, 0};
+            int sum[3] = {};
+            for (const auto& pixel : block.pixels) {
+                for (int c = 0; c < 3; ++c) {
+                    low[c] = std::min(low[c], pixel[c]);
+                    high[c] = std::max(high[c], pixel[c]);
+                    sum[c] += pixel[c];
+                }
+            }
+            // Red and blue against green, which carries most of the luminance
+            for (int c : {0, 2}) {
+                int covariance = 0;
+                for (const auto& pixel : block.pixels) covariance += (16 * pixel[c] - sum[c]) * (16 * pixel[1] - sum[1]);
+                if (covariance < 0) std::swap(low[c], high[c]);
+            }
+            // Pull the corners in a little: the extremes are rarely worth a whole palette entry
+            for (int c = 0; c < 3; ++c) {
+                int inset = (high[c] - low[c]) / 16;
+                high[c] -= inset;
+                low[c] += inset;
+            }
+
+            std::uint16_t color0 = pack565(high);
+            std::uint16_t color1 = pack565(low);
+            if (color0 < color1) std::swap(color0, color1);
+            Encoded encoded{color0, color1, 0, 0.0f};
+            if (color0 == color1) return encoded;
+
+            int end0[3], end1[3], axis[3];
+            unpack565(color0, end0);
+            unpack565(color1, end1);
+            for (int c = 0; c < 3; ++c) axis[c] = end0[c] - end1[c];
+            int length = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+            // Position 0..3 from endpoint 1 to endpoint 0, and the index of the palette entry there
+            static constexpr std::uint32_t kIndexAt[4] = {1, 3, 2, 0};
+            for (int i = 0; i < 16; ++i) {
+                int t = 0;
+                for (int c = 0; c < 3; ++c) t += (block.pixels[i][c] - end1[c]) * axis[c];
+                // round(3 * t / length), clamped to 0..3, without a division per pixel
+                int position = (6 * t >= length) + (6 * t >= 3 * length) + (6 * t >= 5 * length);
+                encoded.indices |= kIndexAt[position] << (2 * i);
+            }
+            return encoded;
+        }
+
+        // Endpoints on the block's principal axis (or the bounding box, if closer), then two rounds of
+        // least-squares refinement
+        Encoded encodeQuality(const Block& block) {
+            float mean[3] = {};
+            for (const auto& pixel : block.pixels) {
+                for (int c = 0; c < 3; ++c) mean[c] += static_cast<float>(pixel[c]) / 16.0f;
+            }
+            float covariance[6] = {}; // rr rg rb gg gb bb
+            for (const auto& pixel : block.pixels) {
+                float r = pixel[0] - mean[0], g = pixel[1] - mean[1], b = pixel[2] - mean[2];
+                covariance[0] += r * r;
+                covariance[1] += r * g;
+                covariance[2] += r * b;
+                covariance[3] += g * g;
+                covariance[4] += g * b;
+                covariance[5] += b * b;
+            }
+
+            // Power iteration converges quickly on the dominant eigenvector of a 3x3 matrix
+            float axis[3] = {1.0f, 1.0f, 1.0f};
+            for (int iteration = 0; iteration < 8; ++iteration) {
+                float next[3] = {
+                    covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+                    covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+                    covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2],
+                };
+                float length = std::max({std::fabs(next[0]), std::fabs(next[1]), std::fabs(next[2])});
+                if (length < 1e-6f) break; // flat block: any axis will do
+                for (int c = 0; c < 3; ++c) axis[c] = next[c] / length;
+            }
+
+            float lowest = 1e30f, highest = -1e30f;
+            for (const auto& pixel : block.pixels) {
+                float t = (pixel[0] - mean[0]) * axis[0] + (pixel[1] - mean[1]) * axis[1] + (pixel[2] - mean[2]) * axis[2];
+                lowest = std::min(lowest, t);
+                highest = std::max(highest, t);
+            }
+            float lengthSquared = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+            float endpoint0[3], endpoint1[3];
+            for (int c = 0; c < 3; ++c) {
+                endpoint0[c] = mean[c] + axis[c] * highest / lengthSquared;
+                endpoint1[c] = mean[c] + axis[c] * lowest / lengthSquared;
+            }
+
+            Encoded best = assignIndices(block, pack565(endpoint0), pack565(endpoint1));
+            // The bounding box wins on some blocks (e.g. two flat colours); start from whichever is better
+            Encoded box = encodeFast(block);
+            Encoded boxNearest = assignIndices(block, box.color0, box.color1);
+            if (boxNearest.error < best.error) best = boxNearest;
+            for (int round = 0; round < 2 && best.error > 0.0f; ++round) {
+                if (!refineEndpoints(block, best, endpoint0, endpoint1)) break;
+                Encoded refined = assignIndices(block, pack565(endpoint0), pack565(endpoint1));
+                if (refined.error >= best.error) break;
+                best = refined;
+            }
+            return best;
+        }
+
+        void storeBlock(const Encoded& encoded, std::uint8_t* dst) {
+            dst[0] = static_cast<std::uint8_t>(encoded.color0);
+            dst[1] = static_cast<std::uint8_t>(encoded.color0 >> 8);
+            dst[2] = static_cast<std::uint8_t>(encoded.color1);
+            dst[3] = static_cast<std::uint8_t>(encoded.color1 >> 8);
+            for (int i = 0; i < 4; ++i) dst[4 + i] = static_cast<std::uint8_t>(encoded.indices >> (8 * i));
+        }
+    }
+
+    std::size_t bc1LevelOffset(int width, int height, int level) {
+        std::size_t offset = 0;
+        for (int i = 0; i < level; ++i) offset += bc1LevelBytes(mipSize(width, i), mipSize(height, i));
+        return offset;
+    }
+
+    void compressBc1(const std::uint8_t* src, int width, int height, int channels, std::uint8_t* dst,
+                     CompressionPreset preset) {
+        int blocksX = (width + 3) / 4;
+        int blocksY = (height + 3) / 4;
+        Block block;
+        for (int by = 0; by < blocksY; ++by) {
+            for (int bx = 0; bx < blocksX; ++bx) {
+                loadBlock(src, width, height, channels, bx, by, block);
+                Encoded encoded = preset == CompressionPreset::Quality ? encodeQuality(block) : encodeFast(block);
+                storeBlock(encoded, dst);
+                dst += kBc1BlockBytes;
+            }
+        }
+    }
+
+    void compressBc1Chain(const std::uint8_t* src, int width, int height, int channels, int levels,
+                          std::uint8_t* dst, CompressionPreset preset) {
+        for (int level = 0; level < levels; ++level) {
+            compressBc1(src + mipLevelOffset(width, height, channels, level), mipSize(width, level),
+                        mipSize(height, level), channels, dst + bc1LevelOffset(width, height, level), preset);
+        }
+    }
+
+    void decompressBc1(const std::uint8_t* src, int width, int height, std::uint8_t* dst) {
+        int blocksX = (width + 3) / 4;
+        int blocksY = (height + 3) / 4;
+        for (int by = 0; by < blocksY; ++by) {
+            for (int bx = 0; bx < blocksX; ++bx, src += kBc1BlockBytes) {
+                std::uint16_t color0 = static_cast<std::uint16_t>(src[0] | (src[1] << 8));
+                std::uint16_t color1 = static_cast<std::uint16_t>(src[2] | (src[3] << 8));
+                std::uint32_t indices = src[4] | (src[5] << 8) | (src[6] << 16) | (static_cast<std::uint32_t>(src[7]) << 24);
+
+                float palette[4][3];
+                unpack565(color0, palette[0]);
+                unpack565(color1, palette[1]);
+                for (int c = 0; c < 3; ++c) {
+                    if (color0 > color1) {
+                        palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+                        palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+                    } else {
+                        palette[2][c] = (palette[0][c] + palette[1][c]) / 2.0f;
+                        palette[3][c] = 0.0f;
+                    }
+                }
+
+                for (int i = 0; i < 16; ++i) {
+                    int x = bx * 4 + i % 4;
+                    int y = by * 4 + i / 4;
+                    if (x >= width || y >= height) continue;
+                    const float* color = palette[(indices >> (2 * i)) & 3];
+                    std::uint8_t* pixel = dst + (static_cast<std::size_t>(y) * width + x) * 4;
+                    for (int c = 0; c < 3; ++c) pixel[c] = static_cast<std::uint8_t>(std::lround(color[c]));
+                    pixel[3] = 255;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef TEXGAN_BLOCK_COMPRESSION_H
+#define TEXGAN_BLOCK_COMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+
+// BC1 (DXT1, GL_COMPRESSED_RGB_S3TC_DXT1_EXT) encoding on the decode threads. Each 4x4 block becomes
+// two RGB565 endpoints and sixteen 2-bit indices into the four colours between them: 8 bytes where RGBA
+// takes 64, so textures need an eighth of the VRAM and upload bandwidth. Alpha is dropped.
+// Levels of a compressed mip chain are stored back to back like MipChain.h, in blocks; levels smaller
+// than a block still take one, which is what GL expects.
+namespace texgan::loading{
+    enum class BlockFormat { None, Bc1 };
+
+    // Fast fits each block's bounding box; Quality fits its principal axis and refines the endpoints
+    // by least squares, for a lower error at four to five times the cost
+    enum class CompressionPreset { Off, Fast, Quality };
+
+    constexpr std::size_t kBc1BlockBytes = 8;
+
+    // Bytes of one width x height level
+    inline std::size_t bc1LevelBytes(int width, int height) {
+        return static_cast<std::size_t>((width + 3) / 4) * ((height + 3) / 4) * kBc1BlockBytes;
+    }
+
+    // Bytes from the start of a compressed chain to `level`
+    std::size_t bc1LevelOffset(int width, int height, int level);
+
+    inline std::size_t bc1ChainBytes(int width, int height, int levels) {
+        return bc1LevelOffset(width, height, levels);
+    }
+
+    // Encodes a width x height image with 3 or 4 channels into bc1LevelBytes(width, height) bytes at `dst`.
+    // Partial blocks at the right and bottom edges repeat the last column and row.
+    void compressBc1(const std::uint8_t* src, int width, int height, int channels, std::uint8_t* dst,
+                     CompressionPreset preset);
+
+    // Encodes the `levels` levels of a chain laid out as in MipChain.h into bc1ChainBytes() bytes at `dst`
+    void compressBc1Chain(const std::uint8_t* src, int width, int height, int channels, int levels,
+                          std::uint8_t* dst, CompressionPreset preset);
+
+    // Decodes one BC1 level to width x height RGBA, as the GPU would (to measure encoder quality)
+    void decompressBc1(const std::uint8_t* src, int width, int height, std::uint8_t* dst);
+}
+
+#endif // TEXGAN_BLOCK_COMPRESSION_H
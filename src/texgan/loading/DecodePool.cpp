@@ -0,0 +1,176 @@
+#include "DecodePool.h"
+#include "MipChain.h"
+#include "texgan/monitoring/PipelineStats.h"
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace texgan::loading{
+    namespace {
+        // Replaces the full mip chain of `img` with its BC1 blocks, in `storage` when it has room
+        void compressDecodedImage(DecodedImage& img, CompressionPreset preset, PixelStorage* storage) {
+            PixelBuffer blocks;
+            std::size_t size = bc1ChainBytes(img.width, img.height, img.levels);
+            if (!storage || !storage->allocate(size, blocks)) blocks.resize(size);
+            compressBc1Chain(img.pixels.data(), img.width, img.height, img.channels, img.levels, blocks.data(), preset);
+            img.pixels = std::move(blocks);
+            img.blocks = BlockFormat::Bc1;
+        }
+
+        // Copies the finished pixels of `img` into `storage` in one sequential write when it has room;
+        // otherwise they stay in pooled memory
+        void moveToStorage(DecodedImage& img, PixelStorage* storage) {
+            if (!storage || img.pixels.empty() || img.pixels.storage()) return;
+            PixelBuffer stored;
+            if (!storage->allocate(img.pixels.size(), stored)) return;
+            std::memcpy(stored.data(), img.pixels.data(), img.pixels.size());
+            img.pixels = std::move(stored);
+        }
+    }
+
+    bool decodeImageToMemory(const Image& image, DecodedImage& out, const DecodeOptions& options) {
+        bool compress = options.compression != CompressionPreset::Off;
+        DecodeOptions decodeOptions = options;
+        if (compress) decodeOptions.mipmaps = true;
+        if (decodeOptions.mipmaps) decodeOptions.storage = nullptr;
+
+        if (!defaultCodecs().decode(image.data(), image.size(), decodeOptions, out)) return false;
+        int levels = mipLevelCount(out.width, out.height);
+        if (decodeOptions.mipmaps) {
+            if (out.pixels.size() >= mipChainBytes(out.width, out.height, out.channels, levels)) {
+                buildMipChain(out.pixels.data(), out.width, out.height, out.channels, levels);
+                out.levels = levels;
+            }
+        }
+        // BC1 has no single-channel variant and drops alpha; photos are opaque RGB(A)
+        if (compress && out.channels >= 3 && out.levels == levels) {
+            compressDecodedImage(out, options.compression, options.storage);
+        } else {
+            moveToStorage(out, options.storage);
+        }
+        return true;
+    }
+
+    std::size_t DecodePool::defaultThreadCount() {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    DecodePool::DecodePool(std::size_t threadCount)
+        : m_threadCount(std::max<std::size_t>(threadCount, 1)),
+          m_executor(std::make_unique<aif::ThreadPoolExecutor>(m_threadCount)) {}
+
+    void DecodePool::decode(Images images, DecodedCallback onDecoded, std::shared_ptr<void> keepAlive,
+                            PixelStorage* storage) {
+        if (images.empty() || *m_stopping) {
+            onDecoded({});
+            return;
+        }
+
+        struct Batch {
+            Images images;
+            std::vector<DecodedImage> decoded;
+            std::vector<char> ok;
+            std::atomic<std::size_t> remaining;
+            DecodedCallback onDecoded;
+            std::shared_ptr<void> keepAlive;
+        };
+        auto batch = std::make_shared<Batch>();
+        batch->decoded.resize(images.size());
+        batch->ok.resize(images.size(), 0);
+        batch->remaining = images.size();
+        batch->images = std::move(images);
+        batch->onDecoded = std::move(onDecoded);
+        batch->keepAlive = std::move(keepAlive);
+
+        DecodeOptions options;
+        options.targetWidth = options.targetHeight = m_targetSize;
+        options.storage = storage;
+        options.mipmaps = m_mipmaps;
+        options.compression = m_compression;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_executor) {
+            // Shut down in the meantime
+            lock.unlock();
+            batch->onDecoded({});
+            return;
+        }
+
+        for (std::size_t i = 0; i < batch->images.size(); ++i) {
+            m_executor->post([batch, i, options, cache = m_textureCache, stopping = m_stopping]() {
+                auto start = std::chrono::steady_clock::now();
+                // Once shutting down, queued images are skipped but the batch still reports back
+                batch->ok[i] = !*stopping && decodeOrLoad(batch->images[i], batch->decoded[i], options, cache.get());
+                batch->images[i] = Image(); // the payload is no longer needed
+                if (batch->ok[i]) {
+                    monitoring::pipelineStats().decode.record(1, batch->decoded[i].pixels.size(),
+                                                              std::chrono::steady_clock::now() - start);
+                }
+
+                if (batch->remaining.fetch_sub(1) != 1) return;
+
+                std::vector<DecodedImage> decoded;
+                for (std::size_t j = 0; j < batch->decoded.size(); ++j) {
+                    if (batch->ok[j]) decoded.push_back(std::move(batch->decoded[j]));
+                }
+                batch->onDecoded(std::move(decoded));
+                batch->keepAlive.reset();
+            });
+        }
+    }
+
+    void DecodePool::setTextureCache(std::shared_ptr<TextureCache> cache) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_textureCache = std::move(cache);
+    }
+
+    bool DecodePool::usesTextureCache() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_textureCache != nullptr;
+    }
+
+    void DecodePool::loadCached(std::shared_ptr<TextureCache> cache, std::string key,
+                                std::function<void(bool, DecodedImage)> onLoaded) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_executor) {
+            lock.unlock();
+            onLoaded(false, DecodedImage());
+            return;
+        }
+        m_executor->post([cache = std::move(cache), key = std::move(key), onLoaded = std::move(onLoaded)]() {
+            DecodedImage image;
+            bool ok = cache->load(key, nullptr, image);
+            if (ok) image.cacheKey = key;
+            onLoaded(ok, std::move(image));
+        });
+    }
+
+    void DecodePool::shutdown() {
+        *m_stopping = true;
+        std::unique_ptr<aif::ThreadPoolExecutor> executor;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            executor = std::move(m_executor);
+        }
+        executor.reset(); // runs what is queued, which only reports back now
+    }
+
+    bool DecodePool::decodeOrLoad(const Image& image, DecodedImage& out, const DecodeOptions& options, TextureCache* cache) {
+        if (!cache) return decodeImageToMemory(image, out, options);
+
+        std::string key = TextureCache::keyOf(image.data(), image.size(), options);
+        if (cache->load(key, options.storage, out)) {
+            out.cacheKey = std::move(key);
+            return true;
+        }
+
+        DecodeOptions uncached = options;
+        uncached.storage = nullptr;
+        if (!decodeImageToMemory(image, out, uncached)) return false;
+        cache->store(key, out);
+        moveToStorage(out, options.storage);
+        out.cacheKey = std::move(key);
+        return true;
+    }
+}
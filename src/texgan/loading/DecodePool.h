@@ -0,0 +1,104 @@
+#ifndef TEXGAN_DECODE_POOL_H
+#define TEXGAN_DECODE_POOL_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <functional>
+#include <algorithm>
+
+#include "ImageCodec.h"
+#include "PixelBuffer.h"
+#include "BlockCompression.h"
+#include "TextureCache.h"
+#include "aif/ByteBuffer.h"
+#include "aif/Executor.h"
+
+// Turns fetched payloads into pixels ready for upload, off the network threads and the GL thread.
+namespace texgan::loading{
+    using Image = aif::ByteBuffer; // a fetched payload
+    using Images = std::vector<Image>;
+
+    // Goes through the codec registry: the fastest backend that understands the payload decodes it,
+    // and stb takes whatever the others cannot. With options.mipmaps the mip chain is built here too,
+    // in the room the codec left after the image, so the GL thread never has to generate it.
+    // With options.compression the chain is then encoded to BC1. GL cannot generate mips for compressed
+    // textures, so compression always builds the chain.
+    // The chain builder and the encoder read the pixels back, and options.storage may not allow that: the
+    // upload ring is mapped write-only, so reading it is undefined (and uncached where it works). Those
+    // images are decoded to pooled memory, and only the finished chain (or its blocks) is copied to
+    // options.storage. pixel_bench times that copy.
+    bool decodeImageToMemory(const Image& image, DecodedImage& out, const DecodeOptions& options = {});
+
+    // Decodes payloads on its own threads (one per core by default), so fetch workers go straight
+    // back to the network and the loaders only ever receive finished pixels. The images of one call
+    // are decoded in parallel.
+    class DecodePool {
+    public:
+        using DecodedCallback = std::function<void(std::vector<DecodedImage>)>;
+
+        static std::size_t defaultThreadCount();
+
+        explicit DecodePool(std::size_t threadCount = defaultThreadCount());
+
+        // Calls `onDecoded` once with the images that decoded, in order, from the pool thread that finished
+        // last. `keepAlive` (e.g. the stream items and their credits) is released after that.
+        // Pixels are written into `storage` while it has room, and into pooled buffers otherwise.
+        // After shutdown() the callback still comes, at once and with no images.
+        void decode(Images images, DecodedCallback onDecoded, std::shared_ptr<void> keepAlive = {},
+                    PixelStorage* storage = nullptr);
+
+        // Where decoded images are kept on disk and looked up before decoding, nullptr for none.
+        // Applies to batches submitted afterwards.
+        void setTextureCache(std::shared_ptr<TextureCache> cache);
+        bool usesTextureCache() const;
+
+        // Reads the entry `key` of `cache` back on a pool thread and passes it to `onLoaded`, with false
+        // when the entry is gone (evicted from disk, or never written) or the pool has shut down.
+        void loadCached(std::shared_ptr<TextureCache> cache, std::string key,
+                        std::function<void(bool, DecodedImage)> onLoaded);
+
+        // Stops the threads. Images not decoded yet are skipped, but every batch still gets its callback,
+        // with the images decoded before; later calls to decode() call back at once with none.
+        // Call before whatever the callbacks refer to goes away.
+        void shutdown();
+
+        std::size_t threadCount() const { return m_threadCount; }
+
+        // Largest texture edge worth decoding, 0 for full size. JPEGs bigger than this are decoded at a
+        // reduced DCT scale (down to 1/8) that still covers it. Applies to batches submitted afterwards.
+        void setTargetSize(int size) { m_targetSize = std::max(size, 0); }
+        int targetSize() const { return m_targetSize; }
+
+        // Whether decode threads build each image's mip chain, so uploads skip glGenerateMipmap.
+        // Applies to batches submitted afterwards.
+        void setMipmaps(bool enabled) { m_mipmaps = enabled; }
+        bool mipmaps() const { return m_mipmaps; }
+
+        // Block compression applied on the decode threads (BC1, which needs EXT_texture_compression_s3tc
+        // on the GL side). Compressed images always come with their mip chain. Applies to batches
+        // submitted afterwards.
+        void setCompression(CompressionPreset preset) { m_compression = preset; }
+        CompressionPreset compression() const { return m_compression; }
+
+    private:
+        // A cached image is only copied out of its file; anything else is decoded and then stored. Misses
+        // decode to pooled memory rather than `options.storage`, since the cache reads the pixels back,
+        // and are then copied into `options.storage` here, so the GL thread uploads them without a copy.
+        static bool decodeOrLoad(const Image& image, DecodedImage& out, const DecodeOptions& options, TextureCache* cache);
+
+        std::size_t m_threadCount;
+        std::atomic<int> m_targetSize{0};
+        std::atomic<bool> m_mipmaps{true};
+        std::atomic<CompressionPreset> m_compression{CompressionPreset::Off};
+        mutable std::mutex m_mutex;
+        std::unique_ptr<aif::ThreadPoolExecutor> m_executor;
+        std::shared_ptr<TextureCache> m_textureCache;
+        std::shared_ptr<std::atomic<bool>> m_stopping = std::make_shared<std::atomic<bool>>(false); // read by queued work
+    };
+}
+
+#endif // TEXGAN_DECODE_POOL_H
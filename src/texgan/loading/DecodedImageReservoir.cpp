@@ -0,0 +1,171 @@
+#include "DecodedImageReservoir.h"
+#include "texgan/monitoring/PipelineStats.h"
+
+#include <algorithm>
+
+namespace texgan::loading{
+    DecodedImageReservoir::DecodedImageReservoir(aif::ImageFetcher& fetcher, DecodePool& decoder, aif::Executor& continuations,
+                                                 std::string url, std::size_t target, std::size_t maxBytes)
+        : m_fetcher(fetcher), m_decoder(decoder), m_continuations(continuations), m_url(std::move(url)),
+          m_state(std::make_shared<State>()) {
+        m_state->target = target;
+        m_state->maxBytes = maxBytes;
+    }
+
+    DecodedImageReservoir::~DecodedImageReservoir() {
+        // Outstanding callbacks only hold the shared state
+        m_state->token.cancel();
+    }
+
+    void DecodedImageReservoir::setTarget(std::size_t count) {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->target = count;
+        trimLocked(*m_state);
+    }
+
+    void DecodedImageReservoir::setMemoryBudget(std::size_t bytes) {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->maxBytes = bytes;
+        trimLocked(*m_state);
+    }
+
+    std::vector<DecodedImage> DecodedImageReservoir::take(std::size_t count) {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        std::vector<DecodedImage> taken;
+        while (taken.size() < count && !m_state->ready.empty()) {
+            m_state->readyBytes -= m_state->ready.front().pixels.size();
+            taken.push_back(std::move(m_state->ready.front()));
+            m_state->ready.pop_front();
+        }
+        m_state->hits += taken.size();
+        m_state->misses += count - taken.size();
+        return taken;
+    }
+
+    void DecodedImageReservoir::arm() {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->armed = true;
+    }
+
+    bool DecodedImageReservoir::armed() const {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->armed;
+    }
+
+    void DecodedImageReservoir::refill() {
+        std::size_t wanted = 0;
+        aif::CancelToken token;
+        std::uint64_t generation = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            if (!m_state->armed) return;
+            if (m_state->token.cancelled() || !m_state->token.valid()) {
+                m_state->token = aif::CancelToken::create();
+            }
+            token = m_state->token;
+            generation = m_state->generation;
+
+            std::size_t have = m_state->ready.size() + m_state->pending;
+            if (have >= m_state->target) return;
+            wanted = m_state->target - have;
+
+            // Size the outstanding requests by the average image so the budget is not overshot: the
+            // images held when there are any, otherwise the running mean of those decoded so far
+            std::size_t average = m_state->ready.empty() ? static_cast<std::size_t>(m_state->averageBytes)
+                                                         : m_state->readyBytes / m_state->ready.size();
+            if (average > 0) {
+                std::size_t committed = m_state->readyBytes + m_state->pending * average;
+                std::size_t room = m_state->maxBytes > committed ? (m_state->maxBytes - committed) / average : 0;
+                wanted = std::min(wanted, room);
+            }
+            // A few at a time so visible requests never queue behind a long prefetch run
+            wanted = std::min(wanted, kRefillStep);
+            if (wanted == 0) return;
+            m_state->pending += wanted;
+        }
+
+        aif::spawn(refillStep(m_state, m_fetcher, m_decoder, m_continuations, m_url, wanted, token, generation));
+    }
+
+    void DecodedImageReservoir::clear() {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->generation++;
+        m_state->token.cancel();
+        m_state->ready.clear();
+        m_state->readyBytes = 0;
+    }
+
+    std::size_t DecodedImageReservoir::size() const {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->ready.size();
+    }
+
+    std::size_t DecodedImageReservoir::target() const {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->target;
+    }
+
+    std::size_t DecodedImageReservoir::bytes() const {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->readyBytes;
+    }
+
+    std::size_t DecodedImageReservoir::memoryBudget() const {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->maxBytes;
+    }
+
+    double DecodedImageReservoir::hitRate() const {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        std::size_t total = m_state->hits + m_state->misses;
+        return total ? static_cast<double>(m_state->hits) / total : 0.0;
+    }
+
+    aif::Async<void> DecodedImageReservoir::refillStep(std::shared_ptr<State> state, aif::ImageFetcher& fetcher,
+                                                       DecodePool& decoder, aif::Executor& continuations, std::string url,
+                                                       std::size_t count, aif::CancelToken token, std::uint64_t generation) {
+        std::vector<aif::Async<aif::ImageFetcher::FetchResult>> fetches;
+        for (std::size_t i = 0; i < count; ++i) {
+            fetches.push_back(fetcher.fetch(url, aif::Priority::Prefetch, token, &continuations));
+        }
+        auto results = co_await aif::whenAll(std::move(fetches));
+
+        Images images;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            // Fetched for a reservoir that has been cleared since: not worth decoding
+            bool stale = state->generation != generation;
+            for (auto& result : results) {
+                if (result.success && !stale) {
+                    images.push_back(std::move(result.data));
+                } else {
+                    --state->pending;
+                }
+            }
+        }
+        for (const auto& image : images) monitoring::pipelineStats().fetch.record(1, image.size());
+
+        std::size_t submitted = images.size();
+        decoder.decode(std::move(images), [state, generation, submitted](std::vector<DecodedImage> decoded) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->pending -= submitted;
+            if (state->generation != generation) return;
+            for (auto& image : decoded) {
+                double size = static_cast<double>(image.pixels.size());
+                state->averageBytes = state->averageBytes > 0.0 ? state->averageBytes + kAverageWeight * (size - state->averageBytes)
+                                                                : size;
+                state->readyBytes += image.pixels.size();
+                state->ready.push_back(std::move(image));
+            }
+            // Images larger than the average refill() planned for can overshoot the budget
+            trimLocked(*state);
+        });
+    }
+
+    void DecodedImageReservoir::trimLocked(State& state) {
+        while (!state.ready.empty() && (state.ready.size() > state.target || state.readyBytes > state.maxBytes)) {
+            state.readyBytes -= state.ready.back().pixels.size();
+            state.ready.pop_back();
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef TEXGAN_DECODED_IMAGE_RESERVOIR_H
+#define TEXGAN_DECODED_IMAGE_RESERVOIR_H
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "DecodePool.h"
+#include "aif/ImageFetcher.h"
+
+// Keeps a number of images fetched and decoded ahead of time, so a batch request can be
+// served without waiting on the network or the decoder. Refills at prefetch priority, and only
+// once arm() has been called, so nothing is downloaded before the user asks for images.
+namespace texgan::loading{
+    class DecodedImageReservoir {
+    public:
+        static constexpr std::size_t kRefillStep = 8; // prefetch requests issued per refill() call
+        static constexpr double kAverageWeight = 0.125; // weight of each new image in the running mean of sizes
+
+        // Refills continue on `continuations`, which must run its work on one thread (e.g. a FrameExecutor
+        // pumped by the main loop) while the reservoir is alive
+        DecodedImageReservoir(aif::ImageFetcher& fetcher, DecodePool& decoder, aif::Executor& continuations,
+                              std::string url, std::size_t target, std::size_t maxBytes);
+        ~DecodedImageReservoir();
+
+        void setTarget(std::size_t count);
+        void setMemoryBudget(std::size_t bytes);
+
+        // Takes up to `count` ready images; the caller fetches whatever is missing
+        std::vector<DecodedImage> take(std::size_t count);
+
+        // Lets refill() fetch: after the first batch the user asked for, or when they opt in
+        void arm();
+        bool armed() const;
+
+        // Tops the reservoir up to its target within the memory budget. Call while the app is idle.
+        void refill();
+
+        // Drops the prefetched images, and those still being fetched or decoded when they arrive, and
+        // stops refilling until the next refill()
+        void clear();
+
+        std::size_t size() const;
+        std::size_t target() const;
+        std::size_t bytes() const;
+        std::size_t memoryBudget() const;
+
+        // Share of requested images that were served from the reservoir
+        double hitRate() const;
+
+    private:
+        struct State {
+            mutable std::mutex mutex;
+            std::deque<DecodedImage> ready;
+            std::size_t readyBytes = 0;
+            double averageBytes = 0.0; // running mean of decoded image sizes, see kAverageWeight
+            std::size_t pending = 0;
+            std::size_t target = 0;
+            std::size_t maxBytes = 0;
+            std::size_t hits = 0;
+            std::size_t misses = 0;
+            bool armed = false;
+            std::uint64_t generation = 0; // bumped by clear(); refills of an older one are dropped on arrival
+            aif::CancelToken token;
+        };
+
+        // Fetches `count` images and decodes them as one batch. Resumes on `continuations` rather than on
+        // whichever fetch thread finished last, so all a fetch thread does is queue the continuation.
+        static aif::Async<void> refillStep(std::shared_ptr<State> state, aif::ImageFetcher& fetcher, DecodePool& decoder,
+                                           aif::Executor& continuations, std::string url, std::size_t count,
+                                           aif::CancelToken token, std::uint64_t generation);
+
+        // Drops the newest images until the reservoir is within its target and memory budget
+        static void trimLocked(State& state);
+
+        aif::ImageFetcher& m_fetcher;
+        DecodePool& m_decoder;
+        aif::Executor& m_continuations;
+        std::string m_url;
+        std::shared_ptr<State> m_state;
+    };
+}
+
+#endif // TEXGAN_DECODED_IMAGE_RESERVOIR_H
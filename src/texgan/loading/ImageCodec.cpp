@@ -0,0 +1,60 @@
+#include "ImageCodec.h"
+#include "MipChain.h"
+
+#include <chrono>
+
+namespace texgan::loading{
+    void allocatePixels(PixelBuffer& buffer, int width, int height, int channels, const DecodeOptions& options) {
+        int levels = options.mipmaps ? mipLevelCount(width, height) : 1;
+        std::size_t size = mipChainBytes(width, height, channels, levels);
+        if (options.storage) {
+            buffer.reset();
+            if (options.storage->allocate(size, buffer)) return;
+        }
+        buffer.resize(size);
+    }
+
+    void CodecRegistry::add(std::unique_ptr<ImageCodec> codec) {
+        if (!codec) return;
+        auto entry = std::make_unique<Entry>();
+        entry->codec = std::move(codec);
+        m_entries.push_back(std::move(entry));
+    }
+
+    bool CodecRegistry::decode(const unsigned char* data, std::size_t size, const DecodeOptions& options,
+                               DecodedImage& out) {
+        for (auto& entry : m_entries) {
+            if (!entry->codec->accepts(data, size)) continue;
+
+            auto start = std::chrono::steady_clock::now();
+            if (entry->codec->decode(data, size, options, out)) {
+                auto elapsed = std::chrono::steady_clock::now() - start;
+                entry->micros += std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+                entry->decoded++;
+                return true;
+            }
+            entry->failed++;
+        }
+        return false;
+    }
+
+    std::vector<CodecRegistry::CodecStats> CodecRegistry::stats() const {
+        std::vector<CodecStats> result;
+        for (const auto& entry : m_entries) {
+            std::uint64_t decoded = entry->decoded;
+            double millis = decoded ? entry->micros / 1000.0 / decoded : 0.0;
+            result.push_back({entry->codec->name(), decoded, entry->failed, millis});
+        }
+        return result;
+    }
+
+    CodecRegistry& defaultCodecs() {
+        static CodecRegistry registry = []() {
+            CodecRegistry codecs;
+            codecs.add(makeJpegCodec());
+            codecs.add(makeStbCodec());
+            return codecs;
+        }();
+        return registry;
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef TEXGAN_IMAGE_CODEC_H
+#define TEXGAN_IMAGE_CODEC_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "PixelOps.h"
+#include "PixelBuffer.h"
+#include "BlockCompression.h"
+
+// Image decoding behind one interface. Each backend (libjpeg-turbo for JPEG, stb for everything)
+// is an ImageCodec; a CodecRegistry tries them in order of preference and keeps per-backend timings.
+namespace texgan::loading{
+    // A struct to hold decoded image data. The pixels go back to the pool when it is destroyed.
+    struct DecodedImage {
+        PixelBuffer pixels;
+        int width;
+        int height;
+        int channels;
+        int levels = 1; // mip levels in `pixels`, laid out as in MipChain.h
+        BlockFormat blocks = BlockFormat::None; // set when `pixels` holds compressed blocks instead
+        std::string cacheKey; // key of the texture cache entry holding these pixels, empty when not cached
+    };
+
+    struct DecodeOptions {
+        PixelOptions pixels;
+        // Size the image will be shown at, 0 for full size. Codecs that can decode at a reduced scale
+        // pick the smallest one that still covers it; the others ignore it.
+        int targetWidth = 0;
+        int targetHeight = 0;
+        // Where the pixels should go if it has room, instead of the pool
+        PixelStorage* storage = nullptr;
+        // Leave room after the image for its full mip chain, which the caller builds once decoded
+        bool mipmaps = false;
+        // Encode to a block-compressed format once decoded. Codecs ignore it; the caller encodes.
+        CompressionPreset compression = CompressionPreset::Off;
+    };
+
+    // For codecs: sizes `buffer` for a width x height image of `channels` channels (and its mip chain
+    // when options.mipmaps is set), in options.storage when it has room
+    void allocatePixels(PixelBuffer& buffer, int width, int height, int channels, const DecodeOptions& options);
+
+    class ImageCodec {
+    public:
+        virtual ~ImageCodec() = default;
+
+        virtual const char* name() const = 0;
+
+        // Whether `data` looks like a format this codec handles (checked by signature, not decoded)
+        virtual bool accepts(const unsigned char* data, std::size_t size) const = 0;
+
+        // Decodes into `out`, with options.pixels applied. Must be safe to call from many threads at once.
+        virtual bool decode(const unsigned char* data, std::size_t size, const DecodeOptions& options,
+                            DecodedImage& out) const = 0;
+    };
+
+    // stb_image: JPEG, PNG, BMP, TGA, GIF... Always available.
+    std::unique_ptr<ImageCodec> makeStbCodec();
+
+    // libjpeg(-turbo) with DCT-domain downscaling. nullptr when the build has no libjpeg.
+    std::unique_ptr<ImageCodec> makeJpegCodec();
+
+    class CodecRegistry {
+    public:
+        struct CodecStats {
+            std::string name;
+            std::uint64_t decoded;
+            std::uint64_t failed;
+            double millisPerImage;
+        };
+
+        // Codecs are tried in the order they were added. Add them all before the first decode.
+        void add(std::unique_ptr<ImageCodec> codec);
+
+        // The first codec that accepts the payload decodes it; if it fails, the next one gets a go.
+        bool decode(const unsigned char* data, std::size_t size, const DecodeOptions& options, DecodedImage& out);
+
+        std::vector<CodecStats> stats() const;
+
+    private:
+        struct Entry {
+            std::unique_ptr<ImageCodec> codec;
+            std::atomic<std::uint64_t> decoded{0};
+            std::atomic<std::uint64_t> failed{0};
+            std::atomic<std::uint64_t> micros{0};
+        };
+
+        std::vector<std::unique_ptr<Entry>> m_entries;
+    };
+
+    // Every backend this build has, fastest first, with stb last.
+    CodecRegistry& defaultCodecs();
+}
+
+#endif // TEXGAN_IMAGE_CODEC_H
@@ -0,0 +1,139 @@
+#include "ImageCodec.h"
+
+#ifdef TEXGAN_HAVE_JPEG
+
+#include <csetjmp>
+#include <cstdio> // jpeglib.h needs FILE
+
+#include <jpeglib.h>
+
+namespace texgan::loading{
+    namespace {
+        struct ErrorManager {
+            jpeg_error_mgr base;
+            std::jmp_buf jump;
+        };
+
+        // libjpeg's default handler calls exit(); unwind back into decode() instead
+        void onError(j_common_ptr cinfo) {
+            std::longjmp(reinterpret_cast<ErrorManager*>(cinfo->err)->jump, 1);
+        }
+
+        // Warnings about recoverable corruption would otherwise go to stderr from every decode thread
+        void onMessage(j_common_ptr, int) {}
+
+        // libjpeg can run the IDCT at 1/2, 1/4 or 1/8 scale, skipping most of the work for images that
+        // will be shown small. Picks the smallest scale at which the image, fitted into the target box,
+        // still does not need magnifying: it reaches the target in at least one dimension.
+        int scaleDenominator(unsigned width, unsigned height, const DecodeOptions& options) {
+            if (options.targetWidth <= 0 && options.targetHeight <= 0) return 1;
+            for (unsigned denom : {8u, 4u, 2u}) {
+                unsigned scaledWidth = (width + denom - 1) / denom;
+                unsigned scaledHeight = (height + denom - 1) / denom;
+                bool coversWidth = options.targetWidth > 0 && scaledWidth >= static_cast<unsigned>(options.targetWidth);
+                bool coversHeight = options.targetHeight > 0 && scaledHeight >= static_cast<unsigned>(options.targetHeight);
+                if (coversWidth || coversHeight) return static_cast<int>(denom);
+            }
+            return 1;
+        }
+
+        class JpegCodec : public ImageCodec {
+        public:
+        #ifdef LIBJPEG_TURBO_VERSION
+            const char* name() const override { return "libjpeg-turbo"; }
+        #else
+            const char* name() const override { return "libjpeg"; }
+        #endif
+
+            bool accepts(const unsigned char* data, std::size_t size) const override {
+                return size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF;
+            }
+
+            // Nothing with a destructor may live in this frame: a libjpeg error longjmps straight back to
+            // the setjmp below. Scanlines are written directly into `out` (bottom row first when flipping);
+            // only colour conversions libjpeg cannot do itself go through a row buffer from libjpeg's pool.
+            bool decode(const unsigned char* data, std::size_t size, const DecodeOptions& options,
+                        DecodedImage& out) const override {
+                jpeg_decompress_struct cinfo;
+                ErrorManager errors;
+                cinfo.err = jpeg_std_error(&errors.base);
+                errors.base.error_exit = onError;
+                errors.base.emit_message = onMessage;
+
+                if (setjmp(errors.jump)) {
+                    jpeg_destroy_decompress(&cinfo);
+                    return false;
+                }
+
+                jpeg_create_decompress(&cinfo);
+                jpeg_mem_src(&cinfo, const_cast<unsigned char*>(data), static_cast<unsigned long>(size));
+                jpeg_read_header(&cinfo, TRUE);
+
+                // CMYK and YCCK are left to the fallback
+                bool grey = cinfo.jpeg_color_space == JCS_GRAYSCALE;
+                if (!grey && cinfo.num_components != 3) {
+                    jpeg_destroy_decompress(&cinfo);
+                    return false;
+                }
+
+                cinfo.scale_num = 1;
+                cinfo.scale_denom = scaleDenominator(cinfo.image_width, cinfo.image_height, options);
+            #ifdef JCS_EXTENSIONS
+                if (grey) cinfo.out_color_space = JCS_GRAYSCALE;
+                else cinfo.out_color_space = options.pixels.expandToRgba ? JCS_EXT_RGBA : JCS_RGB;
+            #else
+                cinfo.out_color_space = grey ? JCS_GRAYSCALE : JCS_RGB;
+            #endif
+
+                jpeg_start_decompress(&cinfo);
+
+                int width = static_cast<int>(cinfo.output_width);
+                int height = static_cast<int>(cinfo.output_height);
+                int decodedChannels = cinfo.output_components;
+                int channels = outputChannels(decodedChannels, options.pixels);
+                std::size_t stride = static_cast<std::size_t>(width) * channels;
+                allocatePixels(out.pixels, width, height, channels, options);
+
+                // JPEG has no alpha, so a channel-count change is the only conversion left to do
+                JSAMPARRAY rowBuffer = nullptr;
+                PixelOptions rowOptions = options.pixels;
+                rowOptions.flipVertically = false;
+                if (channels != decodedChannels) {
+                    rowBuffer = (*cinfo.mem->alloc_sarray)(reinterpret_cast<j_common_ptr>(&cinfo), JPOOL_IMAGE,
+                                                           cinfo.output_width * decodedChannels, 1);
+                }
+
+                while (cinfo.output_scanline < cinfo.output_height) {
+                    int y = static_cast<int>(cinfo.output_scanline);
+                    int row = options.pixels.flipVertically ? height - 1 - y : y;
+                    unsigned char* dst = out.pixels.data() + stride * row;
+                    JSAMPROW target = rowBuffer ? rowBuffer[0] : dst;
+                    jpeg_read_scanlines(&cinfo, &target, 1);
+                    if (rowBuffer) convertPixels(rowBuffer[0], width, 1, decodedChannels, dst, rowOptions);
+                }
+
+                jpeg_finish_decompress(&cinfo);
+                jpeg_destroy_decompress(&cinfo);
+
+                out.width = width;
+                out.height = height;
+                out.channels = channels;
+                return true;
+            }
+        };
+    }
+
+    std::unique_ptr<ImageCodec> makeJpegCodec() {
+        return std::make_unique<JpegCodec>();
+    }
+}
+
+#else
+
+namespace texgan::loading{
+    std::unique_ptr<ImageCodec> makeJpegCodec() {
+        return nullptr;
+    }
+}
+
+#endif // TEXGAN_HAVE_JPEG
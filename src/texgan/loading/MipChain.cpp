@@ -0,0 +1,58 @@
+#include "MipChain.h"
+
+#include <algorithm>
+
+namespace texgan::loading{
+    int mipLevelCount(int width, int height) {
+        int levels = 1;
+        while ((std::max(width, height) >> levels) > 0) ++levels;
+        return levels;
+    }
+
+    std::size_t mipLevelOffset(int width, int height, int channels, int level) {
+        std::size_t offset = 0;
+        for (int i = 0; i < level; ++i) {
+            offset += static_cast<std::size_t>(mipSize(width, i)) * mipSize(height, i) * channels;
+        }
+        return offset;
+    }
+
+    void halveImage(const std::uint8_t* src, int width, int height, int channels, std::uint8_t* dst,
+                    const PixelKernels& kernels) {
+        int dstWidth = mipSize(width, 1);
+        int dstHeight = mipSize(height, 1);
+        std::size_t srcStride = static_cast<std::size_t>(width) * channels;
+        std::size_t dstStride = static_cast<std::size_t>(dstWidth) * channels;
+
+        for (int y = 0; y < dstHeight; ++y) {
+            // A 1-pixel-high source averages its only row with itself, and likewise for columns below
+            const std::uint8_t* row0 = src + srcStride * std::min(2 * y, height - 1);
+            const std::uint8_t* row1 = src + srcStride * std::min(2 * y + 1, height - 1);
+            std::uint8_t* dstRow = dst + dstStride * y;
+
+            if (channels == 4 && width > 1) {
+                kernels.halveRgba(row0, row1, dstRow, static_cast<std::size_t>(dstWidth));
+                continue;
+            }
+            for (int x = 0; x < dstWidth; ++x) {
+                const std::uint8_t* left0 = row0 + std::min(2 * x, width - 1) * channels;
+                const std::uint8_t* right0 = row0 + std::min(2 * x + 1, width - 1) * channels;
+                const std::uint8_t* left1 = row1 + std::min(2 * x, width - 1) * channels;
+                const std::uint8_t* right1 = row1 + std::min(2 * x + 1, width - 1) * channels;
+                for (int c = 0; c < channels; ++c) {
+                    dstRow[x * channels + c] = static_cast<std::uint8_t>((left0[c] + right0[c] + left1[c] + right1[c] + 2) >> 2);
+                }
+            }
+        }
+    }
+
+    void buildMipChain(std::uint8_t* pixels, int width, int height, int channels, int levels,
+                       const PixelKernels& kernels) {
+        std::uint8_t* level = pixels;
+        for (int i = 1; i < levels; ++i) {
+            std::uint8_t* next = level + static_cast<std::size_t>(mipSize(width, i - 1)) * mipSize(height, i - 1) * channels;
+            halveImage(level, mipSize(width, i - 1), mipSize(height, i - 1), channels, next, kernels);
+            level = next;
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef TEXGAN_MIP_CHAIN_H
+#define TEXGAN_MIP_CHAIN_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "PixelOps.h"
+
+// Mip chains built on the CPU, so decode threads produce every level and the GL thread only uploads
+// them instead of running glGenerateMipmap. A chain is stored back to back in one buffer, largest level
+// first; each level is half the one before, rounded down and at least 1 pixel, as GL sizes them.
+// Each level is a 2x2 box filter of the previous one; odd rows and columns are dropped.
+namespace texgan::loading{
+    // Levels of a full chain down to 1x1
+    int mipLevelCount(int width, int height);
+
+    // Edge length of `level` for a level-0 edge of `size`
+    inline int mipSize(int size, int level) {
+        int scaled = size >> level;
+        return scaled > 0 ? scaled : 1;
+    }
+
+    // Bytes from the start of the chain to `level`, which is also the size of the levels before it
+    std::size_t mipLevelOffset(int width, int height, int channels, int level);
+
+    // Bytes of a chain with `levels` levels
+    inline std::size_t mipChainBytes(int width, int height, int channels, int levels) {
+        return mipLevelOffset(width, height, channels, levels);
+    }
+
+    // Writes the next mip level of a width x height image to `dst`, which holds mipSize(width, 1) x
+    // mipSize(height, 1) pixels. Four-channel images go through the SIMD kernels.
+    void halveImage(const std::uint8_t* src, int width, int height, int channels, std::uint8_t* dst,
+                    const PixelKernels& kernels = bestPixelKernels());
+
+    // Fills levels 1 to levels - 1 of a chain whose level 0 is already at `pixels`
+    void buildMipChain(std::uint8_t* pixels, int width, int height, int channels, int levels,
+                       const PixelKernels& kernels = bestPixelKernels());
+}
+
+#endif // TEXGAN_MIP_CHAIN_H
@@ -0,0 +1,141 @@
+#include "PixelBuffer.h"
+
+#include <new>
+#include <utility>
+
+namespace texgan::loading{
+    namespace {
+        // Cache-line aligned, which also suits the SIMD kernels and buffer-object copies
+        constexpr std::align_val_t kBlockAlignment{64};
+    }
+
+    PixelBufferPool& PixelBufferPool::shared() {
+        static PixelBufferPool* pool = new PixelBufferPool();
+        return *pool;
+    }
+
+    int PixelBufferPool::sizeClass(std::size_t size, std::size_t& capacity) {
+        if (size < kMinPooledBytes || size > kMaxPooledBytes) return -1;
+        for (int index = 0; index < kClassCount; ++index) {
+            std::size_t base = std::size_t(1) << (kMinOctave + index / kStepsPerOctave);
+            std::size_t classBytes = base + (index % kStepsPerOctave) * (base / kStepsPerOctave);
+            if (classBytes >= size) {
+                capacity = classBytes;
+                return index;
+            }
+        }
+        return -1;
+    }
+
+    unsigned char* PixelBufferPool::allocate(std::size_t capacity) {
+        return static_cast<unsigned char*>(::operator new(capacity, kBlockAlignment));
+    }
+
+    void PixelBufferPool::deallocate(unsigned char* block) {
+        ::operator delete(block, kBlockAlignment);
+    }
+
+    unsigned char* PixelBufferPool::acquire(std::size_t size, std::size_t& capacity) {
+        int index = sizeClass(size, capacity);
+        if (index >= 0) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto& free = m_free[index];
+            if (!free.empty()) {
+                unsigned char* block = free.back();
+                free.pop_back();
+                m_retainedBytes -= capacity;
+                m_reuses++;
+                return block;
+            }
+        } else {
+            capacity = size;
+        }
+        m_allocations++;
+        return allocate(capacity);
+    }
+
+    void PixelBufferPool::release(unsigned char* block, std::size_t capacity) {
+        if (!block) return;
+
+        std::size_t classBytes = 0;
+        int index = sizeClass(capacity, classBytes);
+        if (index >= 0 && classBytes == capacity) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_retainedBytes + capacity <= kMaxRetainedBytes) {
+                m_free[index].push_back(block);
+                m_retainedBytes += capacity;
+                return;
+            }
+        }
+        deallocate(block);
+    }
+
+    void PixelBufferPool::trim() {
+        std::array<std::vector<unsigned char*>, kClassCount> blocks;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            blocks.swap(m_free);
+            m_retainedBytes = 0;
+        }
+        for (auto& free : blocks) {
+            for (unsigned char* block : free) deallocate(block);
+        }
+    }
+
+    PixelBufferPool::Stats PixelBufferPool::stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return {m_allocations, m_reuses, m_retainedBytes};
+    }
+
+
+    PixelBuffer::PixelBuffer(PixelBuffer&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr)),
+          m_size(std::exchange(other.m_size, 0)),
+          m_capacity(std::exchange(other.m_capacity, 0)),
+          m_storage(std::exchange(other.m_storage, nullptr)),
+          m_ticket(std::exchange(other.m_ticket, 0)) {}
+
+    PixelBuffer& PixelBuffer::operator=(PixelBuffer&& other) noexcept {
+        if (this != &other) {
+            reset();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_capacity = std::exchange(other.m_capacity, 0);
+            m_storage = std::exchange(other.m_storage, nullptr);
+            m_ticket = std::exchange(other.m_ticket, 0);
+        }
+        return *this;
+    }
+
+    void PixelBuffer::resize(std::size_t size) {
+        if (size <= m_capacity) {
+            m_size = size;
+            return;
+        }
+        reset();
+        m_data = PixelBufferPool::shared().acquire(size, m_capacity);
+        m_size = size;
+    }
+
+    void PixelBuffer::reset() {
+        if (m_storage) {
+            m_storage->release(m_ticket);
+        } else {
+            PixelBufferPool::shared().release(m_data, m_capacity);
+        }
+        m_data = nullptr;
+        m_size = 0;
+        m_capacity = 0;
+        m_storage = nullptr;
+        m_ticket = 0;
+    }
+
+    void PixelBuffer::adopt(unsigned char* data, std::size_t size, PixelStorage* storage, std::uint64_t ticket) {
+        reset();
+        m_data = data;
+        m_size = size;
+        m_capacity = size;
+        m_storage = storage;
+        m_ticket = ticket;
+    }
+}
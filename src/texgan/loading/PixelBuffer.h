@@ -0,0 +1,115 @@
+#ifndef TEXGAN_PIXEL_BUFFER_H
+#define TEXGAN_PIXEL_BUFFER_H
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Pooled storage for decoded pixels. Decoders write straight into a PixelBuffer, and once the image has
+// been uploaded (or dropped) its block goes back to a free list for its size class, so loading batch
+// after batch of same-sized images stops touching the heap for pixel data altogether.
+namespace texgan::loading{
+    class PixelBufferPool {
+    public:
+        static constexpr std::size_t kMinPooledBytes = 64 << 10;      // smaller blocks are not worth pooling
+        static constexpr std::size_t kMaxPooledBytes = 256ull << 20;  // nor are larger ones
+        static constexpr std::size_t kMaxRetainedBytes = 256ull << 20; // free blocks kept, across all classes
+
+        struct Stats {
+            std::uint64_t allocations; // blocks that had to come from the heap
+            std::uint64_t reuses;      // blocks served from a free list
+            std::size_t retainedBytes;
+        };
+
+        // The pool every DecodedImage draws from. Never destroyed, so buffers may outlive static teardown.
+        static PixelBufferPool& shared();
+
+        // A block of at least `size` bytes; `capacity` receives its actual size.
+        unsigned char* acquire(std::size_t size, std::size_t& capacity);
+        void release(unsigned char* block, std::size_t capacity);
+
+        // Frees every block on the free lists.
+        void trim();
+
+        Stats stats() const;
+
+    private:
+        // Four classes per power of two, so a block is at most 25% larger than asked for
+        static constexpr int kStepsPerOctave = 4;
+        static constexpr int kMinOctave = 16; // kMinPooledBytes
+        static constexpr int kMaxOctave = 28; // kMaxPooledBytes
+        static constexpr int kClassCount = (kMaxOctave - kMinOctave) * kStepsPerOctave + 1;
+
+        // Size class for `size`, or -1 when it is not pooled. `capacity` receives the class size.
+        static int sizeClass(std::size_t size, std::size_t& capacity);
+
+        static unsigned char* allocate(std::size_t capacity);
+        static void deallocate(unsigned char* block);
+
+        mutable std::mutex m_mutex;
+        std::array<std::vector<unsigned char*>, kClassCount> m_free;
+        std::size_t m_retainedBytes = 0;
+        std::atomic<std::uint64_t> m_allocations{0};
+        std::atomic<std::uint64_t> m_reuses{0};
+    };
+
+    class PixelBuffer;
+
+    // Memory other than the pool that decoders can write into, e.g. mapped GPU upload buffers.
+    // Must outlive every PixelBuffer it hands out.
+    class PixelStorage {
+    public:
+        virtual ~PixelStorage() = default;
+
+        // Points `buffer` at `size` bytes of this storage, or returns false (full, disabled) so the
+        // caller falls back to the pool. Called from decode threads.
+        virtual bool allocate(std::size_t size, PixelBuffer& buffer) = 0;
+
+        // The PixelBuffer holding `ticket` was reset or destroyed. Called from any thread.
+        virtual void release(std::uint64_t ticket) = 0;
+    };
+
+    // Move-only byte buffer backed by PixelBufferPool::shared(), or by a PixelStorage that adopted it.
+    // Unlike std::vector, resize() does not keep the old contents or initialise new bytes: it is only
+    // meant to be sized once, then filled.
+    class PixelBuffer {
+    public:
+        PixelBuffer() = default;
+        explicit PixelBuffer(std::size_t size) { resize(size); }
+        ~PixelBuffer() { reset(); }
+
+        PixelBuffer(PixelBuffer&& other) noexcept;
+        PixelBuffer& operator=(PixelBuffer&& other) noexcept;
+        PixelBuffer(const PixelBuffer&) = delete;
+        PixelBuffer& operator=(const PixelBuffer&) = delete;
+
+        void resize(std::size_t size);
+
+        // Hands the block back to the pool (or its storage).
+        void reset();
+
+        // For PixelStorage::allocate: makes this buffer a view of `size` bytes at `data`, returned to
+        // `storage` under `ticket` on reset.
+        void adopt(unsigned char* data, std::size_t size, PixelStorage* storage, std::uint64_t ticket);
+
+        PixelStorage* storage() const { return m_storage; }
+        std::uint64_t ticket() const { return m_ticket; }
+
+        unsigned char* data() { return m_data; }
+        const unsigned char* data() const { return m_data; }
+        std::size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+
+    private:
+        unsigned char* m_data = nullptr;
+        std::size_t m_size = 0;
+        std::size_t m_capacity = 0;
+        PixelStorage* m_storage = nullptr;
+        std::uint64_t m_ticket = 0;
+    };
+}
+
+#endif // TEXGAN_PIXEL_BUFFER_H
@@ -0,0 +1,193 @@
+#include "PixelOps.h"
+
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define TEXGAN_PIXEL_OPS_X86 1
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #include <immintrin.h>
+    #endif
+#endif
+
+namespace texgan::loading{
+    // Defined in PixelOpsSse41.cpp and PixelOpsAvx2.cpp, which are compiled for those instruction sets.
+    // They return nullptr when the compiler could not target it.
+    const PixelKernels* sse41PixelKernels();
+    const PixelKernels* avx2PixelKernels();
+
+    namespace {
+        void expandRgbToRgbaScalar(const std::uint8_t* src, std::uint8_t* dst, std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i, src += 3, dst += 4) {
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+                dst[3] = 0xFF;
+            }
+        }
+
+        // Exact rounding division by 255, as the SIMD kernels do it
+        inline std::uint8_t mulDiv255(unsigned c, unsigned a) {
+            unsigned t = c * a + 128;
+            return static_cast<std::uint8_t>((t + (t >> 8)) >> 8);
+        }
+
+        void premultiplyRgbaScalar(std::uint8_t* pixels, std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i, pixels += 4) {
+                unsigned a = pixels[3];
+                if (a == 0xFF) continue;
+                pixels[0] = mulDiv255(pixels[0], a);
+                pixels[1] = mulDiv255(pixels[1], a);
+                pixels[2] = mulDiv255(pixels[2], a);
+            }
+        }
+
+        void halveRgbaScalar(const std::uint8_t* row0, const std::uint8_t* row1, std::uint8_t* dst, std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i, row0 += 8, row1 += 8, dst += 4) {
+                for (int c = 0; c < 4; ++c) {
+                    dst[c] = static_cast<std::uint8_t>((row0[c] + row0[c + 4] + row1[c] + row1[c + 4] + 2) >> 2);
+                }
+            }
+        }
+
+        const PixelKernels kScalarKernels{SimdLevel::Scalar, "scalar", expandRgbToRgbaScalar, premultiplyRgbaScalar,
+                                          halveRgbaScalar};
+
+        // Lookup tables for premultiplying in linear light
+        struct SrgbTables {
+            static constexpr int kLinearSteps = 4096;
+            std::array<float, 256> toLinear;
+            std::array<std::uint8_t, kLinearSteps> fromLinear;
+
+            SrgbTables() {
+                for (int i = 0; i < 256; ++i) {
+                    float c = i / 255.0f;
+                    toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+                }
+                for (int i = 0; i < kLinearSteps; ++i) {
+                    float l = i / float(kLinearSteps - 1);
+                    float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+                    fromLinear[i] = static_cast<std::uint8_t>(c * 255.0f + 0.5f);
+                }
+            }
+
+            static const SrgbTables& get() {
+                static const SrgbTables tables;
+                return tables;
+            }
+        };
+
+        void premultiplyLinear(std::uint8_t* pixels, std::size_t count, int channels) {
+            const auto& tables = SrgbTables::get();
+            int colours = channels - 1;
+            for (std::size_t i = 0; i < count; ++i, pixels += channels) {
+                unsigned a = pixels[colours];
+                if (a == 0xFF) continue;
+                float alpha = a / 255.0f;
+                for (int c = 0; c < colours; ++c) {
+                    float linear = tables.toLinear[pixels[c]] * alpha;
+                    pixels[c] = tables.fromLinear[static_cast<int>(linear * (SrgbTables::kLinearSteps - 1) + 0.5f)];
+                }
+            }
+        }
+
+        void premultiplyGreyAlpha(std::uint8_t* pixels, std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i, pixels += 2) {
+                pixels[0] = mulDiv255(pixels[0], pixels[1]);
+            }
+        }
+
+        void expandGreyToRgba(const std::uint8_t* src, std::uint8_t* dst, std::size_t count, int channels) {
+            for (std::size_t i = 0; i < count; ++i, src += channels, dst += 4) {
+                dst[0] = dst[1] = dst[2] = src[0];
+                dst[3] = channels == 2 ? src[1] : 0xFF;
+            }
+        }
+
+        bool cpuHasSse41() {
+        #if defined(TEXGAN_PIXEL_OPS_X86) && (defined(__GNUC__) || defined(__clang__))
+            return __builtin_cpu_supports("sse4.1");
+        #elif defined(TEXGAN_PIXEL_OPS_X86) && defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 1);
+            return (info[2] & (1 << 19)) != 0;
+        #else
+            return false;
+        #endif
+        }
+
+        bool cpuHasAvx2() {
+        #if defined(TEXGAN_PIXEL_OPS_X86) && (defined(__GNUC__) || defined(__clang__))
+            // Also checks that the OS saves the YMM registers
+            return __builtin_cpu_supports("avx2");
+        #elif defined(TEXGAN_PIXEL_OPS_X86) && defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 1);
+            bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+            if (!osSavesYmm) return false;
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+        #else
+            return false;
+        #endif
+        }
+    }
+
+    SimdLevel detectSimdLevel() {
+        if (avx2PixelKernels() && cpuHasAvx2()) return SimdLevel::Avx2;
+        if (sse41PixelKernels() && cpuHasSse41()) return SimdLevel::Sse41;
+        return SimdLevel::Scalar;
+    }
+
+    const PixelKernels* pixelKernels(SimdLevel level) {
+        switch (level) {
+            case SimdLevel::Avx2: return cpuHasAvx2() ? avx2PixelKernels() : nullptr;
+            case SimdLevel::Sse41: return cpuHasSse41() ? sse41PixelKernels() : nullptr;
+            case SimdLevel::Scalar: break;
+        }
+        return &kScalarKernels;
+    }
+
+    const PixelKernels& bestPixelKernels() {
+        static const PixelKernels& kernels = *pixelKernels(detectSimdLevel());
+        return kernels;
+    }
+
+    int outputChannels(int channels, const PixelOptions& options) {
+        return options.expandToRgba ? 4 : channels;
+    }
+
+    void convertPixels(const std::uint8_t* src, int width, int height, int channels, std::uint8_t* dst,
+                       const PixelOptions& options, const PixelKernels& kernels) {
+        int outChannels = outputChannels(channels, options);
+        std::size_t count = static_cast<std::size_t>(width);
+        std::size_t srcStride = count * channels;
+        std::size_t dstStride = count * outChannels;
+        bool hasAlpha = channels == 2 || channels == 4;
+
+        for (int y = 0; y < height; ++y) {
+            const std::uint8_t* srcRow = src + srcStride * (options.flipVertically ? height - 1 - y : y);
+            std::uint8_t* dstRow = dst + dstStride * y;
+
+            if (outChannels == channels) {
+                std::memcpy(dstRow, srcRow, dstStride);
+            } else if (channels == 3) {
+                kernels.expandRgbToRgba(srcRow, dstRow, count);
+            } else {
+                expandGreyToRgba(srcRow, dstRow, count, channels);
+            }
+
+            // Premultiplying while the row is still in cache
+            if (!options.premultiplyAlpha || !hasAlpha) continue;
+            if (options.linearPremultiply) {
+                premultiplyLinear(dstRow, count, outChannels);
+            } else if (outChannels == 4) {
+                kernels.premultiplyRgba(dstRow, count);
+            } else {
+                premultiplyGreyAlpha(dstRow, count);
+            }
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef TEXGAN_PIXEL_OPS_H
+#define TEXGAN_PIXEL_OPS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Post-decode pixel conversion: vertical flip, expansion to RGBA and optional alpha premultiplication,
+// done in the single pass that copies the decoder's output into the image. Kernels exist in scalar,
+// SSE4.1 and AVX2 flavours; the best one the CPU supports is picked at runtime.
+// Everything here is stateless, so any number of decode threads can use it at once.
+namespace texgan::loading{
+    struct PixelOptions {
+        bool flipVertically = true;  // OpenGL expects the bottom row first
+        bool expandToRgba = true;    // 4-byte pixels keep every row aligned for the upload
+        bool premultiplyAlpha = false;
+        bool linearPremultiply = false; // premultiply in linear light, treating colour as sRGB (scalar only)
+    };
+
+    enum class SimdLevel { Scalar, Sse41, Avx2 };
+
+    // Row kernels for one instruction set. `count` is in pixels.
+    struct PixelKernels {
+        SimdLevel level;
+        const char* name;
+        void (*expandRgbToRgba)(const std::uint8_t* src, std::uint8_t* dst, std::size_t count);
+        void (*premultiplyRgba)(std::uint8_t* pixels, std::size_t count);
+        // 2x2 box filter for the next mip level: `count` RGBA pixels of `dst` from 2 * count pixels of
+        // each of two source rows
+        void (*halveRgba)(const std::uint8_t* row0, const std::uint8_t* row1, std::uint8_t* dst, std::size_t count);
+    };
+
+    // Best level this CPU and OS support (and this build contains).
+    SimdLevel detectSimdLevel();
+
+    // Kernels for `level`, or nullptr when this build or CPU lacks them.
+    const PixelKernels* pixelKernels(SimdLevel level);
+
+    // Kernels for detectSimdLevel(), resolved once.
+    const PixelKernels& bestPixelKernels();
+
+    // Channels convertPixels() produces for a `channels`-channel source.
+    int outputChannels(int channels, const PixelOptions& options);
+
+    // Converts a width x height image with `channels` interleaved 8-bit channels from `src` to `dst`, which
+    // must hold width * height * outputChannels(channels, options) bytes. The buffers must not overlap.
+    void convertPixels(const std::uint8_t* src, int width, int height, int channels, std::uint8_t* dst,
+                       const PixelOptions& options, const PixelKernels& kernels = bestPixelKernels());
+}
+
+#endif // TEXGAN_PIXEL_OPS_H
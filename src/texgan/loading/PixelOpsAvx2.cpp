@@ -0,0 +1,129 @@
+// Built with AVX2 enabled; only reached after the runtime check in PixelOps.cpp.
+// Keep standard library headers out of this file: inline functions compiled here could be
+// picked by the linker for callers on CPUs without AVX2.
+#include "PixelOps.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+namespace texgan::loading{
+    namespace {
+        // Two 12-byte groups of RGB, one per 128-bit lane
+        inline __m256i loadRgbPair(const std::uint8_t* src) {
+            __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+            __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 12));
+            return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        }
+
+        void expandRgbToRgbaAvx2(const std::uint8_t* src, std::uint8_t* dst, std::size_t count) {
+            const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                                     0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+            const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+
+            std::size_t i = 0;
+            // 16-byte loads take 12 bytes each, so stop while the last load still ends inside the row
+            for (; i + 18 <= count; i += 16) {
+                const std::uint8_t* s = src + i * 3;
+                __m256i a = _mm256_shuffle_epi8(loadRgbPair(s), shuffle);
+                __m256i b = _mm256_shuffle_epi8(loadRgbPair(s + 24), shuffle);
+                __m256i* out = reinterpret_cast<__m256i*>(dst + i * 4);
+                _mm256_storeu_si256(out + 0, _mm256_or_si256(a, alpha));
+                _mm256_storeu_si256(out + 1, _mm256_or_si256(b, alpha));
+            }
+            for (; i + 10 <= count; i += 8) {
+                __m256i a = _mm256_shuffle_epi8(loadRgbPair(src + i * 3), shuffle);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_or_si256(a, alpha));
+            }
+            for (; i < count; ++i) {
+                dst[i * 4 + 0] = src[i * 3 + 0];
+                dst[i * 4 + 1] = src[i * 3 + 1];
+                dst[i * 4 + 2] = src[i * 3 + 2];
+                dst[i * 4 + 3] = 0xFF;
+            }
+        }
+
+        // c * a / 255 with exact rounding, on 16-bit lanes
+        inline __m256i mulDiv255(__m256i c, __m256i a) {
+            __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(c, a), _mm256_set1_epi16(128));
+            return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+        }
+
+        void premultiplyRgbaAvx2(std::uint8_t* pixels, std::size_t count) {
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i alphaBytes = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+
+            std::size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                __m256i* p = reinterpret_cast<__m256i*>(pixels + i * 4);
+                __m256i px = _mm256_loadu_si256(p);
+
+                // Unpack and pack both work within 128-bit lanes, so the pixel order survives the round trip
+                __m256i lo = _mm256_unpacklo_epi8(px, zero);
+                __m256i hi = _mm256_unpackhi_epi8(px, zero);
+                __m256i alphaLo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+                __m256i alphaHi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+                __m256i scaled = _mm256_packus_epi16(mulDiv255(lo, alphaLo), mulDiv255(hi, alphaHi));
+                // Alpha itself stays as it was
+                _mm256_storeu_si256(p, _mm256_blendv_epi8(scaled, px, alphaBytes));
+            }
+            for (; i < count; ++i) {
+                std::uint8_t* px = pixels + i * 4;
+                unsigned a = px[3];
+                for (int c = 0; c < 3; ++c) {
+                    unsigned t = px[c] * a + 128;
+                    px[c] = static_cast<std::uint8_t>((t + (t >> 8)) >> 8);
+                }
+            }
+        }
+
+        // Eight pixels from each row to the 16-bit channel sums of pixel pairs, both rows added.
+        // Per lane, like the SSE4.1 version: pairs (0+1, 2+3) in the low lane and (4+5, 6+7) in the high one.
+        inline __m256i sumPixelPairs(__m256i a, __m256i b) {
+            const __m256i zero = _mm256_setzero_si256();
+            __m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(b, zero));
+            __m256i hi = _mm256_add_epi16(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(b, zero));
+            lo = _mm256_add_epi16(lo, _mm256_srli_si256(lo, 8));
+            hi = _mm256_add_epi16(hi, _mm256_srli_si256(hi, 8));
+            return _mm256_unpacklo_epi64(lo, hi);
+        }
+
+        void halveRgbaAvx2(const std::uint8_t* row0, const std::uint8_t* row1, std::uint8_t* dst, std::size_t count) {
+            const __m256i rounding = _mm256_set1_epi16(2);
+
+            std::size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                const __m256i* a = reinterpret_cast<const __m256i*>(row0 + i * 8);
+                const __m256i* b = reinterpret_cast<const __m256i*>(row1 + i * 8);
+                __m256i first = sumPixelPairs(_mm256_loadu_si256(a), _mm256_loadu_si256(b));
+                __m256i second = sumPixelPairs(_mm256_loadu_si256(a + 1), _mm256_loadu_si256(b + 1));
+                first = _mm256_srli_epi16(_mm256_add_epi16(first, rounding), 2);
+                second = _mm256_srli_epi16(_mm256_add_epi16(second, rounding), 2);
+                // The pack interleaves the lanes: put the 8-byte output pairs back in order
+                __m256i packed = _mm256_packus_epi16(first, second);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4),
+                                    _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+            }
+            for (; i < count; ++i) {
+                const std::uint8_t* a = row0 + i * 8;
+                const std::uint8_t* b = row1 + i * 8;
+                for (int c = 0; c < 4; ++c) {
+                    dst[i * 4 + c] = static_cast<std::uint8_t>((a[c] + a[c + 4] + b[c] + b[c + 4] + 2) >> 2);
+                }
+            }
+        }
+
+        const PixelKernels kAvx2Kernels{SimdLevel::Avx2, "AVX2", expandRgbToRgbaAvx2, premultiplyRgbaAvx2,
+                                        halveRgbaAvx2};
+    }
+
+    const PixelKernels* avx2PixelKernels() { return &kAvx2Kernels; }
+}
+
+#else
+
+namespace texgan::loading{
+    const PixelKernels* avx2PixelKernels() { return nullptr; }
+}
+
+#endif
@@ -0,0 +1,120 @@
+// Built with SSE4.1 enabled; only reached after the runtime check in PixelOps.cpp.
+// Keep standard library headers out of this file: inline functions compiled here could be
+// picked by the linker for callers on CPUs without SSE4.1.
+#include "PixelOps.h"
+
+#if defined(__SSE4_1__) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+#include <immintrin.h>
+
+namespace texgan::loading{
+    namespace {
+        void expandRgbToRgbaSse41(const std::uint8_t* src, std::uint8_t* dst, std::size_t count) {
+            const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+            const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+            std::size_t i = 0;
+            // 16-byte loads take 12 bytes each, so stop while the last load still ends inside the row
+            for (; i + 18 <= count; i += 16) {
+                const std::uint8_t* s = src + i * 3;
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 12));
+                __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 24));
+                __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 36));
+                __m128i* out = reinterpret_cast<__m128i*>(dst + i * 4);
+                _mm_storeu_si128(out + 0, _mm_or_si128(_mm_shuffle_epi8(a, shuffle), alpha));
+                _mm_storeu_si128(out + 1, _mm_or_si128(_mm_shuffle_epi8(b, shuffle), alpha));
+                _mm_storeu_si128(out + 2, _mm_or_si128(_mm_shuffle_epi8(c, shuffle), alpha));
+                _mm_storeu_si128(out + 3, _mm_or_si128(_mm_shuffle_epi8(d, shuffle), alpha));
+            }
+            for (; i + 6 <= count; i += 4) {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(_mm_shuffle_epi8(a, shuffle), alpha));
+            }
+            for (; i < count; ++i) {
+                dst[i * 4 + 0] = src[i * 3 + 0];
+                dst[i * 4 + 1] = src[i * 3 + 1];
+                dst[i * 4 + 2] = src[i * 3 + 2];
+                dst[i * 4 + 3] = 0xFF;
+            }
+        }
+
+        // c * a / 255 with exact rounding, on 16-bit lanes
+        inline __m128i mulDiv255(__m128i c, __m128i a) {
+            __m128i t = _mm_add_epi16(_mm_mullo_epi16(c, a), _mm_set1_epi16(128));
+            return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+        }
+
+        void premultiplyRgbaSse41(std::uint8_t* pixels, std::size_t count) {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i alphaBytes = _mm_set1_epi32(static_cast<int>(0x80000000u));
+
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                __m128i* p = reinterpret_cast<__m128i*>(pixels + i * 4);
+                __m128i px = _mm_loadu_si128(p);
+
+                __m128i lo = _mm_unpacklo_epi8(px, zero);
+                __m128i hi = _mm_unpackhi_epi8(px, zero);
+                __m128i alphaLo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+                __m128i alphaHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+                __m128i scaled = _mm_packus_epi16(mulDiv255(lo, alphaLo), mulDiv255(hi, alphaHi));
+                // Alpha itself stays as it was
+                _mm_storeu_si128(p, _mm_blendv_epi8(scaled, px, alphaBytes));
+            }
+            for (; i < count; ++i) {
+                std::uint8_t* px = pixels + i * 4;
+                unsigned a = px[3];
+                for (int c = 0; c < 3; ++c) {
+                    unsigned t = px[c] * a + 128;
+                    px[c] = static_cast<std::uint8_t>((t + (t >> 8)) >> 8);
+                }
+            }
+        }
+
+        // Four pixels from each row to the 16-bit channel sums of pixel pairs (0+1, 2+3), both rows added
+        inline __m128i sumPixelPairs(__m128i a, __m128i b) {
+            const __m128i zero = _mm_setzero_si128();
+            __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+            __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+            lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+            hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+            return _mm_unpacklo_epi64(lo, hi);
+        }
+
+        void halveRgbaSse41(const std::uint8_t* row0, const std::uint8_t* row1, std::uint8_t* dst, std::size_t count) {
+            const __m128i rounding = _mm_set1_epi16(2);
+
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const __m128i* a = reinterpret_cast<const __m128i*>(row0 + i * 8);
+                const __m128i* b = reinterpret_cast<const __m128i*>(row1 + i * 8);
+                __m128i first = sumPixelPairs(_mm_loadu_si128(a), _mm_loadu_si128(b));
+                __m128i second = sumPixelPairs(_mm_loadu_si128(a + 1), _mm_loadu_si128(b + 1));
+                first = _mm_srli_epi16(_mm_add_epi16(first, rounding), 2);
+                second = _mm_srli_epi16(_mm_add_epi16(second, rounding), 2);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_packus_epi16(first, second));
+            }
+            for (; i < count; ++i) {
+                const std::uint8_t* a = row0 + i * 8;
+                const std::uint8_t* b = row1 + i * 8;
+                for (int c = 0; c < 4; ++c) {
+                    dst[i * 4 + c] = static_cast<std::uint8_t>((a[c] + a[c + 4] + b[c] + b[c + 4] + 2) >> 2);
+                }
+            }
+        }
+
+        const PixelKernels kSse41Kernels{SimdLevel::Sse41, "SSE4.1", expandRgbToRgbaSse41, premultiplyRgbaSse41,
+                                         halveRgbaSse41};
+    }
+
+    const PixelKernels* sse41PixelKernels() { return &kSse41Kernels; }
+}
+
+#else
+
+namespace texgan::loading{
+    const PixelKernels* sse41PixelKernels() { return nullptr; }
+}
+
+#endif
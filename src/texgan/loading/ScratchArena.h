@@ -0,0 +1,121 @@
+#ifndef TEXGAN_SCRATCH_ARENA_H
+#define TEXGAN_SCRATCH_ARENA_H
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+namespace texgan::loading{
+    // Per-thread scratch memory for stb while a decode is running: the entropy/IDCT and zlib buffers
+    // and the output image. It grows to the largest decode the thread has seen and is reused from then on,
+    // so steady-state decoding leaves the heap alone apart from the final pixel copy.
+    // Outside a Scope allocations go straight to the heap.
+    class ScratchArena {
+    public:
+        static constexpr std::size_t kMaxRetainedBytes = 64ull << 20; // never keep more than this per thread
+
+        static ScratchArena& local() {
+            thread_local ScratchArena arena;
+            return arena;
+        }
+
+        // Everything allocated from the arena during a scope must be freed before it ends
+        class Scope {
+        public:
+            Scope() : m_arena(local()) { m_arena.m_active = true; }
+            ~Scope() { m_arena.reset(); }
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+        private:
+            ScratchArena& m_arena;
+        };
+
+        void* allocate(std::size_t size) {
+            if (!m_active) return std::malloc(size);
+
+            // Each block is prefixed with its size so realloc can copy without being told the old size
+            std::size_t total = kHeader + ((size + kAlign - 1) & ~(kAlign - 1));
+            m_demand += total;
+            if (m_used + total > m_block.size()) return std::malloc(size);
+
+            unsigned char* header = m_block.data() + m_used;
+            std::memcpy(header, &size, sizeof(size));
+            m_used += total;
+            m_last = header + kHeader;
+            return m_last;
+        }
+
+        void* reallocate(void* block, std::size_t size) {
+            if (!block) return allocate(size);
+            if (!owns(block)) return std::realloc(block, size);
+
+            std::size_t oldSize = sizeOf(block);
+            if (block == m_last) {
+                // The newest block can grow in place
+                std::size_t start = static_cast<unsigned char*>(block) - m_block.data();
+                std::size_t end = start + ((size + kAlign - 1) & ~(kAlign - 1));
+                if (end <= m_block.size()) {
+                    m_demand += end > m_used ? end - m_used : 0;
+                    m_used = end;
+                    std::memcpy(static_cast<unsigned char*>(block) - kHeader, &size, sizeof(size));
+                    return block;
+                }
+            }
+
+            void* moved = allocate(size);
+            if (moved) std::memcpy(moved, block, std::min(oldSize, size));
+            return moved;
+        }
+
+        void release(void* block) {
+            if (!block) return;
+            if (!owns(block)) {
+                std::free(block);
+                return;
+            }
+            // Space is reclaimed when the scope ends; the newest block can be handed back now
+            if (block == m_last) {
+                m_used = static_cast<unsigned char*>(block) - m_block.data() - kHeader;
+                m_last = nullptr;
+            }
+        }
+
+        std::size_t capacity() const { return m_block.size(); }
+
+    private:
+        static constexpr std::size_t kAlign = 16;
+        static constexpr std::size_t kHeader = 16; // keeps blocks 16-byte aligned
+
+        bool owns(const void* block) const {
+            auto* p = static_cast<const unsigned char*>(block);
+            return !m_block.empty() && p >= m_block.data() && p < m_block.data() + m_block.size();
+        }
+
+        static std::size_t sizeOf(const void* block) {
+            std::size_t size;
+            std::memcpy(&size, static_cast<const unsigned char*>(block) - kHeader, sizeof(size));
+            return size;
+        }
+
+        void reset() {
+            // Size the block for the largest decode seen, so the next one fits entirely
+            if (m_demand > m_block.size() && m_demand <= kMaxRetainedBytes) {
+                m_block.resize(m_demand);
+            }
+            m_active = false;
+            m_used = 0;
+            m_demand = 0;
+            m_last = nullptr;
+        }
+
+        std::vector<unsigned char> m_block;
+        std::size_t m_used = 0;
+        std::size_t m_demand = 0; // bytes the current scope asked for, whether or not they fit
+        void* m_last = nullptr;
+        bool m_active = false;
+    };
+}
+
+#endif // TEXGAN_SCRATCH_ARENA_H
@@ -0,0 +1,43 @@
+#include "ImageCodec.h"
+#include "ScratchArena.h"
+
+// stb's allocations go through the decoding thread's scratch arena
+#define STBI_MALLOC(size) texgan::loading::ScratchArena::local().allocate(size)
+#define STBI_REALLOC(block, size) texgan::loading::ScratchArena::local().reallocate(block, size)
+#define STBI_FREE(block) texgan::loading::ScratchArena::local().release(block)
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+namespace texgan::loading{
+    namespace {
+        class StbCodec : public ImageCodec {
+        public:
+            const char* name() const override { return "stb_image"; }
+
+            // stb sniffs the format itself and is the fallback for everything
+            bool accepts(const unsigned char*, std::size_t) const override { return true; }
+
+            // The flip (and RGBA expansion) happens while copying out of stb's buffer, instead of through
+            // stbi_set_flip_vertically_on_load, which is process-wide state and costs stb an extra pass.
+            bool decode(const unsigned char* data, std::size_t size, const DecodeOptions& options,
+                        DecodedImage& out) const override {
+                ScratchArena::Scope scratch;
+                int w, h, c;
+                unsigned char* pixels = stbi_load_from_memory(data, static_cast<int>(size), &w, &h, &c, 0);
+                if (!pixels) return false;
+                int channels = outputChannels(c, options.pixels);
+                allocatePixels(out.pixels, w, h, channels, options);
+                convertPixels(pixels, w, h, c, out.pixels.data(), options.pixels);
+                out.width = w;
+                out.height = h;
+                out.channels = channels;
+                stbi_image_free(pixels);
+                return true;
+            }
+        };
+    }
+
+    std::unique_ptr<ImageCodec> makeStbCodec() {
+        return std::make_unique<StbCodec>();
+    }
+}
@@ -0,0 +1,90 @@
+#include "TextureCache.h"
+#include "MipChain.h"
+
+#include <cstring>
+
+namespace texgan::loading{
+    namespace {
+        // Bytes the pixels of a `width` x `height` image with `levels` levels should take
+        std::size_t expectedBytes(const TextureFileHeader& header) {
+            int width = static_cast<int>(header.width);
+            int height = static_cast<int>(header.height);
+            int levels = static_cast<int>(header.levels);
+            if (static_cast<BlockFormat>(header.blocks) == BlockFormat::Bc1) return bc1ChainBytes(width, height, levels);
+            return mipChainBytes(width, height, static_cast<int>(header.channels), levels);
+        }
+    }
+
+    TextureCache::TextureCache(const std::filesystem::path& directory, std::uint64_t maxBytes)
+        : m_files(directory, maxBytes) {}
+
+    std::string TextureCache::keyOf(const unsigned char* payload, std::size_t size, const DecodeOptions& options) {
+        const std::uint32_t settings[] = {
+            TextureFileHeader::kVersion,
+            static_cast<std::uint32_t>(options.targetWidth),
+            static_cast<std::uint32_t>(options.targetHeight),
+            options.mipmaps,
+            static_cast<std::uint32_t>(options.compression),
+            options.pixels.flipVertically,
+            options.pixels.expandToRgba,
+            options.pixels.premultiplyAlpha,
+            options.pixels.linearPremultiply,
+        };
+        aif::ContentHasher hasher;
+        hasher.update(payload, size);
+        hasher.update(reinterpret_cast<const unsigned char*>(settings), sizeof(settings));
+        return hasher.hex();
+    }
+
+    bool TextureCache::load(const std::string& key, PixelStorage* storage, DecodedImage& out) {
+        auto file = m_files.get(key);
+        TextureFileHeader header;
+        if (!file || file->size() < sizeof(header)) {
+            m_misses++;
+            return false;
+        }
+        std::memcpy(&header, file->data(), sizeof(header));
+        bool valid = header.magic == TextureFileHeader::kMagic && header.version == TextureFileHeader::kVersion &&
+                     header.width > 0 && header.height > 0 && header.levels > 0 &&
+                     header.pixelBytes == expectedBytes(header) && file->size() == sizeof(header) + header.pixelBytes;
+        if (!valid) {
+            m_misses++;
+            return false;
+        }
+
+        // The only copy of the pixels: from the mapping to where the upload reads them
+        std::size_t size = static_cast<std::size_t>(header.pixelBytes);
+        out.pixels.reset();
+        if (!storage || !storage->allocate(size, out.pixels)) out.pixels.resize(size);
+        std::memcpy(out.pixels.data(), file->data() + sizeof(header), size);
+        out.width = static_cast<int>(header.width);
+        out.height = static_cast<int>(header.height);
+        out.channels = static_cast<int>(header.channels);
+        out.levels = static_cast<int>(header.levels);
+        out.blocks = static_cast<BlockFormat>(header.blocks);
+
+        m_hits++;
+        m_bytesRead += file->size();
+        return true;
+    }
+
+    void TextureCache::store(const std::string& key, const DecodedImage& image) {
+        TextureFileHeader header;
+        header.sourceHash = std::stoull(key.substr(0, 16), nullptr, 16);
+        header.width = static_cast<std::uint32_t>(image.width);
+        header.height = static_cast<std::uint32_t>(image.height);
+        header.channels = static_cast<std::uint32_t>(image.channels);
+        header.levels = static_cast<std::uint32_t>(image.levels);
+        header.blocks = static_cast<std::uint32_t>(image.blocks);
+        header.pixelBytes = expectedBytes(header);
+        // Codecs may leave the buffer larger than the image (room for a chain that was not built)
+        if (image.pixels.size() < header.pixelBytes) return;
+
+        m_files.put(key, {{reinterpret_cast<const unsigned char*>(&header), sizeof(header)},
+                          {image.pixels.data(), static_cast<std::size_t>(header.pixelBytes)}});
+    }
+
+    TextureCache::Stats TextureCache::stats() const {
+        return {m_hits, m_misses, m_bytesRead, m_files.entryCount(), m_files.totalBytes()};
+    }
+}
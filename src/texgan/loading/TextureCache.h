@@ -0,0 +1,73 @@
+#ifndef TEXGAN_TEXTURE_CACHE_H
+#define TEXGAN_TEXTURE_CACHE_H
+
+#include <atomic>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+#include "ImageCodec.h"
+#include "aif/DiskCache.h"
+
+// GPU-ready textures on disk: what the decode threads made of a payload (flipped, with its mip chain,
+// BC1 blocks if compressed) behind a small header, so an image seen before is never decoded again.
+// Entries are keyed by a SHA-256 of the source bytes and the decode settings, and kept in an
+// aif::DiskCache, which bounds them by size with LRU eviction. Hits are memory-mapped and copied once,
+// straight into the storage the upload reads from (the PBO ring when it has room).
+namespace texgan::loading{
+    // Fixed-size header in front of the pixels. Native byte order: the cache is local to the machine.
+    struct TextureFileHeader {
+        static constexpr std::uint32_t kMagic = 0x43475854; // "TXGC"
+        static constexpr std::uint32_t kVersion = 1;
+
+        std::uint32_t magic = kMagic;
+        std::uint32_t version = kVersion;
+        std::uint64_t sourceHash = 0; // leading 64 bits of the key
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+        std::uint32_t channels = 0;
+        std::uint32_t levels = 0;
+        std::uint32_t blocks = 0; // BlockFormat
+        std::uint32_t reserved = 0;
+        std::uint64_t pixelBytes = 0;
+    };
+    static_assert(sizeof(TextureFileHeader) == 48, "the header is written as is");
+
+    class TextureCache {
+    public:
+        struct Stats {
+            std::uint64_t hits;
+            std::uint64_t misses;
+            std::uint64_t bytesRead;
+            std::size_t entries;
+            std::uint64_t totalBytes;
+        };
+
+        TextureCache(const std::filesystem::path& directory, std::uint64_t maxBytes);
+
+        // Key of `payload` decoded with `options`: a SHA-256 over the source bytes followed by
+        // everything in `options` that changes the pixels
+        static std::string keyOf(const unsigned char* payload, std::size_t size, const DecodeOptions& options);
+
+        // Fills `out` from the entry for `key`, with the pixels in `storage` when it has room. False on a
+        // miss or an unreadable entry. Safe to call from many threads at once.
+        bool load(const std::string& key, PixelStorage* storage, DecodedImage& out);
+
+        // Writes `image` under `key` unless it is already there. Reads the pixels back, so they should
+        // not live in write-combined memory.
+        void store(const std::string& key, const DecodedImage& image);
+
+        void setMaxBytes(std::uint64_t bytes) { m_files.setMaxBytes(bytes); }
+
+        Stats stats() const;
+
+    private:
+        aif::DiskCache m_files;
+        std::atomic<std::uint64_t> m_hits{0};
+        std::atomic<std::uint64_t> m_misses{0};
+        std::atomic<std::uint64_t> m_bytesRead{0};
+    };
+}
+
+#endif // TEXGAN_TEXTURE_CACHE_H
@@ -0,0 +1,73 @@
+#include "UploadScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace texgan::loading{
+    void UploadScheduler::beginFrame() {
+        m_frameMillis = 0.0;
+        m_frameBytes = 0;
+        m_frameUploads = 0;
+    }
+
+    bool UploadScheduler::admit(std::size_t bytes) const {
+        if (m_frameUploads == 0) return true;
+        if (m_budget.bytes > 0 && m_frameBytes + bytes > m_budget.bytes) return false;
+        if (m_budget.millis > 0.0 && m_frameMillis + estimateMillis(bytes) > m_budget.millis) return false;
+        return true;
+    }
+
+    void UploadScheduler::uploaded(std::size_t bytes, std::chrono::steady_clock::duration elapsed) {
+        double millis = std::chrono::duration<double, std::milli>(elapsed).count();
+        m_frameMillis += millis;
+        m_frameBytes += bytes;
+        m_frameUploads++;
+
+        if (bytes == 0) return;
+        double perByte = millis / bytes;
+        m_millisPerByte = m_millisPerByte == 0.0 ? perByte
+                                                 : m_millisPerByte + kCostSmoothing * (perByte - m_millisPerByte);
+    }
+
+    void UploadScheduler::endFrame(std::size_t pending, std::size_t pendingBytes) {
+        m_pending = pending;
+        m_pendingBytes = pendingBytes;
+        m_uploadedLastFrame = m_frameUploads;
+        if (m_frameUploads > 0) {
+            m_lastFrameMillis = m_frameMillis;
+            m_worstFrameMillis = std::max(m_worstFrameMillis, m_frameMillis);
+        }
+
+        // A backlog drains over every frame that uploads something, up to the one that empties it
+        if (m_frameUploads > 0 || pending > 0) m_drainFrames++;
+        if (pending == 0 && m_drainFrames > 0) {
+            m_lastDrainFrames = m_drainFrames;
+            m_drainFrames = 0;
+        }
+    }
+
+    void UploadScheduler::resetStats() {
+        m_lastFrameMillis = 0.0;
+        m_worstFrameMillis = 0.0;
+        m_lastDrainFrames = 0;
+    }
+
+    UploadScheduler::Stats UploadScheduler::stats() const {
+        std::size_t framesToDrain = 0;
+        if (m_pending > 0) {
+            // Bytes one frame gets through under whichever limit is tighter
+            double perFrame = 0.0;
+            if (m_budget.millis > 0.0 && m_millisPerByte > 0.0) perFrame = m_budget.millis / m_millisPerByte;
+            if (m_budget.bytes > 0) {
+                double byBytes = static_cast<double>(m_budget.bytes);
+                perFrame = perFrame > 0.0 ? std::min(perFrame, byBytes) : byBytes;
+            }
+            framesToDrain = perFrame > 0.0 ? static_cast<std::size_t>(std::ceil(m_pendingBytes / perFrame)) : 1;
+            // Every frame takes at least one texture
+            framesToDrain = std::clamp<std::size_t>(framesToDrain, 1, m_pending);
+        }
+
+        return {m_pending, m_pendingBytes, m_uploadedLastFrame, m_lastFrameMillis, m_worstFrameMillis,
+                framesToDrain, m_lastDrainFrames, m_millisPerByte * 1024.0 * 1024.0};
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef TEXGAN_UPLOAD_SCHEDULER_H
+#define TEXGAN_UPLOAD_SCHEDULER_H
+
+#include <chrono>
+#include <cstddef>
+
+// Spreads texture uploads over frames. Each frame may spend a budget of milliseconds and/or bytes on
+// uploads; the scheduler learns what an upload costs per byte and stops admitting textures once the
+// next one would overrun the budget. Whatever is left waits for the following frames.
+// Not thread-safe: it lives on the thread that uploads (the main thread), and so does the UI reading it.
+namespace texgan::loading{
+    struct UploadBudget {
+        double millis = 4.0;   // upload time per frame, 0 for no limit
+        std::size_t bytes = 0; // pixel bytes per frame, 0 for no limit
+    };
+
+    class UploadScheduler {
+    public:
+        struct Stats {
+            std::size_t pending;         // textures waiting for a frame
+            std::size_t pendingBytes;
+            std::size_t uploadedLastFrame;
+            double lastFrameMillis;      // upload time spent in the most recent frame
+            double worstFrameMillis;     // since resetStats()
+            std::size_t framesToDrain;   // estimated frames until the backlog is gone, at the current budget
+            std::size_t lastDrainFrames; // frames the last backlog actually took to clear
+            double millisPerMegabyte;    // learned upload cost
+        };
+
+        explicit UploadScheduler(UploadBudget budget = {}) : m_budget(budget) {}
+
+        void setBudget(const UploadBudget& budget) { m_budget = budget; }
+        const UploadBudget& budget() const { return m_budget; }
+
+        // Per frame: beginFrame(), then upload while admit() allows it, reporting each with uploaded(),
+        // then endFrame() with what is still queued.
+        void beginFrame();
+
+        // Whether a texture of `bytes` still fits this frame. The first one always does, so a texture
+        // costlier than the whole budget cannot stall the queue.
+        bool admit(std::size_t bytes) const;
+
+        void uploaded(std::size_t bytes, std::chrono::steady_clock::duration elapsed);
+
+        void endFrame(std::size_t pending, std::size_t pendingBytes);
+
+        // Clears the worst-frame and drain measurements, e.g. when a new batch starts
+        void resetStats();
+
+        Stats stats() const;
+
+    private:
+        // Weight of the newest sample in the per-byte cost estimate
+        static constexpr double kCostSmoothing = 0.2;
+
+        double estimateMillis(std::size_t bytes) const { return m_millisPerByte * bytes; }
+
+        UploadBudget m_budget;
+        double m_millisPerByte = 0.0; // 0 until the first upload has been measured
+
+        double m_frameMillis = 0.0;
+        std::size_t m_frameBytes = 0;
+        std::size_t m_frameUploads = 0;
+
+        std::size_t m_pending = 0;
+        std::size_t m_pendingBytes = 0;
+        std::size_t m_uploadedLastFrame = 0;
+        double m_lastFrameMillis = 0.0;
+        double m_worstFrameMillis = 0.0;
+        std::size_t m_drainFrames = 0; // frames the current backlog has been draining for
+        std::size_t m_lastDrainFrames = 0;
+    };
+}
+
+#endif // TEXGAN_UPLOAD_SCHEDULER_H
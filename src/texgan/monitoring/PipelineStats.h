@@ -0,0 +1,43 @@
+#ifndef TEXGAN_PIPELINE_STATS_H
+#define TEXGAN_PIPELINE_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Throughput of the fetch -> decode -> upload pipeline, shown in the UI. Every stage records into
+// one process-wide instance, from whichever thread finished the work.
+namespace texgan::monitoring{
+    // Running totals for one stage of the pipeline, updated from any thread
+    struct StageStats {
+        std::atomic<std::uint64_t> items{0};
+        std::atomic<std::uint64_t> bytes{0};
+        std::atomic<std::uint64_t> busyMicros{0}; // summed over threads, so it can exceed wall time
+
+        void record(std::size_t count, std::size_t byteCount, std::chrono::steady_clock::duration busy = {}) {
+            items += count;
+            bytes += byteCount;
+            busyMicros += std::chrono::duration_cast<std::chrono::microseconds>(busy).count();
+        }
+
+        // Average time a single item spent in the stage
+        double millisPerItem() const {
+            std::uint64_t n = items;
+            return n ? busyMicros / 1000.0 / n : 0.0;
+        }
+    };
+
+    struct PipelineStats {
+        StageStats fetch;  // payloads received
+        StageStats decode; // payloads turned into pixels
+        StageStats upload; // textures created
+    };
+
+    inline PipelineStats& pipelineStats() {
+        static PipelineStats stats;
+        return stats;
+    }
+}
+
+#endif // TEXGAN_PIPELINE_STATS_H
@@ -0,0 +1,180 @@
+// Checks the coroutine side of aif, run by ctest.
+//
+// ThreadPoolExecutor runs everything still queued, including work posted by that work and coroutines
+// moved onto it, before its destructor returns. FrameExecutor only runs work when its owner pumps it,
+// leaves work posted meanwhile for the next pump, and runs what is left when destroyed.
+// ImageFetcher::fetch() resumes the awaiting coroutine on the executor it was given, which the test
+// drives offline by replaying payloads from a disk cache. whenAll() hands back the results in the order
+// of its tasks however they finish. Exits non-zero when any check fails.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <filesystem>
+
+#include "aif/Async.h"
+#include "aif/Executor.h"
+#include "aif/ImageFetcher.h"
+
+namespace {
+    int failures = 0;
+
+    void check(bool ok, const std::string& what) {
+        if (!ok) {
+            std::cerr << "FAIL: " << what << "\n";
+            ++failures;
+        }
+    }
+
+    // Pumps `executor` on this thread until `done`, or gives up after a few seconds
+    bool pumpUntil(aif::FrameExecutor& executor, const std::atomic<bool>& done) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!done) {
+            if (std::chrono::steady_clock::now() > deadline) return false;
+            if (executor.runPending() == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    aif::Async<void> hopOnto(aif::ThreadPoolExecutor& pool, std::atomic<bool>& resumed) {
+        co_await aif::resumeOn(pool);
+        resumed = true;
+    }
+
+    aif::Async<void> hopOntoFrame(aif::FrameExecutor& executor, std::atomic<bool>& resumed) {
+        co_await aif::resumeOn(executor);
+        resumed = true;
+    }
+
+    void checkThreadPoolDrain() {
+        std::atomic<int> ran{0};
+        std::atomic<bool> resumed{false};
+        {
+            aif::ThreadPoolExecutor pool(2);
+            // Keeps both threads busy so everything below is still queued when the destructor starts
+            for (int i = 0; i < 2; ++i) {
+                pool.post([]() { std::this_thread::sleep_for(std::chrono::milliseconds(20)); });
+            }
+            for (int i = 0; i < 100; ++i) pool.post([&ran]() { ++ran; });
+            pool.post([&pool, &ran]() { pool.post([&ran]() { ++ran; }); });
+            aif::spawn(hopOnto(pool, resumed));
+        }
+        check(ran == 101, "thread pool: queued work, and work it posts, runs before the destructor returns");
+        check(resumed, "thread pool: a coroutine moved onto the pool is resumed, not leaked");
+    }
+
+    void checkFrameExecutor() {
+        aif::FrameExecutor executor;
+        std::vector<int> ran;
+        executor.post([&]() {
+            ran.push_back(1);
+            executor.post([&]() { ran.push_back(2); });
+        });
+        check(ran.empty(), "frame executor: nothing runs before runPending()");
+        check(executor.runPending() == 1, "frame executor: runPending() runs what was posted before it");
+        check(ran == std::vector<int>{1}, "frame executor: work posted while running waits for the next call");
+        check(executor.runPending() == 1 && ran == std::vector<int>{1, 2}, "frame executor: the next call runs it");
+        check(executor.runPending() == 0, "frame executor: an empty queue runs nothing");
+
+        std::vector<int> leftover;
+        std::atomic<bool> resumed{false};
+        {
+            aif::FrameExecutor dropped;
+            dropped.post([&]() {
+                leftover.push_back(1);
+                dropped.post([&]() { leftover.push_back(2); });
+            });
+            aif::spawn(hopOntoFrame(dropped, resumed));
+        }
+        check(leftover == std::vector<int>{1, 2}, "frame executor: the destructor runs what is left, and what that posts");
+        check(resumed, "frame executor: a coroutine waiting on it is resumed, not leaked");
+    }
+
+    aif::Async<void> awaitFetch(aif::ImageFetcher& fetcher, aif::Executor& executor, std::thread::id& resumedOn,
+                                aif::ImageFetcher::FetchResult& result, std::atomic<bool>& done) {
+        result = co_await fetcher.fetch("http://127.0.0.1:9/unused", aif::Priority::Normal, {}, &executor);
+        resumedOn = std::this_thread::get_id();
+        done = true;
+    }
+
+    void checkFetchResumesOnExecutor() {
+        auto directory = std::filesystem::temp_directory_path() / "aif_async_test";
+        std::filesystem::remove_all(directory);
+
+        std::vector<unsigned char> bytes(1000);
+        for (size_t i = 0; i < bytes.size(); ++i) bytes[i] = static_cast<unsigned char>(i * 7);
+
+        {
+            aif::ImageFetcher fetcher(2);
+            fetcher.enableDiskCache(directory.string(), 1 << 20);
+            fetcher.diskCache()->put(aif::ByteBuffer(std::vector<unsigned char>(bytes)));
+            fetcher.setCacheMode(aif::ImageFetcher::CacheMode::Replay);
+
+            aif::FrameExecutor executor;
+            std::thread::id resumedOn;
+            aif::ImageFetcher::FetchResult result;
+            std::atomic<bool> done{false};
+            aif::spawn(awaitFetch(fetcher, executor, resumedOn, result, done));
+
+            check(pumpUntil(executor, done), "fetch: the coroutine resumes once the executor is pumped");
+            check(resumedOn == std::this_thread::get_id(), "fetch: resumes on the executor's thread, not a fetch thread");
+            check(result.success && std::vector<unsigned char>(result.data.begin(), result.data.end()) == bytes,
+                  "fetch: delivers the replayed payload");
+        }
+        std::filesystem::remove_all(directory);
+    }
+
+    // Finishes after `delay` on a pool thread, so tasks started in order finish out of order
+    aif::Async<int> delayed(aif::ThreadPoolExecutor& pool, int value, std::chrono::milliseconds delay) {
+        co_await aif::resumeOn(pool);
+        std::this_thread::sleep_for(delay);
+        co_return value;
+    }
+
+    aif::Async<void> joinAll(aif::ThreadPoolExecutor& pool, std::vector<int>& results, std::atomic<bool>& done) {
+        std::vector<aif::Async<int>> tasks;
+        for (int i = 0; i < 8; ++i) tasks.push_back(delayed(pool, i, std::chrono::milliseconds((8 - i) * 3)));
+        results = co_await aif::whenAll(std::move(tasks));
+        done = true;
+    }
+
+    void checkWhenAllKeepsOrder() {
+        std::vector<int> results;
+        std::atomic<bool> done{false};
+        {
+            aif::ThreadPoolExecutor pool(4);
+            aif::spawn(joinAll(pool, results, done));
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (!done && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        check(done, "whenAll: resumes once every task has finished");
+        check(results == std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7}, "whenAll: results come back in task order");
+
+        std::atomic<bool> emptyDone{false};
+        std::vector<int> empty{-1};
+        aif::spawn([](std::vector<int>& out, std::atomic<bool>& flag) -> aif::Async<void> {
+            out = co_await aif::whenAll(std::vector<aif::Async<int>>());
+            flag = true;
+        }(empty, emptyDone));
+        check(emptyDone && empty.empty(), "whenAll: no tasks completes at once with no results");
+    }
+}
+
+int main() {
+    checkThreadPoolDrain();
+    checkFrameExecutor();
+    checkFetchResumesOnExecutor();
+    checkWhenAllKeepsOrder();
+
+    if (failures) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "all async checks passed\n";
+    return 0;
+}
@@ -0,0 +1,175 @@
+// Checks decodeImageToMemory() and texgan::loading::DecodePool, run by ctest.
+//
+// Payloads are binary PPMs, which stb decodes in every build. A decoded image is flipped and expanded
+// to RGBA, with its mip chain when asked for. A batch calls back once, with the images that decoded in
+// the order they were given, and releases its keep-alive afterwards. An empty batch calls back at once.
+// With a texture cache the second decode of a payload is a hit. After shutdown() every batch still
+// gets its callback, at once and with no images, and loadCached() reports a miss. Exits non-zero when
+// any check fails.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <future>
+#include <chrono>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <filesystem>
+
+#include "texgan/loading/DecodePool.h"
+#include "texgan/loading/MipChain.h"
+
+namespace {
+    namespace fs = std::filesystem;
+    using namespace texgan::loading;
+
+    int failures = 0;
+
+    void check(bool ok, const std::string& what) {
+        if (!ok) {
+            std::cerr << "FAIL: " << what << "\n";
+            ++failures;
+        }
+    }
+
+    // Polls `done` until it holds, or gives up after a few seconds
+    bool waitFor(const std::function<bool()>& done) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!done()) {
+            if (std::chrono::steady_clock::now() > deadline) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    // A binary PPM whose pixel (x, y) is (seed, y, x)
+    Image ppm(int width, int height, unsigned char seed) {
+        std::string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+        std::vector<unsigned char> bytes(header.begin(), header.end());
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                bytes.insert(bytes.end(), {seed, static_cast<unsigned char>(y), static_cast<unsigned char>(x)});
+            }
+        }
+        return Image(std::move(bytes));
+    }
+
+    Image garbage() {
+        return Image(std::vector<unsigned char>(100, 0xEE));
+    }
+
+    // Decodes `images` on `pool` and waits for the callback
+    std::vector<DecodedImage> decodeAll(DecodePool& pool, Images images, std::shared_ptr<void> keepAlive = {}) {
+        std::promise<std::vector<DecodedImage>> decoded;
+        auto result = decoded.get_future();
+        pool.decode(std::move(images), [&decoded](std::vector<DecodedImage> images) { decoded.set_value(std::move(images)); },
+                    std::move(keepAlive));
+        if (result.wait_for(std::chrono::seconds(5)) != std::future_status::ready) return {};
+        return result.get();
+    }
+
+    void checkDecodeImage() {
+        DecodedImage image;
+        DecodeOptions options;
+        check(decodeImageToMemory(ppm(8, 4, 9), image, options), "decode: a PPM decodes");
+        check(image.width == 8 && image.height == 4 && image.channels == 4 && image.levels == 1,
+              "decode: RGB is expanded to RGBA, without a chain unless asked for");
+        const unsigned char* first = image.pixels.data();
+        check(first[0] == 9 && first[1] == 3 && first[2] == 0 && first[3] == 255, "decode: the bottom row comes first");
+
+        options.mipmaps = true;
+        check(decodeImageToMemory(ppm(8, 4, 9), image, options) && image.levels == mipLevelCount(8, 4) &&
+              image.pixels.size() >= mipChainBytes(8, 4, 4, image.levels), "decode: with mipmaps the chain is built");
+
+        DecodedImage broken;
+        check(!decodeImageToMemory(garbage(), broken, options), "decode: a payload no codec reads fails");
+    }
+
+    void checkBatches() {
+        DecodePool pool(2);
+
+        auto keepAlive = std::make_shared<int>(0);
+        std::weak_ptr<int> kept = keepAlive;
+        Images images;
+        images.push_back(ppm(8, 8, 1));
+        images.push_back(garbage());
+        images.push_back(ppm(16, 4, 2));
+        auto decoded = decodeAll(pool, std::move(images), std::move(keepAlive));
+        check(decoded.size() == 2, "batch: the images that decoded come back, the others are left out");
+        check(decoded.size() == 2 && decoded[0].width == 8 && decoded[1].width == 16, "batch: in the order they were given");
+        check(decoded.size() == 2 && decoded[0].levels == mipLevelCount(8, 8), "batch: mip chains are on by default");
+        check(waitFor([&]() { return kept.expired(); }), "batch: the keep-alive is released after the callback");
+
+        bool called = false;
+        pool.decode({}, [&called](std::vector<DecodedImage> images) { called = images.empty(); });
+        check(called, "batch: an empty batch calls back at once, with no images");
+
+        pool.setMipmaps(false);
+        Images plain;
+        plain.push_back(ppm(8, 8, 3));
+        decoded = decodeAll(pool, std::move(plain));
+        check(decoded.size() == 1 && decoded[0].levels == 1, "batch: setMipmaps(false) applies to later batches");
+    }
+
+    void checkTextureCache(const fs::path& directory) {
+        DecodePool pool(2);
+        auto cache = std::make_shared<TextureCache>(directory, 1 << 20);
+        pool.setTextureCache(cache);
+        check(pool.usesTextureCache(), "cache: set");
+
+        Images first;
+        first.push_back(ppm(8, 8, 4));
+        auto decoded = decodeAll(pool, std::move(first));
+        check(decoded.size() == 1 && !decoded[0].cacheKey.empty(), "cache: a miss is decoded and stored");
+        check(cache->stats().misses == 1 && cache->stats().entries == 1, "cache: counted as a miss");
+
+        Images second;
+        second.push_back(ppm(8, 8, 4));
+        auto again = decodeAll(pool, std::move(second));
+        check(again.size() == 1 && cache->stats().hits == 1, "cache: the same payload is a hit the second time");
+        check(again.size() == 1 && decoded.size() == 1 && again[0].cacheKey == decoded[0].cacheKey &&
+              again[0].pixels.size() == decoded[0].pixels.size() &&
+              std::equal(again[0].pixels.data(), again[0].pixels.data() + again[0].pixels.size(), decoded[0].pixels.data()),
+              "cache: and loads the same pixels");
+
+        std::promise<bool> loaded;
+        pool.loadCached(cache, again.empty() ? std::string() : again[0].cacheKey,
+                        [&loaded](bool ok, DecodedImage) { loaded.set_value(ok); });
+        check(loaded.get_future().get(), "cache: loadCached() reads an entry back");
+    }
+
+    void checkShutdown() {
+        DecodePool pool(2);
+        pool.shutdown();
+
+        bool called = false;
+        Images images;
+        images.push_back(ppm(8, 8, 5));
+        pool.decode(std::move(images), [&called](std::vector<DecodedImage> images) { called = images.empty(); });
+        check(called, "shutdown: a batch still calls back, at once and with no images");
+
+        bool missed = false;
+        pool.loadCached(nullptr, "unused", [&missed](bool ok, DecodedImage) { missed = !ok; });
+        check(missed, "shutdown: loadCached() reports a miss at once");
+    }
+}
+
+int main() {
+    fs::path directory = fs::temp_directory_path() / "texgan_decode_pool_test";
+    fs::remove_all(directory);
+
+    checkDecodeImage();
+    checkBatches();
+    checkTextureCache(directory);
+    checkShutdown();
+
+    fs::remove_all(directory);
+    if (failures) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "all decode pool checks passed\n";
+    return 0;
+}
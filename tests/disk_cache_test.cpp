@@ -0,0 +1,132 @@
+// Checks aif::DiskCache, run by ctest.
+//
+// Entries are named by the SHA-256 of their bytes and read back whole. Over its byte limit the cache
+// evicts the least recently used entries, where a get() counts as a use. Reopening the directory
+// restores the entries, deletes temporaries left by interrupted writes, and misses on files that
+// changed size behind the cache's back. Exits non-zero when any check fails.
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+
+#include "aif/DiskCache.h"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    int failures = 0;
+
+    void check(bool ok, const std::string& what) {
+        if (!ok) {
+            std::cerr << "FAIL: " << what << "\n";
+            ++failures;
+        }
+    }
+
+    aif::ByteBuffer payload(std::size_t size, unsigned seed) {
+        std::vector<unsigned char> bytes(size);
+        for (std::size_t i = 0; i < size; ++i) bytes[i] = static_cast<unsigned char>(seed * 31 + i * 7);
+        return aif::ByteBuffer(std::move(bytes));
+    }
+
+    bool holds(aif::DiskCache& cache, const std::string& key, const aif::ByteBuffer& expected) {
+        auto entry = cache.get(key);
+        return entry && std::vector<unsigned char>(entry->begin(), entry->end()) ==
+                        std::vector<unsigned char>(expected.begin(), expected.end());
+    }
+
+    fs::path entryPath(const fs::path& directory, const std::string& key) {
+        return directory / key.substr(0, 2) / key;
+    }
+
+    void checkContentHash() {
+        std::string abc = "abc";
+        check(aif::contentHash(reinterpret_cast<const unsigned char*>(abc.data()), abc.size()) ==
+              "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", "hash: SHA-256 of \"abc\"");
+
+        // Fed in pieces that straddle the 64-byte blocks, the digest must not change
+        auto data = payload(1000, 3);
+        aif::ContentHasher hasher;
+        for (std::size_t offset = 0; offset < data.size(); offset += 37) {
+            hasher.update(data.data() + offset, std::min<std::size_t>(37, data.size() - offset));
+        }
+        check(hasher.hex() == aif::contentHash(data.data(), data.size()), "hash: incremental and one-shot digests agree");
+        check(aif::DiskCache::keyOf(payload(1000, 3)) != aif::DiskCache::keyOf(payload(1000, 4)),
+              "hash: different payloads get different keys");
+    }
+
+    void checkEviction(const fs::path& directory) {
+        aif::DiskCache cache(directory, 300);
+        auto a = payload(100, 1), b = payload(100, 2), c = payload(100, 3), d = payload(100, 4);
+        std::string keyA = cache.put(a), keyB = cache.put(b), keyC = cache.put(c);
+        check(cache.entryCount() == 3 && cache.totalBytes() == 300, "eviction: entries up to the limit are kept");
+        check(cache.put(a) == keyA && cache.entryCount() == 3, "eviction: storing the same bytes again is a no-op");
+
+        check(holds(cache, keyA, a), "eviction: a stored entry reads back");
+        std::string keyD = cache.put(d);
+        check(!cache.get(keyB), "eviction: the least recently used entry goes first");
+        check(holds(cache, keyA, a) && holds(cache, keyC, c) && holds(cache, keyD, d), "eviction: the others stay");
+        check(cache.totalBytes() == 300, "eviction: the total is back within the limit");
+        check(!fs::exists(entryPath(directory, keyB)), "eviction: the evicted file is deleted");
+
+        // From least to most recently used: A, C, D
+        cache.setMaxBytes(100);
+        check(cache.entryCount() == 1 && holds(cache, keyD, d), "eviction: lowering the limit keeps the most recent");
+
+        aif::DiskCache::Part parts[] = {{a.data(), 40}, {b.data(), 60}};
+        cache.put("composite", {parts[0], parts[1]});
+        auto composite = cache.get("composite");
+        bool joined = composite && composite->size() == 100 &&
+                      std::equal(a.begin(), a.begin() + 40, composite->begin()) &&
+                      std::equal(b.begin(), b.begin() + 60, composite->begin() + 40);
+        check(joined, "parts: written back to back under the given key");
+    }
+
+    void checkReopen(const fs::path& directory) {
+        auto a = payload(100, 5), b = payload(100, 6);
+        std::string keyA, keyB;
+        {
+            aif::DiskCache cache(directory, 1000);
+            keyA = cache.put(a);
+            keyB = cache.put(b);
+        }
+
+        fs::path leftover = entryPath(directory, keyA).parent_path() / (keyA + ".1234.tmp");
+        std::ofstream(leftover, std::ios::binary) << "half a write";
+        fs::resize_file(entryPath(directory, keyB), 50);
+
+        {
+            aif::DiskCache cache(directory, 1000);
+            check(cache.entryCount() == 2, "reopen: the entries are found again");
+            check(!fs::exists(leftover), "reopen: temporaries of interrupted writes are deleted");
+            check(holds(cache, keyA, a), "reopen: an intact entry reads back");
+            // Truncated after it was indexed, so the size on disk no longer matches
+            fs::resize_file(entryPath(directory, keyA), 10);
+            check(!cache.get(keyA), "reopen: a file that changed size is a miss");
+            check(cache.get(keyB) && cache.get(keyB)->size() == 50, "reopen: sizes are taken from the files when opening");
+        }
+
+        aif::DiskCache smaller(directory, 50);
+        check(smaller.totalBytes() <= 50, "reopen: opening with a lower limit evicts down to it");
+    }
+}
+
+int main() {
+    fs::path directory = fs::temp_directory_path() / "aif_disk_cache_test";
+    fs::remove_all(directory);
+
+    checkContentHash();
+    checkEviction(directory / "eviction");
+    checkReopen(directory / "reopen");
+
+    fs::remove_all(directory);
+    if (failures) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "all disk cache checks passed\n";
+    return 0;
+}
@@ -0,0 +1,262 @@
+// Checks the fetcher's queues and streaming batches, run by ctest.
+//
+// MpmcQueue has to keep FIFO order, refuse pushes when full, bulk-push a prefix, and lose nothing
+// between concurrent producers and consumers. ImageFetcher has to hand out tasks by priority and in
+// submission order within a priority, also once a class overflows its ring into the backlog, and
+// report cancelled tasks as failed. A BatchStream never has more than `window` items out until their
+// credits come back, and a cancelled stream still reports every item. The fetcher runs offline,
+// replaying payloads from a disk cache. Exits non-zero when any check fails.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <future>
+#include <filesystem>
+#include <functional>
+
+#include "aif/ImageFetcher.h"
+#include "aif/MpmcQueue.h"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    int failures = 0;
+
+    void check(bool ok, const std::string& what) {
+        if (!ok) {
+            std::cerr << "FAIL: " << what << "\n";
+            ++failures;
+        }
+    }
+
+    // Polls `done` until it holds, or gives up after a few seconds
+    bool waitFor(const std::function<bool()>& done) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!done()) {
+            if (std::chrono::steady_clock::now() > deadline) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    void checkMpmcQueue() {
+        aif::MpmcQueue<int> queue(5);
+        check(queue.capacity() == 8, "queue: capacity is rounded up to a power of two");
+        for (int i = 0; i < 8; ++i) queue.tryPush(int(i));
+        check(!queue.tryPush(8), "queue: a full queue refuses pushes");
+
+        bool fifo = true;
+        int value = -1;
+        for (int i = 0; i < 3; ++i) fifo = fifo && queue.tryPop(value) && value == i;
+        check(fifo, "queue: pops in push order");
+
+        std::vector<int> bulk = {10, 11, 12, 13, 14};
+        check(queue.tryPushBulk(std::span<int>(bulk)) == 3, "queue: a bulk push takes the prefix that fits");
+        std::vector<int> rest;
+        while (queue.tryPop(value)) rest.push_back(value);
+        check(rest == std::vector<int>({3, 4, 5, 6, 7, 10, 11, 12}), "queue: bulk pushes keep their order behind earlier ones");
+
+        // Each producer pushes increasing values, so every consumer must see each producer's values in order
+        constexpr int kProducers = 4, kConsumers = 4, kPerProducer = 20000;
+        aif::MpmcQueue<long> shared(256);
+        std::atomic<long long> sum{0};
+        std::atomic<int> popped{0};
+        std::atomic<bool> ordered{true};
+        std::vector<std::thread> threads;
+        for (int p = 0; p < kProducers; ++p) {
+            threads.emplace_back([&shared, p]() {
+                for (long i = 0; i < kPerProducer; ++i) {
+                    while (!shared.tryPush(long(p) * kPerProducer + i)) std::this_thread::yield();
+                }
+            });
+        }
+        for (int c = 0; c < kConsumers; ++c) {
+            threads.emplace_back([&]() {
+                std::vector<long> last(kProducers, -1);
+                long item;
+                while (popped < kProducers * kPerProducer) {
+                    if (!shared.tryPop(item)) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    auto producer = item / kPerProducer;
+                    if (item <= last[producer]) ordered = false;
+                    last[producer] = item;
+                    sum += item;
+                    ++popped;
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        long long total = static_cast<long long>(kProducers) * kPerProducer;
+        check(popped == total && sum == total * (total - 1) / 2, "queue: concurrent producers and consumers lose nothing");
+        check(ordered, "queue: each producer's items come out in its order");
+    }
+
+    // A fetcher that replays one cached payload for every request
+    struct ReplayFetcher {
+        fs::path directory;
+        aif::ImageFetcher fetcher;
+
+        ReplayFetcher(const std::string& name, std::size_t workers)
+            : directory(fs::temp_directory_path() / name), fetcher(workers) {
+            fs::remove_all(directory);
+            fetcher.enableDiskCache(directory.string(), 1 << 20);
+            fetcher.diskCache()->put(aif::ByteBuffer(std::vector<unsigned char>(64, 0x5A)));
+            fetcher.setCacheMode(aif::ImageFetcher::CacheMode::Replay);
+        }
+
+        ~ReplayFetcher() {
+            fetcher.shutdown();
+            fs::remove_all(directory);
+        }
+    };
+
+    const std::string kUrl = "http://127.0.0.1:9/unused";
+
+    void checkFetcherOrder() {
+        ReplayFetcher replay("aif_fetcher_test_order", 1);
+        auto& fetcher = replay.fetcher;
+
+        // Holds the only worker inside a callback while the rest of the work is queued behind it
+        std::promise<void> release;
+        auto released = release.get_future().share();
+        std::atomic<bool> blocking{false};
+        fetcher.fetchOne(kUrl, [released, &blocking](bool, aif::ByteBuffer) {
+            blocking = true;
+            released.wait();
+        });
+        check(waitFor([&]() { return blocking.load(); }), "order: the worker picks up the first task");
+
+        std::mutex mutex;
+        std::vector<std::string> order;
+        std::atomic<int> finished{0};
+        auto submit = [&](const std::string& label, std::size_t count, aif::Priority priority) {
+            std::vector<std::string> urls(count, kUrl);
+            return fetcher.fetchEach(urls, [&, label](std::size_t i, bool success, aif::ByteBuffer) {
+                std::lock_guard<std::mutex> lock(mutex);
+                order.push_back(label + std::to_string(i) + (success ? "" : "x"));
+                ++finished;
+            }, priority);
+        };
+        // More than a ring holds, so the Normal class spills into the backlog
+        constexpr std::size_t kNormal = aif::MpmcQueue<int>::kDefaultCapacity + 500;
+        submit("p", 3, aif::Priority::Prefetch);
+        submit("n", kNormal, aif::Priority::Normal);
+        submit("v", 3, aif::Priority::Visible);
+        submit("c", 2, aif::Priority::Visible).cancel();
+        release.set_value();
+
+        int expected = static_cast<int>(3 + kNormal + 3 + 2);
+        check(waitFor([&]() { return finished == expected; }), "order: every task completes");
+
+        std::vector<std::string> wanted = {"v0", "v1", "v2", "c0x", "c1x"};
+        for (std::size_t i = 0; i < kNormal; ++i) wanted.push_back("n" + std::to_string(i));
+        for (int i = 0; i < 3; ++i) wanted.push_back("p" + std::to_string(i));
+        std::lock_guard<std::mutex> lock(mutex);
+        check(order == wanted, "order: by priority, first come first served within one, through the backlog too");
+    }
+
+    struct StreamLog {
+        std::mutex mutex;
+        std::vector<aif::BatchItem> held; // credits kept until the test lets them go
+        std::size_t delivered = 0;
+        bool done = false;
+        aif::BatchReport report;
+
+        std::size_t deliveredCount() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return delivered;
+        }
+
+        bool finished() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return done;
+        }
+
+        // Dropping a credit may issue the next request, which may deliver at once: never under the lock
+        void releaseOne() {
+            aif::BatchItem item;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (held.empty()) return;
+                item = std::move(held.front());
+                held.erase(held.begin());
+            }
+        }
+
+        void releaseAll() {
+            std::vector<aif::BatchItem> items;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                items.swap(held);
+            }
+        }
+    };
+
+    aif::CancelToken startStream(aif::ImageFetcher& fetcher, StreamLog& log, std::size_t count, std::size_t window) {
+        aif::StreamOptions options;
+        options.window = window;
+        options.deliverEvery = 1;
+        return fetcher.fetchStream(std::vector<std::string>(count, kUrl), options,
+            [&log](std::vector<aif::BatchItem> items) {
+                std::lock_guard<std::mutex> lock(log.mutex);
+                log.delivered += items.size();
+                for (auto& item : items) log.held.push_back(std::move(item));
+            },
+            [&log](const aif::BatchReport& report) {
+                std::lock_guard<std::mutex> lock(log.mutex);
+                log.report = report;
+                log.done = true;
+            });
+    }
+
+    void checkStreamCredits() {
+        ReplayFetcher replay("aif_fetcher_test_stream", 2);
+
+        StreamLog log;
+        startStream(replay.fetcher, log, 10, 3);
+        check(waitFor([&]() { return log.deliveredCount() == 3; }), "stream: the first window is delivered");
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        check(log.deliveredCount() == 3, "stream: nothing more goes out while the window's credits are held");
+
+        log.releaseOne();
+        check(waitFor([&]() { return log.deliveredCount() == 4; }), "stream: a released credit lets one more through");
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        check(log.deliveredCount() == 4, "stream: and only one");
+
+        check(waitFor([&]() {
+            log.releaseAll();
+            return log.finished();
+        }), "stream: releasing every credit finishes the batch");
+        check(log.report.requested == 10 && log.report.succeeded == 10, "stream: every item is reported as fetched");
+        log.releaseAll();
+
+        StreamLog cancelled;
+        auto token = startStream(replay.fetcher, cancelled, 10, 2);
+        check(waitFor([&]() { return cancelled.deliveredCount() == 2; }), "cancel: the first window is delivered");
+        token.cancel();
+        cancelled.releaseAll();
+        check(waitFor([&]() { return cancelled.finished(); }), "cancel: the done event still comes");
+        check(cancelled.report.requested == 10 && cancelled.report.succeeded == 2 && cancelled.report.failed() == 8,
+              "cancel: the items never issued are reported as failed");
+        cancelled.releaseAll();
+    }
+}
+
+int main() {
+    checkMpmcQueue();
+    checkFetcherOrder();
+    checkStreamCredits();
+
+    if (failures) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "all fetcher checks passed\n";
+    return 0;
+}
@@ -0,0 +1,126 @@
+// Checks the fetcher's flow control, run by ctest.
+//
+// The AIMD controller has to grow by one per success until its first decrease and more slowly after,
+// halve on throttling at most once per round trip, back off when latency inflates, and stay within its
+// bounds. The rate limiter is driven with synthetic time: a bucket serves its burst, then one token per
+// 1/rate, per host, and a pause overrides it. Retry delays have to stay under the exponential ceiling,
+// and a Retry-After has to win. Exits non-zero when any check fails.
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+
+#include "aif/FlowControl.h"
+
+namespace {
+    using namespace std::chrono_literals;
+
+    int failures = 0;
+
+    void check(bool ok, const std::string& what) {
+        if (!ok) {
+            std::cerr << "FAIL: " << what << "\n";
+            ++failures;
+        }
+    }
+
+    void checkAimd() {
+        aif::AimdController controller(2, 1, 10);
+        for (int i = 0; i < 3; ++i) controller.onSuccess(10.0);
+        check(controller.limit() == 5, "aimd: slow start grows by one per success");
+        for (int i = 0; i < 20; ++i) controller.onSuccess(10.0);
+        check(controller.limit() == 10, "aimd: growth stops at the maximum");
+
+        controller.onThrottled();
+        check(controller.limit() == 5, "aimd: throttling halves the limit");
+        controller.onThrottled();
+        check(controller.limit() == 5, "aimd: responses from the same round trip do not cut again");
+        // The hold lasts one smoothed round trip, at least 50 ms
+        std::this_thread::sleep_for(80ms);
+        controller.onThrottled();
+        check(controller.limit() == 2, "aimd: the next round trip may cut again");
+
+        for (int i = 0; i < 3; ++i) controller.onSuccess(10.0);
+        check(controller.limit() == 3, "aimd: after a decrease growth is additive, about one per window");
+
+        for (int i = 0; i < 5; ++i) {
+            std::this_thread::sleep_for(60ms);
+            controller.onThrottled();
+        }
+        check(controller.limit() == 1, "aimd: the limit never drops below the minimum");
+
+        controller.reset(4);
+        controller.setMaximum(3);
+        check(controller.limit() == 3, "aimd: lowering the maximum clamps the limit");
+
+        aif::AimdController inflating(8, 1, 16);
+        inflating.onSuccess(10.0);
+        std::size_t before = inflating.limit();
+        for (int i = 0; i < 3; ++i) inflating.onSuccess(100.0);
+        check(inflating.limit() < before + 3, "aimd: inflated latency stops the growth");
+        check(inflating.smoothedLatencyMs() > 20.0, "aimd: latency is smoothed towards the samples");
+    }
+
+    void checkRateLimiter() {
+        aif::RateLimiter limiter;
+        auto start = aif::Clock::now();
+        check(limiter.acquire("a", start) == aif::Clock::duration::zero(), "rate limiter: unconfigured means unlimited");
+
+        limiter.configure(10.0, 2.0);
+        check(limiter.acquire("a", start) == aif::Clock::duration::zero(), "rate limiter: first token of the burst");
+        check(limiter.acquire("a", start) == aif::Clock::duration::zero(), "rate limiter: second token of the burst");
+        auto wait = limiter.acquire("a", start);
+        check(wait > 90ms && wait <= 101ms, "rate limiter: an empty bucket waits one token's time");
+        check(limiter.acquire("b", start) == aif::Clock::duration::zero(), "rate limiter: hosts have their own buckets");
+        check(limiter.acquire("a", start + 100ms) == aif::Clock::duration::zero(), "rate limiter: the bucket refills over time");
+        check(limiter.acquire("a", start + 100ms) > aif::Clock::duration::zero(), "rate limiter: one token per 1/rate");
+
+        limiter.pauseUntil("b", start + 1s);
+        wait = limiter.acquire("b", start + 250ms);
+        check(wait == 750ms, "rate limiter: a paused host waits out the pause");
+        limiter.pauseUntil("b", start + 500ms);
+        check(limiter.acquire("b", start + 600ms) == 400ms, "rate limiter: a shorter pause does not cut a longer one");
+        check(limiter.acquire("b", start + 1s) == aif::Clock::duration::zero(), "rate limiter: the host resumes after the pause");
+    }
+
+    void checkRetryPolicy() {
+        check(aif::RetryPolicy::retryable(0) && aif::RetryPolicy::retryable(429) && aif::RetryPolicy::retryable(502) &&
+              aif::RetryPolicy::retryable(503) && aif::RetryPolicy::retryable(504),
+              "retry: transport errors, throttling and gateway errors are retried");
+        check(!aif::RetryPolicy::retryable(200) && !aif::RetryPolicy::retryable(404) && !aif::RetryPolicy::retryable(500),
+              "retry: success and client errors are not");
+
+        aif::RetryPolicy policy;
+        policy.configure(0, 100ms, 1000ms);
+        check(policy.maxAttempts() == 1, "retry: at least the first try");
+
+        policy.configure(5, 100ms, 1000ms);
+        bool withinCeiling = true;
+        aif::Clock::duration longest{};
+        for (int attempt = 1; attempt <= 6; ++attempt) {
+            auto ceiling = std::min<aif::Clock::duration>(1000ms, 100ms * (1 << (attempt - 1)));
+            for (int i = 0; i < 200; ++i) {
+                auto delay = policy.delay(attempt, 0s);
+                withinCeiling = withinCeiling && delay >= aif::Clock::duration::zero() && delay <= ceiling;
+                if (attempt == 6) longest = std::max(longest, delay);
+            }
+        }
+        check(withinCeiling, "retry: jittered delays stay within base * 2^(attempt - 1), capped");
+        check(longest > 500ms, "retry: delays spread over the whole range");
+        check(policy.delay(1, 3s) == 3s, "retry: Retry-After takes precedence");
+    }
+}
+
+int main() {
+    checkAimd();
+    checkRateLimiter();
+    checkRetryPolicy();
+
+    if (failures) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "all flow control checks passed\n";
+    return 0;
+}
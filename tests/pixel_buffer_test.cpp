@@ -0,0 +1,135 @@
+// Checks the pooled pixel storage, run by ctest.
+//
+// Sizes between kMinPooledBytes and kMaxPooledBytes map to four classes per power of two, so a block
+// is never more than 25% larger than asked for. Released blocks come back for any size of their class
+// and never for another, the free lists stop growing at kMaxRetainedBytes, and sizes outside the
+// pooled range are allocated exactly. PixelBuffer returns its block to the shared pool when it goes.
+// Exits non-zero when any check fails.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <utility>
+
+#include "texgan/loading/PixelBuffer.h"
+
+namespace {
+    using texgan::loading::PixelBuffer;
+    using texgan::loading::PixelBufferPool;
+
+    int failures = 0;
+
+    void check(bool ok, const std::string& what) {
+        if (!ok) {
+            std::cerr << "FAIL: " << what << "\n";
+            ++failures;
+        }
+    }
+
+    void checkSizeClasses() {
+        PixelBufferPool pool;
+        std::size_t capacity = 0;
+
+        unsigned char* block = pool.acquire(PixelBufferPool::kMinPooledBytes, capacity);
+        check(capacity == PixelBufferPool::kMinPooledBytes, "classes: the smallest class is exact");
+        pool.release(block, capacity);
+        block = pool.acquire(PixelBufferPool::kMinPooledBytes + 1, capacity);
+        check(capacity == PixelBufferPool::kMinPooledBytes + PixelBufferPool::kMinPooledBytes / 4,
+              "classes: the next class is a quarter octave up");
+        pool.release(block, capacity);
+
+        std::mt19937 random(7);
+        std::uniform_int_distribution<std::size_t> sizes(PixelBufferPool::kMinPooledBytes, 16u << 20);
+        bool tight = true;
+        for (int i = 0; i < 200; ++i) {
+            std::size_t size = sizes(random);
+            block = pool.acquire(size, capacity);
+            tight = tight && capacity >= size && capacity <= size + size / 4;
+            pool.release(block, capacity);
+        }
+        check(tight, "classes: a block is at least the size asked for and at most 25% more");
+
+        block = pool.acquire(1000, capacity);
+        check(capacity == 1000, "classes: blocks below the pooled range are exact");
+        pool.release(block, capacity);
+        block = pool.acquire(PixelBufferPool::kMaxPooledBytes + 1, capacity);
+        check(capacity == PixelBufferPool::kMaxPooledBytes + 1, "classes: blocks above the pooled range are exact");
+        pool.release(block, capacity);
+        pool.trim();
+    }
+
+    void checkReuse() {
+        PixelBufferPool pool;
+        std::size_t capacity = 0;
+
+        unsigned char* first = pool.acquire(1000000, capacity);
+        std::size_t firstCapacity = capacity;
+        pool.release(first, capacity);
+        check(pool.stats().retainedBytes == firstCapacity, "reuse: a released block is kept");
+
+        unsigned char* second = pool.acquire(firstCapacity - 1000, capacity);
+        check(second == first && capacity == firstCapacity, "reuse: any size of the class gets the block back");
+        check(pool.stats().reuses == 1 && pool.stats().allocations == 1, "reuse: counted as a reuse, not an allocation");
+
+        unsigned char* other = pool.acquire(firstCapacity + 1, capacity);
+        check(other != second && pool.stats().allocations == 2, "reuse: a larger class allocates");
+        pool.release(second, firstCapacity);
+        pool.release(other, capacity);
+
+        std::size_t unpooled = 0;
+        unsigned char* small = pool.acquire(100, unpooled);
+        std::size_t retained = pool.stats().retainedBytes;
+        pool.release(small, unpooled);
+        check(pool.stats().retainedBytes == retained, "reuse: unpooled blocks are freed, not kept");
+
+        pool.trim();
+        check(pool.stats().retainedBytes == 0, "reuse: trim() frees every kept block");
+
+        // Blocks are never touched here, so this only reserves address space
+        std::vector<std::pair<unsigned char*, std::size_t>> large;
+        for (int i = 0; i < 3; ++i) {
+            unsigned char* block = pool.acquire(PixelBufferPool::kMaxRetainedBytes / 2, capacity);
+            large.push_back({block, capacity});
+        }
+        for (auto [block, size] : large) pool.release(block, size);
+        check(pool.stats().retainedBytes <= PixelBufferPool::kMaxRetainedBytes, "reuse: kept blocks stay within the budget");
+        pool.trim();
+    }
+
+    void checkPixelBuffer() {
+        PixelBufferPool& pool = PixelBufferPool::shared();
+        pool.trim();
+        auto before = pool.stats();
+
+        unsigned char* data = nullptr;
+        {
+            PixelBuffer buffer(300000);
+            check(buffer.size() == 300000 && buffer.data() != nullptr, "buffer: sized on construction");
+            data = buffer.data();
+
+            PixelBuffer moved(std::move(buffer));
+            check(buffer.empty() && buffer.data() == nullptr && moved.data() == data, "buffer: moving hands over the block");
+        }
+        check(pool.stats().retainedBytes > before.retainedBytes, "buffer: the block goes back to the shared pool");
+
+        PixelBuffer again(290000);
+        check(again.data() == data && pool.stats().reuses == before.reuses + 1, "buffer: the next image of its class reuses it");
+        again.reset();
+        check(again.empty(), "buffer: reset() leaves it empty");
+        pool.trim();
+    }
+}
+
+int main() {
+    checkSizeClasses();
+    checkReuse();
+    checkPixelBuffer();
+
+    if (failures) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "all pixel buffer checks passed\n";
+    return 0;
+}
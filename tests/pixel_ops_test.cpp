@@ -0,0 +1,172 @@
+// Checks the post-decode pixel kernels, run by ctest.
+//
+// Every SIMD level the CPU supports has to reproduce the scalar output byte for byte (flip, RGB to
+// RGBA, premultiplied alpha, mip chains), at sizes that are not a multiple of any vector width. The
+// BC1 encoder has to round-trip a smooth pattern above a PSNR floor with each preset, and encode a
+// flat block that RGB565 represents exactly without loss. Exits non-zero on the first failing group.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+#include "texgan/loading/PixelOps.h"
+#include "texgan/loading/MipChain.h"
+#include "texgan/loading/BlockCompression.h"
+
+namespace {
+    using texgan::loading::PixelOptions;
+    using texgan::loading::PixelKernels;
+    using texgan::loading::SimdLevel;
+    using texgan::loading::CompressionPreset;
+
+    int failures = 0;
+
+    void check(bool ok, const std::string& what) {
+        if (!ok) {
+            std::cerr << "FAIL: " << what << "\n";
+            ++failures;
+        }
+    }
+
+    std::vector<unsigned char> randomBytes(size_t count, unsigned seed) {
+        std::vector<unsigned char> bytes(count);
+        std::mt19937 random(seed);
+        for (auto& byte : bytes) byte = static_cast<unsigned char>(random());
+        // Some fully opaque and fully transparent pixels, which the premultiply kernels special-case
+        for (size_t i = 3; i < count; i += 28) bytes[i] = 0xFF;
+        for (size_t i = 7; i < count; i += 52) bytes[i] = 0;
+        return bytes;
+    }
+
+    // PSNR over the colour channels of two RGBA images
+    double psnr(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b, size_t pixelCount) {
+        double squaredError = 0.0;
+        for (size_t i = 0; i < pixelCount * 4; ++i) {
+            if (i % 4 == 3) continue;
+            double difference = double(a[i]) - b[i];
+            squaredError += difference * difference;
+        }
+        return 10.0 * std::log10(255.0 * 255.0 / std::max(squaredError / (pixelCount * 3), 1e-9));
+    }
+
+    void checkScalarReference() {
+        // 2x2 RGB, rows flipped and expanded
+        const unsigned char rgb[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+        const unsigned char flipped[] = {7, 8, 9, 255, 10, 11, 12, 255, 1, 2, 3, 255, 4, 5, 6, 255};
+        unsigned char out[16] = {};
+        texgan::loading::convertPixels(rgb, 2, 2, 3, out, PixelOptions{},
+                                       *texgan::loading::pixelKernels(SimdLevel::Scalar));
+        check(std::equal(out, out + 16, flipped), "scalar flip + RGB to RGBA");
+
+        check(texgan::loading::mipLevelCount(1024, 1024) == 11, "mipLevelCount(1024, 1024)");
+        check(texgan::loading::mipLevelCount(1023, 517) == 10, "mipLevelCount(1023, 517)");
+        check(texgan::loading::mipLevelCount(1, 1) == 1, "mipLevelCount(1, 1)");
+        check(texgan::loading::mipChainBytes(4, 2, 4, 3) == (8 + 2 + 1) * 4, "mipChainBytes(4, 2)");
+        check(texgan::loading::bc1ChainBytes(8, 8, 4) == (4 + 1 + 1 + 1) * texgan::loading::kBc1BlockBytes,
+              "bc1ChainBytes(8, 8)");
+    }
+
+    void checkKernels(int width, int height) {
+        std::string size = std::to_string(width) + "x" + std::to_string(height);
+        size_t pixelCount = static_cast<size_t>(width) * height;
+        std::vector<unsigned char> rgb = randomBytes(pixelCount * 3, 1);
+        std::vector<unsigned char> rgba = randomBytes(pixelCount * 4, 2);
+
+        PixelOptions expand;
+        PixelOptions unflipped;
+        unflipped.flipVertically = false;
+        PixelOptions premultiply;
+        premultiply.premultiplyAlpha = true;
+
+        const PixelKernels& scalar = *texgan::loading::pixelKernels(SimdLevel::Scalar);
+        std::vector<unsigned char> expected(pixelCount * 4), expectedUnflipped(pixelCount * 4);
+        std::vector<unsigned char> expectedPremultiplied(pixelCount * 4), out(pixelCount * 4);
+        texgan::loading::convertPixels(rgb.data(), width, height, 3, expected.data(), expand, scalar);
+        texgan::loading::convertPixels(rgb.data(), width, height, 3, expectedUnflipped.data(), unflipped, scalar);
+        texgan::loading::convertPixels(rgba.data(), width, height, 4, expectedPremultiplied.data(), premultiply,
+                                       scalar);
+
+        int levels = texgan::loading::mipLevelCount(width, height);
+        std::vector<unsigned char> expectedChain(texgan::loading::mipChainBytes(width, height, 4, levels));
+        std::copy(rgba.begin(), rgba.end(), expectedChain.begin());
+        texgan::loading::buildMipChain(expectedChain.data(), width, height, 4, levels, scalar);
+
+        for (SimdLevel level : {SimdLevel::Sse41, SimdLevel::Avx2}) {
+            const PixelKernels* kernels = texgan::loading::pixelKernels(level);
+            if (!kernels) {
+                std::cout << "(" << (level == SimdLevel::Sse41 ? "SSE4.1" : "AVX2") << " not available)\n";
+                continue;
+            }
+            std::string name = std::string(kernels->name) + " " + size;
+
+            texgan::loading::convertPixels(rgb.data(), width, height, 3, out.data(), expand, *kernels);
+            check(out == expected, name + ": flip + RGB to RGBA");
+
+            texgan::loading::convertPixels(rgb.data(), width, height, 3, out.data(), unflipped, *kernels);
+            check(out == expectedUnflipped, name + ": RGB to RGBA");
+
+            texgan::loading::convertPixels(rgba.data(), width, height, 4, out.data(), premultiply, *kernels);
+            check(out == expectedPremultiplied, name + ": flip + premultiply");
+
+            std::vector<unsigned char> chain(expectedChain.size());
+            std::copy(rgba.begin(), rgba.end(), chain.begin());
+            texgan::loading::buildMipChain(chain.data(), width, height, 4, levels, *kernels);
+            check(chain == expectedChain, name + ": mip chain");
+        }
+    }
+
+    void checkBc1(int width, int height) {
+        std::string size = std::to_string(width) + "x" + std::to_string(height);
+        size_t pixelCount = static_cast<size_t>(width) * height;
+        int levels = texgan::loading::mipLevelCount(width, height);
+        std::vector<unsigned char> pattern(texgan::loading::mipChainBytes(width, height, 4, levels));
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                unsigned char* pixel = pattern.data() + (static_cast<size_t>(y) * width + x) * 4;
+                pixel[0] = static_cast<unsigned char>(128 + 100 * std::sin(x * 0.01 + y * 0.003));
+                pixel[1] = static_cast<unsigned char>(128 + 90 * std::sin(x * 0.02) * std::cos(y * 0.01));
+                pixel[2] = static_cast<unsigned char>(x * 255 / width);
+                pixel[3] = 255;
+            }
+        }
+        texgan::loading::buildMipChain(pattern.data(), width, height, 4, levels);
+
+        std::vector<unsigned char> blocks(texgan::loading::bc1ChainBytes(width, height, levels));
+        std::vector<unsigned char> out(pixelCount * 4);
+        for (auto preset : {CompressionPreset::Fast, CompressionPreset::Quality}) {
+            std::string name = std::string(preset == CompressionPreset::Fast ? "BC1 fast " : "BC1 quality ") + size;
+            texgan::loading::compressBc1Chain(pattern.data(), width, height, 4, levels, blocks.data(), preset);
+            texgan::loading::decompressBc1(blocks.data(), width, height, out.data());
+            double db = psnr(out, pattern, pixelCount);
+            check(db > 35.0, name + ": PSNR " + std::to_string(db) + " dB");
+
+            // Flat 565-exact colour: every pixel must come back unchanged
+            std::vector<unsigned char> flat(16 * 4);
+            for (size_t i = 0; i < flat.size(); i += 4) {
+                flat[i] = 0xFF; flat[i + 1] = 0x82; flat[i + 2] = 0x10; flat[i + 3] = 0xFF;
+            }
+            unsigned char block[texgan::loading::kBc1BlockBytes];
+            std::vector<unsigned char> decoded(flat.size());
+            texgan::loading::compressBc1(flat.data(), 4, 4, 4, block, preset);
+            texgan::loading::decompressBc1(block, 4, 4, decoded.data());
+            check(decoded == flat, name + ": flat block");
+        }
+    }
+}
+
+int main() {
+    checkScalarReference();
+    // Widths that leave a remainder after every vector width, plus a single pixel and a single row
+    for (auto [width, height] : {std::pair{1024, 1024}, {1023, 517}, {37, 19}, {1, 1}, {257, 1}}) {
+        checkKernels(width, height);
+    }
+    checkBc1(256, 256);
+    checkBc1(61, 30);
+
+    std::cout << (failures ? "FAILED" : "passed") << " (best kernels: "
+              << texgan::loading::bestPixelKernels().name << ")\n";
+    return failures ? 1 : 0;
+}
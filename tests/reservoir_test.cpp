@@ -0,0 +1,151 @@
+// Checks texgan::loading::DecodedImageReservoir, run by ctest.
+//
+// The reservoir fetches nothing until it is armed, then refills to its target and serves take() from
+// what is ready, counting the images it could not serve as misses. Lowering the target or the memory
+// budget drops images until it fits. Prefetches that were issued before clear() are dropped when they
+// arrive, and refilling still reaches the target afterwards. The fetcher runs offline, replaying a PPM
+// from a disk cache, and refills continue on a FrameExecutor pumped by the test. Exits non-zero when any
+// check fails.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <filesystem>
+
+#include "texgan/loading/DecodedImageReservoir.h"
+
+namespace {
+    namespace fs = std::filesystem;
+    using texgan::loading::DecodedImageReservoir;
+    using texgan::loading::DecodePool;
+
+    // 8x8 RGB, decoded to RGBA without a chain
+    constexpr int kEdge = 8;
+    constexpr std::size_t kImageBytes = kEdge * kEdge * 4;
+
+    int failures = 0;
+
+    void check(bool ok, const std::string& what) {
+        if (!ok) {
+            std::cerr << "FAIL: " << what << "\n";
+            ++failures;
+        }
+    }
+
+    aif::ByteBuffer ppm() {
+        std::string header = "P6\n" + std::to_string(kEdge) + " " + std::to_string(kEdge) + "\n255\n";
+        std::vector<unsigned char> bytes(header.begin(), header.end());
+        bytes.resize(bytes.size() + kEdge * kEdge * 3, 0x80);
+        return aif::ByteBuffer(std::move(bytes));
+    }
+
+    // What the app does: refill while idle and run the continuations once per frame
+    struct Harness {
+        fs::path directory = fs::temp_directory_path() / "texgan_reservoir_test";
+        aif::FrameExecutor frames;
+        DecodePool decoder{2};
+        aif::ImageFetcher fetcher{2};
+        DecodedImageReservoir reservoir{fetcher, decoder, frames, "http://127.0.0.1:9/unused", 4, 1 << 20};
+
+        Harness() {
+            fs::remove_all(directory);
+            decoder.setMipmaps(false);
+            fetcher.enableDiskCache(directory.string(), 1 << 20);
+            fetcher.diskCache()->put(ppm());
+            fetcher.setCacheMode(aif::ImageFetcher::CacheMode::Replay);
+        }
+
+        ~Harness() {
+            reservoir.clear();
+            fetcher.shutdown();
+            while (frames.runPending() > 0) {}
+            decoder.shutdown();
+            fs::remove_all(directory);
+        }
+
+        // Runs frames for `duration`, refilling in each when `refill`
+        void runFor(std::chrono::milliseconds duration, bool refill = true) {
+            auto end = std::chrono::steady_clock::now() + duration;
+            while (std::chrono::steady_clock::now() < end) {
+                if (refill) reservoir.refill();
+                frames.runPending();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        // Runs frames until the reservoir holds `count` images, or gives up after a few seconds
+        bool fillTo(std::size_t count) {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (reservoir.size() < count) {
+                if (std::chrono::steady_clock::now() > deadline) return false;
+                runFor(std::chrono::milliseconds(1));
+            }
+            return true;
+        }
+    };
+
+    void checkArming(Harness& harness) {
+        auto& reservoir = harness.reservoir;
+        harness.runFor(std::chrono::milliseconds(50));
+        check(!reservoir.armed() && reservoir.size() == 0, "arming: nothing is fetched before arm()");
+
+        reservoir.arm();
+        check(harness.fillTo(4), "arming: once armed, it refills to the target");
+        harness.runFor(std::chrono::milliseconds(50));
+        check(reservoir.size() == 4 && reservoir.bytes() == 4 * kImageBytes, "arming: and no further");
+    }
+
+    void checkTake(Harness& harness) {
+        auto& reservoir = harness.reservoir;
+        auto taken = reservoir.take(3);
+        check(taken.size() == 3 && taken[0].width == kEdge && reservoir.size() == 1, "take: hands out ready images");
+        taken = reservoir.take(3);
+        check(taken.size() == 1 && reservoir.size() == 0, "take: no more than it holds");
+        check(reservoir.hitRate() == 4.0 / 6.0, "take: the images it could not serve count as misses");
+
+        check(harness.fillTo(4), "take: refills what was taken");
+        reservoir.setTarget(2);
+        check(reservoir.size() == 2 && reservoir.bytes() == 2 * kImageBytes, "trim: a lower target drops images");
+        reservoir.setTarget(4);
+        check(harness.fillTo(4), "trim: a higher target refills");
+        reservoir.setMemoryBudget(kImageBytes * 3 - 1);
+        check(reservoir.size() == 2 && reservoir.bytes() <= reservoir.memoryBudget(), "trim: a lower budget drops images");
+        harness.runFor(std::chrono::milliseconds(50));
+        check(reservoir.size() == 2, "trim: refills stay within the budget");
+        reservoir.setMemoryBudget(1 << 20);
+    }
+
+    void checkClear(Harness& harness) {
+        auto& reservoir = harness.reservoir;
+        check(harness.fillTo(4), "clear: filled");
+        reservoir.clear();
+        check(reservoir.size() == 0 && reservoir.bytes() == 0, "clear: drops the ready images");
+
+        // Issued, then replayed by the fetcher while no frame runs their continuations
+        reservoir.refill();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        reservoir.clear();
+        harness.runFor(std::chrono::milliseconds(100), false);
+        check(reservoir.size() == 0, "clear: prefetches issued before it are dropped when they arrive");
+
+        check(harness.fillTo(4), "clear: refilling afterwards still reaches the target");
+    }
+}
+
+int main() {
+    {
+        Harness harness;
+        checkArming(harness);
+        checkTake(harness);
+        checkClear(harness);
+    }
+
+    if (failures) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "all reservoir checks passed\n";
+    return 0;
+}
@@ -0,0 +1,126 @@
+// Checks texgan::loading::ScratchArena, run by ctest.
+//
+// Inside a Scope the thread's arena hands out 16-byte aligned blocks by bumping a pointer, grows the
+// newest block in place and takes it back when it is freed. What does not fit goes to malloc, and the
+// block is sized for that demand when the scope ends, so the next scope of the same size fits
+// entirely. Outside a scope every allocation comes from the heap. Exits non-zero when any check fails.
+
+#include <iostream>
+#include <string>
+#include <cstdint>
+#include <cstring>
+
+#include "texgan/loading/ScratchArena.h"
+
+namespace {
+    using texgan::loading::ScratchArena;
+
+    int failures = 0;
+
+    void check(bool ok, const std::string& what) {
+        if (!ok) {
+            std::cerr << "FAIL: " << what << "\n";
+            ++failures;
+        }
+    }
+
+    bool aligned(const void* block) {
+        return reinterpret_cast<std::uintptr_t>(block) % 16 == 0;
+    }
+
+    // Whether `block` lies within the arena, given `first`, the first block of a scope (just past its header)
+    bool inArena(const void* block, const void* first, std::size_t capacity) {
+        auto offset = static_cast<const unsigned char*>(block) - static_cast<const unsigned char*>(first);
+        return offset >= 0 && static_cast<std::size_t>(offset) < capacity;
+    }
+
+    void checkOutsideScope() {
+        ScratchArena& arena = ScratchArena::local();
+        std::size_t before = arena.capacity();
+        void* block = arena.allocate(1000);
+        check(block != nullptr, "no scope: allocation succeeds");
+        block = arena.reallocate(block, 5000);
+        std::memset(block, 0x11, 5000);
+        arena.release(block);
+        check(arena.capacity() == before, "no scope: the heap serves it, the arena does not grow");
+    }
+
+    void checkScopes() {
+        ScratchArena& arena = ScratchArena::local();
+        {
+            // The arena is empty on this thread, so everything in the first scope goes to malloc
+            ScratchArena::Scope scope;
+            void* a = arena.allocate(100);
+            void* b = arena.allocate(3000);
+            void* c = arena.allocate(1000);
+            std::memset(a, 1, 100);
+            std::memset(b, 2, 3000);
+            std::memset(c, 3, 1000);
+            arena.release(c);
+            arena.release(b);
+            arena.release(a);
+        }
+        std::size_t capacity = arena.capacity();
+        check(capacity >= 4100, "scope: the block is sized for what the scope asked for");
+
+        {
+            ScratchArena::Scope scope;
+            void* a = arena.allocate(100);
+            void* b = arena.allocate(3000);
+            check(aligned(a) && aligned(b), "scope: blocks are 16-byte aligned");
+            check(b > a && inArena(b, a, capacity), "scope: the same demand now fits the arena, bumped in order");
+            std::memset(b, 3, 3000);
+
+            void* grown = arena.reallocate(b, 3500);
+            check(grown == b, "scope: the newest block grows in place");
+
+            arena.release(grown);
+            void* reused = arena.allocate(200);
+            check(reused == b, "scope: the newest block's space is handed out again once freed");
+
+            // An older block cannot grow in place: it moves, keeping its contents
+            std::memset(a, 7, 100);
+            void* moved = arena.reallocate(a, 150);
+            bool kept = moved != a && inArena(moved, a, capacity);
+            for (int i = 0; i < 100; ++i) kept = kept && static_cast<unsigned char*>(moved)[i] == 7;
+            check(kept, "scope: an older block moves within the arena and keeps its contents");
+
+            void* large = arena.allocate(capacity * 2);
+            check(large != nullptr && !inArena(large, a, capacity), "scope: what does not fit comes from the heap");
+            std::memset(large, 4, capacity * 2);
+            arena.release(large);
+            arena.release(moved);
+            arena.release(reused);
+            arena.release(a);
+        }
+        check(arena.capacity() > capacity, "scope: an overflowing scope grows the block for the next one");
+
+        void* first = nullptr;
+        {
+            ScratchArena::Scope scope;
+            first = arena.allocate(100);
+            void* second = arena.allocate(100);
+            check(inArena(second, first, arena.capacity()), "scope: the grown block serves the next scope");
+        }
+        {
+            ScratchArena::Scope scope;
+            check(arena.allocate(100) == first, "scope: every scope starts at the beginning of the block");
+        }
+
+        void* outside = arena.allocate(64);
+        check(outside != nullptr && !inArena(outside, first, arena.capacity()), "scope: after the scope, the heap again");
+        arena.release(outside);
+    }
+}
+
+int main() {
+    checkOutsideScope();
+    checkScopes();
+
+    if (failures) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "all scratch arena checks passed\n";
+    return 0;
+}
@@ -0,0 +1,144 @@
+// Checks texgan::loading::TextureCache, run by ctest.
+//
+// Keys are a SHA-256 over the payload and the decode settings, so changing either gives another key.
+// An entry stored from a decoded image loads back with its header fields and pixels. Entries whose
+// header has the wrong magic or version, or whose sizes do not add up, are misses, and store() skips
+// images whose pixels are smaller than the header says. Exits non-zero when any check fails.
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+#include "texgan/loading/TextureCache.h"
+#include "texgan/loading/MipChain.h"
+
+namespace {
+    namespace fs = std::filesystem;
+    using texgan::loading::DecodedImage;
+    using texgan::loading::DecodeOptions;
+    using texgan::loading::TextureCache;
+    using texgan::loading::TextureFileHeader;
+
+    int failures = 0;
+
+    void check(bool ok, const std::string& what) {
+        if (!ok) {
+            std::cerr << "FAIL: " << what << "\n";
+            ++failures;
+        }
+    }
+
+    // A width x height RGBA image with its full mip chain, filled with a pattern
+    DecodedImage makeImage(int width, int height, unsigned seed) {
+        DecodedImage image;
+        image.width = width;
+        image.height = height;
+        image.channels = 4;
+        image.levels = texgan::loading::mipLevelCount(width, height);
+        image.pixels.resize(texgan::loading::mipChainBytes(width, height, 4, image.levels));
+        for (std::size_t i = 0; i < image.pixels.size(); ++i) image.pixels.data()[i] = static_cast<unsigned char>(seed + i * 13);
+        return image;
+    }
+
+    bool samePixels(const DecodedImage& a, const DecodedImage& b) {
+        return a.pixels.size() == b.pixels.size() && std::memcmp(a.pixels.data(), b.pixels.data(), a.pixels.size()) == 0;
+    }
+
+    fs::path entryPath(const fs::path& directory, const std::string& key) {
+        return directory / key.substr(0, 2) / key;
+    }
+
+    // Overwrites the 32-bit header field at `offset` of the entry for `key`
+    void patchHeader(const fs::path& directory, const std::string& key, std::size_t offset, std::uint32_t value) {
+        std::fstream file(entryPath(directory, key), std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void checkKeys() {
+        std::vector<unsigned char> payload(500, 0x42), other(500, 0x43);
+        DecodeOptions options;
+        std::string key = TextureCache::keyOf(payload.data(), payload.size(), options);
+        check(key.size() == 64, "keys: a hex SHA-256");
+        check(TextureCache::keyOf(payload.data(), payload.size(), options) == key, "keys: the same input gives the same key");
+        check(TextureCache::keyOf(other.data(), other.size(), options) != key, "keys: another payload gives another key");
+
+        DecodeOptions mipmapped = options;
+        mipmapped.mipmaps = true;
+        DecodeOptions smaller = options;
+        smaller.targetWidth = smaller.targetHeight = 256;
+        DecodeOptions unflipped = options;
+        unflipped.pixels.flipVertically = false;
+        check(TextureCache::keyOf(payload.data(), payload.size(), mipmapped) != key &&
+              TextureCache::keyOf(payload.data(), payload.size(), smaller) != key &&
+              TextureCache::keyOf(payload.data(), payload.size(), unflipped) != key,
+              "keys: settings that change the pixels change the key");
+    }
+
+    void checkRoundTrip(const fs::path& directory) {
+        TextureCache cache(directory, 1 << 20);
+        DecodedImage image = makeImage(16, 8, 1);
+        std::string key(64, 'a');
+        cache.store(key, image);
+        check(cache.stats().entries == 1, "round trip: the entry is written");
+
+        DecodedImage loaded;
+        check(cache.load(key, nullptr, loaded), "round trip: the entry loads");
+        check(loaded.width == 16 && loaded.height == 8 && loaded.channels == 4 && loaded.levels == image.levels &&
+              loaded.blocks == texgan::loading::BlockFormat::None, "round trip: the header fields come back");
+        check(samePixels(loaded, image), "round trip: the pixels come back");
+
+        DecodedImage missing;
+        check(!cache.load(std::string(64, 'b'), nullptr, missing), "round trip: an unknown key is a miss");
+        auto stats = cache.stats();
+        check(stats.hits == 1 && stats.misses == 1, "round trip: hits and misses are counted");
+        check(stats.bytesRead == sizeof(TextureFileHeader) + image.pixels.size(), "round trip: bytes read include the header");
+    }
+
+    void checkValidation(const fs::path& directory) {
+        TextureCache cache(directory, 1 << 20);
+        DecodedImage out;
+
+        std::string badMagic(64, 'c'), badVersion(64, 'd'), badSize(64, 'e');
+        for (const auto& key : {badMagic, badVersion, badSize}) cache.store(key, makeImage(8, 8, 2));
+        patchHeader(directory, badMagic, offsetof(TextureFileHeader, magic), 0x12345678);
+        patchHeader(directory, badVersion, offsetof(TextureFileHeader, version), TextureFileHeader::kVersion + 1);
+        // Twice as wide, so the pixels no longer add up to the header's size
+        patchHeader(directory, badSize, offsetof(TextureFileHeader, width), 16);
+
+        check(!cache.load(badMagic, nullptr, out), "validation: a wrong magic is a miss");
+        check(!cache.load(badVersion, nullptr, out), "validation: another version is a miss");
+        check(!cache.load(badSize, nullptr, out), "validation: a header that does not match the pixel bytes is a miss");
+
+        // A chain that was planned but not built leaves fewer pixels than its levels need
+        DecodedImage partial = makeImage(8, 8, 3);
+        partial.levels = texgan::loading::mipLevelCount(8, 8) + 1;
+        std::string undersized(64, 'f');
+        std::size_t entries = cache.stats().entries;
+        cache.store(undersized, partial);
+        check(cache.stats().entries == entries && !cache.load(undersized, nullptr, out),
+              "validation: store() skips an image with fewer pixels than its header needs");
+    }
+}
+
+int main() {
+    fs::path directory = fs::temp_directory_path() / "texgan_texture_cache_test";
+    fs::remove_all(directory);
+
+    checkKeys();
+    checkRoundTrip(directory / "round_trip");
+    checkValidation(directory / "validation");
+
+    fs::remove_all(directory);
+    if (failures) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "all texture cache checks passed\n";
+    return 0;
+}
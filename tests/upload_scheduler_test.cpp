@@ -0,0 +1,125 @@
+// Checks texgan::loading::UploadScheduler, run by ctest.
+//
+// Within a frame the scheduler admits uploads while the time it predicts for them, and the bytes, stay
+// within the budget, but always admits the first one. The cost per byte is an exponential moving average
+// of the measured uploads. framesToDrain estimates the frames a backlog needs under the tighter of the
+// two limits, at least one and at most one per texture, and lastDrainFrames counts those it took.
+// Exits non-zero when any check fails.
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cmath>
+
+#include "texgan/loading/UploadScheduler.h"
+
+namespace {
+    using texgan::loading::UploadBudget;
+    using texgan::loading::UploadScheduler;
+    using namespace std::chrono_literals;
+
+    constexpr std::size_t kMegabyte = 1 << 20;
+
+    int failures = 0;
+
+    void check(bool ok, const std::string& what) {
+        if (!ok) {
+            std::cerr << "FAIL: " << what << "\n";
+            ++failures;
+        }
+    }
+
+    bool near(double value, double expected) {
+        return std::abs(value - expected) < 1e-6;
+    }
+
+    void checkAdmit() {
+        UploadScheduler scheduler(UploadBudget{4.0, 0});
+        scheduler.beginFrame();
+        check(scheduler.admit(100 * kMegabyte), "admit: the first upload of a frame always fits");
+
+        // 2 ms per megabyte from now on
+        scheduler.uploaded(kMegabyte, 2ms);
+        check(scheduler.admit(kMegabyte / 2), "admit: an upload predicted to fit the rest of the budget");
+        check(!scheduler.admit(2 * kMegabyte), "admit: an upload predicted to overrun the budget waits");
+        scheduler.endFrame(1, 2 * kMegabyte);
+
+        scheduler.beginFrame();
+        check(scheduler.admit(2 * kMegabyte), "admit: the next frame starts with a fresh budget");
+
+        scheduler.setBudget(UploadBudget{0.0, 1000});
+        scheduler.beginFrame();
+        scheduler.uploaded(600, 1ms);
+        check(scheduler.admit(400), "admit: bytes up to the byte budget fit");
+        check(!scheduler.admit(401), "admit: one byte more does not");
+
+        scheduler.setBudget(UploadBudget{0.0, 0});
+        check(scheduler.admit(100 * kMegabyte), "admit: no limits admit everything");
+    }
+
+    void checkCost() {
+        UploadScheduler scheduler;
+        check(scheduler.stats().millisPerMegabyte == 0.0, "cost: unknown before the first upload");
+
+        scheduler.beginFrame();
+        scheduler.uploaded(kMegabyte, 2ms);
+        check(near(scheduler.stats().millisPerMegabyte, 2.0), "cost: the first sample is taken as is");
+        scheduler.uploaded(kMegabyte, 4ms);
+        check(near(scheduler.stats().millisPerMegabyte, 2.4), "cost: later samples move it by a fifth of the difference");
+        scheduler.uploaded(0, 10ms);
+        check(near(scheduler.stats().millisPerMegabyte, 2.4), "cost: an empty upload says nothing about the cost");
+        scheduler.endFrame(0, 0);
+
+        auto stats = scheduler.stats();
+        check(near(stats.lastFrameMillis, 16.0) && stats.uploadedLastFrame == 3, "cost: the frame's time and uploads are reported");
+        check(near(stats.worstFrameMillis, 16.0), "cost: the worst frame is tracked");
+        scheduler.beginFrame();
+        scheduler.uploaded(kMegabyte, 1ms);
+        scheduler.endFrame(0, 0);
+        check(near(scheduler.stats().worstFrameMillis, 16.0), "cost: a cheaper frame keeps the worst one");
+        scheduler.resetStats();
+        check(scheduler.stats().worstFrameMillis == 0.0, "cost: resetStats() clears it");
+    }
+
+    void checkDrain() {
+        UploadScheduler scheduler(UploadBudget{4.0, 0});
+        scheduler.beginFrame();
+        scheduler.uploaded(kMegabyte, 2ms); // 2 MB per frame at 4 ms
+        scheduler.endFrame(20, 10 * kMegabyte);
+        check(scheduler.stats().framesToDrain == 5, "drain: pending bytes over what a frame gets through");
+
+        scheduler.setBudget(UploadBudget{4.0, kMegabyte});
+        check(scheduler.stats().framesToDrain == 10, "drain: the tighter of the two limits decides");
+
+        scheduler.endFrame(3, 10 * kMegabyte);
+        check(scheduler.stats().framesToDrain == 3, "drain: at most one frame per texture");
+        scheduler.endFrame(4, 100);
+        check(scheduler.stats().framesToDrain == 1, "drain: at least one frame while anything is pending");
+        scheduler.endFrame(0, 0);
+        check(scheduler.stats().framesToDrain == 0, "drain: nothing pending, nothing to drain");
+
+        UploadScheduler counting;
+        for (std::size_t pending : {2, 1, 0}) {
+            counting.beginFrame();
+            counting.uploaded(1000, 1ms);
+            counting.endFrame(pending, pending * 1000);
+        }
+        check(counting.stats().lastDrainFrames == 3, "drain: counts the frames the backlog took, the emptying one included");
+        counting.beginFrame();
+        counting.endFrame(0, 0);
+        check(counting.stats().lastDrainFrames == 3, "drain: idle frames do not start a new count");
+    }
+}
+
+int main() {
+    checkAdmit();
+    checkCost();
+    checkDrain();
+
+    if (failures) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "all upload scheduler checks passed\n";
+    return 0;
+}